@@ -0,0 +1,226 @@
+#pragma once
+
+#include <benchmark/benchmark.h>
+#include <cstdint>
+#include <fstream>
+#include <sched.h>
+#include <string>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+
+#include "stats/LatencyHistogram.h"
+
+// Where the benchmark process and its peer run relative to each other
+enum class CorePlacement : int64_t
+{
+    SameCore,       // Both on one CPU, taking turns
+    SmtSibling,     // Two hardware threads of one core, sharing its L1 and L2
+    SameSocket,     // Two cores of one socket, sharing the L3
+    CrossSocket,    // Two sockets, talking over the interconnect
+};
+
+static const std::vector<int64_t> CORE_PLACEMENTS = {
+    static_cast<int64_t>(CorePlacement::SameCore),
+    static_cast<int64_t>(CorePlacement::SmtSibling),
+    static_cast<int64_t>(CorePlacement::SameSocket),
+    static_cast<int64_t>(CorePlacement::CrossSocket),
+};
+
+inline const char* CorePlacementToString(CorePlacement placement)
+{
+    switch (placement)
+    {
+    case CorePlacement::SameCore:
+        return "same core";
+    case CorePlacement::SmtSibling:
+        return "SMT sibling";
+    case CorePlacement::SameSocket:
+        return "same socket";
+    case CorePlacement::CrossSocket:
+        return "cross socket";
+    default:
+        return "unknown";
+    }
+}
+
+// Picks the first pair of CPUs the process may run on that have the given placement. Returns
+// false if the machine has none, e.g. no SMT or a single socket.
+inline bool FindCpuPair(CorePlacement placement, int& firstCpu, int& secondCpu)
+{
+    struct CpuTopology
+    {
+        int cpu;
+        int packageId;
+        int coreId;
+    };
+
+    auto readTopology = [](int cpu, const char* name)
+    {
+        std::ifstream file("/sys/devices/system/cpu/cpu" + std::to_string(cpu) + "/topology/" + name);
+        int value = -1;
+        file >> value;
+        return value;
+    };
+
+    cpu_set_t allowedCpus;
+    CPU_ZERO(&allowedCpus);
+    if (sched_getaffinity(0, sizeof(allowedCpus), &allowedCpus) != 0)
+    {
+        return false;
+    }
+
+    std::vector<CpuTopology> cpus;
+    for (int cpu = 0; cpu < CPU_SETSIZE; cpu++)
+    {
+        if (CPU_ISSET(cpu, &allowedCpus))
+        {
+            cpus.push_back({ cpu, readTopology(cpu, "physical_package_id"), readTopology(cpu, "core_id") });
+        }
+    }
+
+    if (placement == CorePlacement::SameCore && !cpus.empty())
+    {
+        firstCpu = secondCpu = cpus[0].cpu;
+        return true;
+    }
+
+    for (const CpuTopology& first : cpus)
+    {
+        for (const CpuTopology& second : cpus)
+        {
+            if (first.cpu >= second.cpu)
+            {
+                continue;
+            }
+
+            bool samePackage = first.packageId == second.packageId;
+            bool sameCore = samePackage && first.coreId == second.coreId;
+            bool matches = (placement == CorePlacement::SmtSibling && sameCore) ||
+                           (placement == CorePlacement::SameSocket && samePackage && !sameCore) ||
+                           (placement == CorePlacement::CrossSocket && !samePackage);
+            if (matches)
+            {
+                firstCpu = first.cpu;
+                secondCpu = second.cpu;
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+inline bool PinToCpu(int cpu)
+{
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    CPU_SET(cpu, &cpus);
+    return sched_setaffinity(0, sizeof(cpus), &cpus) == 0;
+}
+
+// Peer process of a cross-process benchmark. Start pins the benchmark thread to the first CPU of
+// the placement, forks, pins the peer to the second and runs peerMain in it. It returns once the
+// peer has called ReportReady. The destructor waits for the peer to exit and gives the benchmark
+// thread its CPUs back, so the peer must be told to stop before that.
+//
+// The peer inherits everything mapped before the fork and leaves with _exit, so that it does not
+// destroy shared objects the benchmark process owns.
+class PeerProcess
+{
+public:
+    PeerProcess()
+    {
+        CPU_ZERO(&m_SavedCpus);
+        m_HasSavedCpus = sched_getaffinity(0, sizeof(m_SavedCpus), &m_SavedCpus) == 0;
+    }
+
+    ~PeerProcess()
+    {
+        if (m_Pid > 0)
+        {
+            int status;
+            waitpid(m_Pid, &status, 0);
+        }
+        if (m_HasSavedCpus)
+        {
+            sched_setaffinity(0, sizeof(m_SavedCpus), &m_SavedCpus);
+        }
+    }
+
+    // Returns false, with the benchmark skipped, if the placement is not available here or the
+    // peer could not be started. The label names the placement and the CPUs, after labelPrefix.
+    template<typename PeerMain>
+    bool Start(benchmark::State& state, CorePlacement placement, PeerMain peerMain, const std::string& labelPrefix = "")
+    {
+        int firstCpu, secondCpu;
+        if (!FindCpuPair(placement, firstCpu, secondCpu))
+        {
+            state.SkipWithError((std::string("No CPU pair for ") + CorePlacementToString(placement)).c_str());
+            return false;
+        }
+        state.SetLabel(labelPrefix + CorePlacementToString(placement) + ", cpus " + std::to_string(firstCpu) + "/" + std::to_string(secondCpu));
+
+        int readyPipe[2];
+        if (!PinToCpu(firstCpu) || pipe(readyPipe) != 0)
+        {
+            state.SkipWithError("Failed to pin the benchmark process");
+            return false;
+        }
+
+        m_Pid = fork();
+        if (m_Pid == -1)
+        {
+            close(readyPipe[0]);
+            close(readyPipe[1]);
+            state.SkipWithError("Failed to fork the peer process");
+            return false;
+        }
+
+        if (m_Pid == 0)
+        {
+            close(readyPipe[0]);
+            m_ReadyFd = readyPipe[1];
+            if (PinToCpu(secondCpu))
+            {
+                peerMain(*this);
+            }
+            _exit(0);
+        }
+
+        close(readyPipe[1]);
+        char ready = 0;
+        bool isReady = read(readyPipe[0], &ready, 1) == 1;
+        close(readyPipe[0]);
+        if (!isReady)
+        {
+            state.SkipWithError("The peer process failed to start");
+            return false;
+        }
+        return true;
+    }
+
+    // Called in the peer once it can serve the benchmark
+    void ReportReady()
+    {
+        char ready = 1;
+        [[maybe_unused]] ssize_t written = write(m_ReadyFd, &ready, 1);
+        close(m_ReadyFd);
+    }
+
+private:
+    pid_t m_Pid { 0 };
+    int m_ReadyFd { -1 };
+    cpu_set_t m_SavedCpus;
+    bool m_HasSavedCpus;
+};
+
+// Round trip percentiles as user counters, in ns
+inline void ReportLatencyHistogram(benchmark::State& state, const LatencyHistogram& histogram)
+{
+    state.counters["minNs"] = histogram.GetMinNs();
+    state.counters["p50Ns"] = histogram.GetPercentileNs(50.0);
+    state.counters["p90Ns"] = histogram.GetPercentileNs(90.0);
+    state.counters["p99Ns"] = histogram.GetPercentileNs(99.0);
+    state.counters["p99.9Ns"] = histogram.GetPercentileNs(99.9);
+    state.counters["maxNs"] = histogram.GetMaxNs();
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <benchmark/benchmark.h>
+#include <cstdint>
+
+#include "perf-counters/PerfCounterGroup.h"
+
+// Hardware counters of a benchmark's timed loop as Google Benchmark user counters. Counters are
+// normalized per KB moved so that shapes and sizes compare directly. On a machine without perf
+// access the benchmark still runs and is labelled instead.
+class BenchmarkPerfCounters
+{
+public:
+    // Call right before the timed loop
+    void Start()
+    {
+        m_Counting = m_Group.Read(m_StartCounts);
+    }
+
+    // Call right after the timed loop with the bytes moved by all of its iterations
+    void Stop(benchmark::State& state, uint64_t bytes)
+    {
+        PerfCounterValues endCounts;
+        if (!m_Counting || !m_Group.Read(endCounts))
+        {
+            state.SetLabel("no hardware counters");
+            return;
+        }
+
+        PerfCounterValues counts = PerfCounterGroup::Difference(endCounts, m_StartCounts);
+        double kilobytes = bytes / 1024.0;
+        if (kilobytes == 0.0)
+        {
+            return;
+        }
+
+        if (counts.Has(PerfCounter::Cycles) && counts.Has(PerfCounter::Instructions) && counts.Get(PerfCounter::Cycles) != 0)
+        {
+            state.counters["IPC"] = static_cast<double>(counts.Get(PerfCounter::Instructions)) / counts.Get(PerfCounter::Cycles);
+        }
+        if (counts.Has(PerfCounter::Cycles))
+        {
+            state.counters["cycles/KB"] = counts.Get(PerfCounter::Cycles) / kilobytes;
+        }
+        if (counts.Has(PerfCounter::LlcMisses))
+        {
+            state.counters["llcMisses/KB"] = counts.Get(PerfCounter::LlcMisses) / kilobytes;
+        }
+        if (counts.Has(PerfCounter::DtlbMisses))
+        {
+            state.counters["dtlbMisses/KB"] = counts.Get(PerfCounter::DtlbMisses) / kilobytes;
+        }
+        if (counts.Has(PerfCounter::Cycles) && counts.Has(PerfCounter::BackendStallCycles) && counts.Get(PerfCounter::Cycles) != 0)
+        {
+            state.counters["backendStall%"] = 100.0 * counts.Get(PerfCounter::BackendStallCycles) / counts.Get(PerfCounter::Cycles);
+        }
+        if (!counts.Has(PerfCounter::Cycles))
+        {
+            state.SetLabel("no hardware counters");
+        }
+    }
+
+private:
+    PerfCounterGroup m_Group;
+    PerfCounterValues m_StartCounts;
+    bool m_Counting { false };
+};
@@ -0,0 +1,374 @@
+#include <atomic>
+#include <benchmark/benchmark.h>
+#include <cstdint>
+#include <string>
+#include <sys/mman.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include "BenchmarkPeerProcess.h"
+#include "futex/FutexSignaller.h"
+#include "spsc-queue/SpscQueueRingBuffer.h"
+#include "spsc-queue/SpscQueueSeqLock.h"
+#include "spsc-queue/SpscQueueSequenced.h"
+#include "stats/LatencyHistogram.h"
+#include "stats/TscClock.h"
+#include "unix-socks/UnixSockIpcClient.h"
+#include "unix-socks/UnixSockIpcServer.h"
+
+// The IPC primitives between the benchmark process and a forked peer, for each placement of the
+// two on the machine's CPUs. Round trip benchmarks echo one message at a time and report the
+// latency histogram of the round trips. Throughput benchmarks stream messages one way and have
+// the peer acknowledge every BATCH_SIZE of them, so that a batch is only counted once the peer
+// has it. Only the placements the machine has are registered.
+
+static constexpr size_t CAPACITY = 1024;
+static constexpr uint64_t BATCH_SIZE = 256;
+static constexpr uint64_t STOP_SEQUENCE = ~0ULL;
+
+struct alignas(64) IpcMessage
+{
+    uint64_t sequence;
+    uint8_t payload[56];
+};
+
+static void CalibrateOnce()
+{
+    static bool calibrated = TscClock::Calibrate();
+    (void)calibrated;
+}
+
+// Polls with a yield now and then, so that the peers also take turns on a single core
+template<typename Poll>
+static void SpinUntil(Poll poll)
+{
+    for (uint32_t attempts = 1; !poll(); attempts++)
+    {
+        if (attempts % 1024 == 0)
+        {
+            std::this_thread::yield();
+        }
+    }
+}
+
+template<typename Queue>
+static void Enqueue(Queue& queue, const IpcMessage& message)
+{
+    SpinUntil([&]() { return queue.Enqueue(message); });
+}
+
+template<typename Queue>
+static void Dequeue(Queue& queue, IpcMessage& message)
+{
+    SpinUntil([&]() { return queue.Dequeue(message); });
+}
+
+template<typename Queue>
+static void BM_QueueRoundTrip(benchmark::State& state)
+{
+    CalibrateOnce();
+    Queue requests(getpid(), Queue::Role::Producer, CAPACITY, "_ipc_req");
+    Queue responses(getpid(), Queue::Role::Producer, CAPACITY, "_ipc_rsp");
+
+    PeerProcess peer;
+    bool started = peer.Start(state, static_cast<CorePlacement>(state.range(0)), [&](PeerProcess& self)
+    {
+        self.ReportReady();
+        IpcMessage message;
+        do
+        {
+            Dequeue(requests, message);
+            Enqueue(responses, message);
+        } while (message.sequence != STOP_SEQUENCE);
+    });
+    if (!started)
+    {
+        return;
+    }
+
+    LatencyHistogram roundTrips;
+    IpcMessage message {};
+    IpcMessage reply;
+    for (auto _ : state)
+    {
+        uint64_t startTicks = TscClock::Now();
+        Enqueue(requests, message);
+        Dequeue(responses, reply);
+        roundTrips.Record(TscClock::TicksToNs(TscClock::Now() - startTicks));
+
+        if (reply.sequence != message.sequence)
+        {
+            state.SkipWithError("Reply out of order");
+            break;
+        }
+        message.sequence++;
+    }
+
+    message.sequence = STOP_SEQUENCE;
+    Enqueue(requests, message);
+    Dequeue(responses, reply);
+    ReportLatencyHistogram(state, roundTrips);
+}
+
+template<typename Queue>
+static void BM_QueueThroughput(benchmark::State& state)
+{
+    Queue messages(getpid(), Queue::Role::Producer, CAPACITY, "_ipc_msg");
+    Queue acks(getpid(), Queue::Role::Producer, CAPACITY, "_ipc_ack");
+
+    PeerProcess peer;
+    bool started = peer.Start(state, static_cast<CorePlacement>(state.range(0)), [&](PeerProcess& self)
+    {
+        self.ReportReady();
+        IpcMessage message;
+        do
+        {
+            Dequeue(messages, message);
+            if (message.sequence % BATCH_SIZE == BATCH_SIZE - 1 || message.sequence == STOP_SEQUENCE)
+            {
+                Enqueue(acks, message);
+            }
+        } while (message.sequence != STOP_SEQUENCE);
+    });
+    if (!started)
+    {
+        return;
+    }
+
+    IpcMessage message {};
+    IpcMessage ack;
+    for (auto _ : state)
+    {
+        for (uint64_t i = 0; i < BATCH_SIZE; i++)
+        {
+            Enqueue(messages, message);
+            message.sequence++;
+        }
+        Dequeue(acks, ack);
+    }
+
+    message.sequence = STOP_SEQUENCE;
+    Enqueue(messages, message);
+    Dequeue(acks, ack);
+    state.SetItemsProcessed(state.iterations() * BATCH_SIZE);
+    state.SetBytesProcessed(state.iterations() * BATCH_SIZE * sizeof(IpcMessage));
+}
+
+// Wake-up latency: the benchmark process wakes the peer through one signaller and waits to be
+// woken back through another, both waiting with the policy under test
+static void BM_FutexRoundTrip(benchmark::State& state)
+{
+    CalibrateOnce();
+    auto placement = static_cast<CorePlacement>(state.range(0));
+    auto waitPolicy = static_cast<FutexSignaller::WaitPolicy>(state.range(1));
+
+    FutexSignaller ping(getpid(), FutexSignaller::Role::Waiter, "_ipc_ping", waitPolicy);
+    FutexSignaller pong(getpid(), FutexSignaller::Role::Waiter, "_ipc_pong", waitPolicy);
+
+    // Tells the peer to stop, in memory both processes share
+    auto* pStop = static_cast<std::atomic<bool>*>(mmap(nullptr, sizeof(std::atomic<bool>), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0));
+    if (pStop == MAP_FAILED)
+    {
+        state.SkipWithError("Failed to map the stop flag");
+        return;
+    }
+    new (pStop) std::atomic<bool>(false);
+
+    {
+        PeerProcess peer;
+        bool started = peer.Start(state, placement, [&](PeerProcess& self)
+        {
+            self.ReportReady();
+            bool stop = false;
+            while (!stop)
+            {
+                ping.Wait();
+                stop = pStop->load(std::memory_order_acquire);
+                pong.Wake();
+            }
+        }, std::string(FutexSignaller::WaitPolicyToString(waitPolicy)) + ", ");
+
+        if (started)
+        {
+            LatencyHistogram roundTrips;
+            for (auto _ : state)
+            {
+                uint64_t startTicks = TscClock::Now();
+                ping.Wake();
+                pong.Wait();
+                roundTrips.Record(TscClock::TicksToNs(TscClock::Now() - startTicks));
+            }
+
+            pStop->store(true, std::memory_order_release);
+            ping.Wake();
+            pong.Wait();
+            ReportLatencyHistogram(state, roundTrips);
+        }
+    }
+
+    munmap(pStop, sizeof(std::atomic<bool>));
+}
+
+// The control path: a UnixSockIpcClient in the benchmark process and a UnixSockIpcServer in the
+// peer, each with its own communicator thread, as between transpose_client and transpose_server.
+// The peer echoes round trip messages and the last message of each batch.
+static std::string SocketAddress()
+{
+    return "/tmp/ipc_benchmark_" + std::to_string(getpid()) + ".sock";
+}
+
+static void RunSocketPeer(PeerProcess& self, const std::string& address, bool echoAll)
+{
+    std::atomic<bool> stop { false };
+    UnixSockIpcServer<IpcMessage>* pServer = nullptr;
+    UnixSockIpcServer<IpcMessage> server(address, [&](UnixSockIpcContext context, const IpcMessage& message)
+    {
+        if (echoAll || message.sequence % BATCH_SIZE == BATCH_SIZE - 1 || message.sequence == STOP_SEQUENCE)
+        {
+            pServer->Send(context, message);
+        }
+        if (message.sequence == STOP_SEQUENCE)
+        {
+            stop.store(true, std::memory_order_release);
+        }
+    });
+    pServer = &server;
+
+    self.ReportReady();
+    while (!stop.load(std::memory_order_acquire))
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
+static void BM_UnixSocketRoundTrip(benchmark::State& state)
+{
+    CalibrateOnce();
+    std::string address = SocketAddress();
+
+    PeerProcess peer;
+    bool started = peer.Start(state, static_cast<CorePlacement>(state.range(0)), [&](PeerProcess& self)
+    {
+        RunSocketPeer(self, address, true);
+    });
+    if (!started)
+    {
+        return;
+    }
+
+    std::atomic<uint64_t> lastReply { STOP_SEQUENCE - 1 };
+    {
+        UnixSockIpcClient<IpcMessage> client(address, [&lastReply](const IpcMessage& reply)
+        {
+            lastReply.store(reply.sequence, std::memory_order_release);
+        });
+
+        LatencyHistogram roundTrips;
+        IpcMessage message {};
+        for (auto _ : state)
+        {
+            uint64_t startTicks = TscClock::Now();
+            client.Send(message);
+            SpinUntil([&]() { return lastReply.load(std::memory_order_acquire) == message.sequence; });
+            roundTrips.Record(TscClock::TicksToNs(TscClock::Now() - startTicks));
+            message.sequence++;
+        }
+
+        message.sequence = STOP_SEQUENCE;
+        client.Send(message);
+        SpinUntil([&]() { return lastReply.load(std::memory_order_acquire) == STOP_SEQUENCE; });
+        ReportLatencyHistogram(state, roundTrips);
+    }
+    unlink(address.c_str());
+}
+
+static void BM_UnixSocketThroughput(benchmark::State& state)
+{
+    std::string address = SocketAddress();
+
+    PeerProcess peer;
+    bool started = peer.Start(state, static_cast<CorePlacement>(state.range(0)), [&](PeerProcess& self)
+    {
+        RunSocketPeer(self, address, false);
+    });
+    if (!started)
+    {
+        return;
+    }
+
+    std::atomic<uint64_t> lastAck { STOP_SEQUENCE - 1 };
+    {
+        UnixSockIpcClient<IpcMessage> client(address, [&lastAck](const IpcMessage& ack)
+        {
+            lastAck.store(ack.sequence, std::memory_order_release);
+        });
+
+        IpcMessage message {};
+        for (auto _ : state)
+        {
+            for (uint64_t i = 0; i < BATCH_SIZE; i++)
+            {
+                client.Send(message);
+                message.sequence++;
+            }
+            SpinUntil([&]() { return lastAck.load(std::memory_order_acquire) == message.sequence - 1; });
+        }
+
+        message.sequence = STOP_SEQUENCE;
+        client.Send(message);
+        SpinUntil([&]() { return lastAck.load(std::memory_order_acquire) == STOP_SEQUENCE; });
+    }
+    unlink(address.c_str());
+    state.SetItemsProcessed(state.iterations() * BATCH_SIZE);
+    state.SetBytesProcessed(state.iterations() * BATCH_SIZE * sizeof(IpcMessage));
+}
+
+// Only the placements this machine has
+static std::vector<int64_t> AvailablePlacements()
+{
+    std::vector<int64_t> placements;
+    for (int64_t placement : CORE_PLACEMENTS)
+    {
+        int firstCpu, secondCpu;
+        if (FindCpuPair(static_cast<CorePlacement>(placement), firstCpu, secondCpu))
+        {
+            placements.push_back(placement);
+        }
+    }
+    return placements;
+}
+
+static void Placements(benchmark::internal::Benchmark* pBenchmark)
+{
+    for (int64_t placement : AvailablePlacements())
+    {
+        pBenchmark->Args({ placement });
+    }
+}
+
+// Spinning on the peer's own core only ends when the scheduler preempts the spinner, so Spin is
+// left out of the same core placement
+static void PlacementsAndWaitPolicies(benchmark::internal::Benchmark* pBenchmark)
+{
+    for (int64_t placement : AvailablePlacements())
+    {
+        for (FutexSignaller::WaitPolicy waitPolicy : { FutexSignaller::WaitPolicy::Futex, FutexSignaller::WaitPolicy::Spin, FutexSignaller::WaitPolicy::SpinThenYield, FutexSignaller::WaitPolicy::Hybrid })
+        {
+            if (placement != static_cast<int64_t>(CorePlacement::SameCore) || waitPolicy != FutexSignaller::WaitPolicy::Spin)
+            {
+                pBenchmark->Args({ placement, static_cast<int64_t>(waitPolicy) });
+            }
+        }
+    }
+}
+
+BENCHMARK_TEMPLATE(BM_QueueRoundTrip, SpscQueueRingBuffer<IpcMessage>)->Apply(Placements)->ArgNames({ "placement" })->UseRealTime();
+BENCHMARK_TEMPLATE(BM_QueueRoundTrip, SpscQueueSeqLock<IpcMessage>)->Apply(Placements)->ArgNames({ "placement" })->UseRealTime();
+BENCHMARK_TEMPLATE(BM_QueueRoundTrip, SpscQueueSequenced<IpcMessage>)->Apply(Placements)->ArgNames({ "placement" })->UseRealTime();
+BENCHMARK_TEMPLATE(BM_QueueThroughput, SpscQueueRingBuffer<IpcMessage>)->Apply(Placements)->ArgNames({ "placement" })->UseRealTime();
+BENCHMARK_TEMPLATE(BM_QueueThroughput, SpscQueueSeqLock<IpcMessage>)->Apply(Placements)->ArgNames({ "placement" })->UseRealTime();
+BENCHMARK_TEMPLATE(BM_QueueThroughput, SpscQueueSequenced<IpcMessage>)->Apply(Placements)->ArgNames({ "placement" })->UseRealTime();
+BENCHMARK(BM_FutexRoundTrip)->Apply(PlacementsAndWaitPolicies)->ArgNames({ "placement", "waitPolicy" })->UseRealTime();
+BENCHMARK(BM_UnixSocketRoundTrip)->Apply(Placements)->ArgNames({ "placement" })->UseRealTime();
+BENCHMARK(BM_UnixSocketThroughput)->Apply(Placements)->ArgNames({ "placement" })->UseRealTime();
@@ -0,0 +1,87 @@
+#include <benchmark/benchmark.h>
+#include <cstdint>
+#include <fcntl.h>
+#include <fstream>
+#include <string>
+#include <unistd.h>
+
+#include "log/Logger.h"
+#include "stats/TscClock.h"
+
+// Cost of a log line on the logging thread, with the background thread writing to /dev/null.
+// The ostream case is what the server paid before, with the same /dev/null behind it.
+static void BM_LoggerDisabled(benchmark::State& state)
+{
+    Logger::SetLevel(LogLevel::Warning);
+    uint64_t value = 0;
+    for (auto _ : state)
+    {
+        LOG_INFO("Client {} asked for {} lanes", value++, 4);
+    }
+    Logger::SetLevel(LogLevel::Info);
+}
+
+// Waits for the background thread after each ring's worth, outside the timing, so that every
+// record is written
+static void BM_LoggerEnabled(benchmark::State& state)
+{
+    TscClock::Calibrate();
+    int fd = open("/dev/null", O_WRONLY);
+    Logger::SetOutput(fd);
+    Logger::PrepareThread();
+    uint64_t droppedBefore = Logger::GetDroppedCount();
+
+    uint64_t value = 0;
+    std::string text = "transpose_client";
+    for (auto _ : state)
+    {
+        LOG_INFO("Client {} ({}) asked for {} lanes", value++, text, 4);
+        if (value % Logger::RING_CAPACITY == 0)
+        {
+            state.PauseTiming();
+            Logger::Flush();
+            state.ResumeTiming();
+        }
+    }
+
+    Logger::Flush();
+    state.SetLabel("dropped " + std::to_string(Logger::GetDroppedCount() - droppedBefore));
+    Logger::SetOutput(STDERR_FILENO);
+    close(fd);
+}
+
+// A thread logging in a loop, which mostly finds its ring full
+static void BM_LoggerFlood(benchmark::State& state)
+{
+    int fd = open("/dev/null", O_WRONLY);
+    Logger::SetOutput(fd);
+    uint64_t droppedBefore = Logger::GetDroppedCount();
+
+    uint64_t value = 0;
+    std::string text = "transpose_client";
+    for (auto _ : state)
+    {
+        LOG_INFO("Client {} ({}) asked for {} lanes", value++, text, 4);
+    }
+
+    Logger::Flush();
+    state.SetLabel("dropped " + std::to_string(Logger::GetDroppedCount() - droppedBefore) + " of " + std::to_string(value));
+    Logger::SetOutput(STDERR_FILENO);
+    close(fd);
+}
+
+static void BM_OstreamEnabled(benchmark::State& state)
+{
+    std::ofstream out("/dev/null");
+    uint64_t value = 0;
+    std::string text = "transpose_client";
+    for (auto _ : state)
+    {
+        out << "Client " << value++ << " (" << text << ") asked for " << 4 << " lanes" << std::endl;
+    }
+}
+
+BENCHMARK(BM_LoggerDisabled);
+BENCHMARK(BM_LoggerEnabled);
+BENCHMARK(BM_LoggerFlood);
+BENCHMARK(BM_OstreamEnabled);
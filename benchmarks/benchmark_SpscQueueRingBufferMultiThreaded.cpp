@@ -1,36 +1,103 @@
 #include <benchmark/benchmark.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <cstdint>
 #include <memory>
 #include <thread>
 
+#include "futex/EventCount.h"
 #include "spsc-queue/SpscQueueRingBuffer.h"
 
+// The producer runs on the benchmark thread and a consumer thread takes every item it hands over.
+// An iteration ends only once the consumer has taken all of its items, so each iteration times
+// the full handoff and never a full queue. Both sides use the blocking operations, so a side that
+// runs out of room or items sleeps in the queue's eventcount until the other wakes it.
+
 static constexpr size_t CAPACITY = 1024*1024;
-static std::unique_ptr<SpscQueueRingBuffer> pQueue;
+static constexpr size_t BULK_BATCH = 64;
+static constexpr std::chrono::milliseconds WAIT_TIMEOUT(10);
+static std::unique_ptr<SpscQueueRingBuffer<uint32_t>> pQueue;
 
 static std::thread gConsumerThread;
+static std::atomic<bool> gStopConsumer;
 
-static void DoSetup(const benchmark::State& state)
+// Iterations the consumer has fully drained, and what the producer sleeps on until it catches up
+static std::atomic<uint64_t> gRoundsDone;
+static EventCount gRoundDone;
+
+static void StartConsumer(const benchmark::State& state, void (*consumeRound)(uint32_t))
 {
-    pQueue = std::make_unique<SpscQueueRingBuffer>(getpid(), SpscQueueRingBuffer::Role::Producer, CAPACITY, "");
+    pQueue = std::make_unique<SpscQueueRingBuffer<uint32_t>>(getpid(), SpscQueueRingBuffer<uint32_t>::Role::Producer, CAPACITY, "");
+    gStopConsumer.store(false, std::memory_order_relaxed);
+    gRoundsDone.store(0, std::memory_order_relaxed);
     uint32_t numItems = state.range(0);
-    
-    gConsumerThread = std::thread([&]()
+
+    gConsumerThread = std::thread([numItems, consumeRound]()
     {
-        uint32_t item;
-        for (int i = 0; i < numItems; i++)
+        while (!gStopConsumer.load(std::memory_order_relaxed))
         {
-            while(!pQueue->Dequeue(item))
+            consumeRound(numItems);
+            gRoundsDone.fetch_add(1, std::memory_order_release);
+            gRoundDone.Notify();
+        }
+    });
+}
+
+// Returns once the consumer has drained every iteration so far
+static void WaitForConsumer(uint64_t rounds)
+{
+    while (!gRoundDone.Await([rounds]() { return gRoundsDone.load(std::memory_order_acquire) >= rounds; }, WAIT_TIMEOUT, 1024))
+    {
+    }
+}
+
+static void ConsumeRound(uint32_t numItems)
+{
+    uint32_t item;
+    for (uint32_t i = 0; i < numItems; i++)
+    {
+        // Spins briefly, then sleeps in the queue's eventcount until the producer catches up
+        while (!pQueue->Dequeue(item, WAIT_TIMEOUT))
+        {
+            if (gStopConsumer.load(std::memory_order_relaxed))
             {
-                std::this_thread::sleep_for(std::chrono::nanoseconds(100));
+                return;
             }
-            benchmark::DoNotOptimize(item);
         }
-    });
+        benchmark::DoNotOptimize(item);
+    }
+}
+
+static void ConsumeRoundBulk(uint32_t numItems)
+{
+    uint32_t items[BULK_BATCH];
+    uint32_t received = 0;
+    while (received < numItems)
+    {
+        size_t count = pQueue->DequeueBulk(items, BULK_BATCH, WAIT_TIMEOUT);
+        if (count == 0 && gStopConsumer.load(std::memory_order_relaxed))
+        {
+            return;
+        }
+        received += count;
+        benchmark::DoNotOptimize(items);
+    }
+}
+
+static void DoSetup(const benchmark::State& state)
+{
+    StartConsumer(state, ConsumeRound);
+}
+
+static void DoSetupBulk(const benchmark::State& state)
+{
+    StartConsumer(state, ConsumeRoundBulk);
 }
 
 static void DoTeardown(const benchmark::State& state)
 {
+    gStopConsumer.store(true, std::memory_order_relaxed);
     gConsumerThread.join();
     pQueue.reset();
 }
@@ -38,15 +105,50 @@ static void DoTeardown(const benchmark::State& state)
 static void BM_SpscQueueRingBuffer_MultiThreaded_EnqueueDeque(benchmark::State& state)
 {
     uint32_t numItems = state.range(0);
+    uint64_t rounds = 0;
 
     for (auto _ : state)
     {
-        for (int i = 0; i < numItems; i++)
+        for (uint32_t i = 0; i < numItems; i++)
         {
-            pQueue->Enqueue(i);
+            while (!pQueue->Enqueue(i, WAIT_TIMEOUT))
+            {
+            }
         }
+        WaitForConsumer(++rounds);
     }
+    state.SetItemsProcessed(state.iterations() * numItems);
 }
 BENCHMARK(BM_SpscQueueRingBuffer_MultiThreaded_EnqueueDeque)
     ->Setup(DoSetup)->Teardown(DoTeardown)
-    ->ArgName("Item Count")->Arg(1)->Arg(1000)->Arg(1000'000);
+    ->ArgName("Item Count")->Arg(1)->Arg(1000)->Arg(1000'000)->UseRealTime();
+
+static void BM_SpscQueueRingBuffer_MultiThreaded_EnqueueDequeBulk(benchmark::State& state)
+{
+    uint32_t numItems = state.range(0);
+    uint32_t items[BULK_BATCH];
+    uint64_t rounds = 0;
+
+    for (auto _ : state)
+    {
+        for (uint32_t i = 0; i < numItems; i += BULK_BATCH)
+        {
+            size_t batch = std::min<size_t>(BULK_BATCH, numItems - i);
+            for (size_t j = 0; j < batch; j++)
+            {
+                items[j] = i + j;
+            }
+
+            size_t sent = 0;
+            while (sent < batch)
+            {
+                sent += pQueue->EnqueueBulk(items + sent, batch - sent, WAIT_TIMEOUT);
+            }
+        }
+        WaitForConsumer(++rounds);
+    }
+    state.SetItemsProcessed(state.iterations() * numItems);
+}
+BENCHMARK(BM_SpscQueueRingBuffer_MultiThreaded_EnqueueDequeBulk)
+    ->Setup(DoSetupBulk)->Teardown(DoTeardown)
+    ->ArgName("Item Count")->Arg(1)->Arg(1000)->Arg(1000'000)->UseRealTime();
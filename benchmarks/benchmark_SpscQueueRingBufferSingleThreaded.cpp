@@ -1,20 +1,21 @@
 #include <benchmark/benchmark.h>
+#include <algorithm>
 #include <cstdint>
 #include <memory>
 
 #include "spsc-queue/SpscQueueRingBuffer.h"
 
 static constexpr size_t CAPACITY = 1024*1024;
-static std::unique_ptr<SpscQueueRingBuffer> pQueue;
+static std::unique_ptr<SpscQueueRingBuffer<uint32_t>> pQueue;
 
 static void DoSetup(const benchmark::State& state)
 {
-    pQueue = std::make_unique<SpscQueueRingBuffer>(getpid(), SpscQueueRingBuffer::Role::Producer, CAPACITY, "");
+    pQueue = std::make_unique<SpscQueueRingBuffer<uint32_t>>(getpid(), SpscQueueRingBuffer<uint32_t>::Role::Producer, CAPACITY, "");
 }
 
 static void DoSetupDeque(const benchmark::State& state)
 {
-    pQueue = std::make_unique<SpscQueueRingBuffer>(getpid(), SpscQueueRingBuffer::Role::Producer, CAPACITY, "");
+    pQueue = std::make_unique<SpscQueueRingBuffer<uint32_t>>(getpid(), SpscQueueRingBuffer<uint32_t>::Role::Producer, CAPACITY, "");
 
     uint32_t numItems = state.range(0);
 
@@ -82,3 +83,30 @@ static void BM_SpscQueueRingBuffer_EnqueueDeque(benchmark::State& state)
 BENCHMARK(BM_SpscQueueRingBuffer_EnqueueDeque)
     ->Setup(DoSetup)->Teardown(DoTeardown)
     ->ArgName("Item Count")->Arg(1)->Arg(1000)->Arg(10000);
+
+// Same item counts as above, moved in batches of BULK_BATCH items with one index update each
+static constexpr size_t BULK_BATCH = 64;
+
+static void BM_SpscQueueRingBuffer_EnqueueDequeBulk(benchmark::State& state)
+{
+    uint32_t numItems = state.range(0);
+    uint32_t items[BULK_BATCH];
+
+    for (auto _ : state)
+    {
+        for (uint32_t i = 0; i < numItems; i += BULK_BATCH)
+        {
+            size_t batch = std::min<size_t>(BULK_BATCH, numItems - i);
+            for (size_t j = 0; j < batch; j++)
+            {
+                items[j] = i + j;
+            }
+            pQueue->EnqueueBulk(items, batch);
+            pQueue->DequeueBulk(items, batch);
+            benchmark::DoNotOptimize(items);
+        }
+    }
+}
+BENCHMARK(BM_SpscQueueRingBuffer_EnqueueDequeBulk)
+    ->Setup(DoSetup)->Teardown(DoTeardown)
+    ->ArgName("Item Count")->Arg(1)->Arg(1000)->Arg(10000);
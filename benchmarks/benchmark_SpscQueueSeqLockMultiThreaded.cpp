@@ -1,36 +1,66 @@
 #include <benchmark/benchmark.h>
+#include <atomic>
+#include <chrono>
 #include <cstdint>
 #include <memory>
 #include <thread>
 
+#include "futex/EventCount.h"
 #include "spsc-queue/SpscQueueSeqLock.h"
 
+// The producer runs on the benchmark thread and a consumer thread takes every item it hands over.
+// An iteration ends only once the consumer has taken all of its items, so each iteration times
+// the full handoff and never a full queue. Both sides use the blocking operations, so a side that
+// runs out of room or items sleeps in the queue's eventcount until the other wakes it.
+
 static constexpr size_t CAPACITY = 1024*1024;
-static std::unique_ptr<SpscQueueSeqLock> pQueue;
+static constexpr std::chrono::milliseconds WAIT_TIMEOUT(10);
+static std::unique_ptr<SpscQueueSeqLock<uint32_t>> pQueue;
 
 static std::thread gConsumerThread;
+static std::atomic<bool> gStopConsumer;
 
-static void DoSetup(const benchmark::State& state)
+// Iterations the consumer has fully drained, and what the producer sleeps on until it catches up
+static std::atomic<uint64_t> gRoundsDone;
+static EventCount gRoundDone;
+
+static void ConsumeRound(uint32_t numItems)
 {
-    pQueue = std::make_unique<SpscQueueSeqLock>(getpid(), SpscQueueSeqLock::Role::Producer, CAPACITY, "");
-    uint32_t numItems = state.range(0);
-    
-    gConsumerThread = std::thread([&]()
+    uint32_t item;
+    for (uint32_t i = 0; i < numItems; i++)
     {
-        uint32_t item;
-        for (int i = 0; i < numItems; i++)
+        while (!pQueue->Dequeue(item, WAIT_TIMEOUT))
         {
-            while(!pQueue->Dequeue(item))
+            if (gStopConsumer.load(std::memory_order_relaxed))
             {
-                std::this_thread::sleep_for(std::chrono::nanoseconds(100));
+                return;
             }
-            benchmark::DoNotOptimize(item);
+        }
+        benchmark::DoNotOptimize(item);
+    }
+}
+
+static void DoSetup(const benchmark::State& state)
+{
+    pQueue = std::make_unique<SpscQueueSeqLock<uint32_t>>(getpid(), SpscQueueSeqLock<uint32_t>::Role::Producer, CAPACITY, "");
+    gStopConsumer.store(false, std::memory_order_relaxed);
+    gRoundsDone.store(0, std::memory_order_relaxed);
+    uint32_t numItems = state.range(0);
+
+    gConsumerThread = std::thread([numItems]()
+    {
+        while (!gStopConsumer.load(std::memory_order_relaxed))
+        {
+            ConsumeRound(numItems);
+            gRoundsDone.fetch_add(1, std::memory_order_release);
+            gRoundDone.Notify();
         }
     });
 }
 
 static void DoTeardown(const benchmark::State& state)
 {
+    gStopConsumer.store(true, std::memory_order_relaxed);
     gConsumerThread.join();
     pQueue.reset();
 }
@@ -38,15 +68,24 @@ static void DoTeardown(const benchmark::State& state)
 static void BM_SpscQueueSeqLock_MultiThreaded_EnqueueDeque(benchmark::State& state)
 {
     uint32_t numItems = state.range(0);
+    uint64_t rounds = 0;
 
     for (auto _ : state)
     {
-        for (int i = 0; i < numItems; i++)
+        for (uint32_t i = 0; i < numItems; i++)
+        {
+            while (!pQueue->Enqueue(i, WAIT_TIMEOUT))
+            {
+            }
+        }
+
+        rounds++;
+        while (!gRoundDone.Await([rounds]() { return gRoundsDone.load(std::memory_order_acquire) >= rounds; }, WAIT_TIMEOUT, 1024))
         {
-            pQueue->Enqueue(i);
         }
     }
+    state.SetItemsProcessed(state.iterations() * numItems);
 }
 BENCHMARK(BM_SpscQueueSeqLock_MultiThreaded_EnqueueDeque)
     ->Setup(DoSetup)->Teardown(DoTeardown)
-    ->ArgName("Item Count")->Arg(1)->Arg(1000)->Arg(1000'000);
+    ->ArgName("Item Count")->Arg(1)->Arg(1000)->Arg(1000'000)->UseRealTime();
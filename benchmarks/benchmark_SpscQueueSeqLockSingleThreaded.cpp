@@ -5,16 +5,16 @@
 #include "spsc-queue/SpscQueueSeqLock.h"
 
 static constexpr size_t CAPACITY = 1024*1024;
-static std::unique_ptr<SpscQueueSeqLock> pQueue;
+static std::unique_ptr<SpscQueueSeqLock<uint32_t>> pQueue;
 
 static void DoSetup(const benchmark::State& state)
 {
-    pQueue = std::make_unique<SpscQueueSeqLock>(getpid(), SpscQueueSeqLock::Role::Producer, CAPACITY, "");
+    pQueue = std::make_unique<SpscQueueSeqLock<uint32_t>>(getpid(), SpscQueueSeqLock<uint32_t>::Role::Producer, CAPACITY, "");
 }
 
 static void DoSetupDeque(const benchmark::State& state)
 {
-    pQueue = std::make_unique<SpscQueueSeqLock>(getpid(), SpscQueueSeqLock::Role::Producer, CAPACITY, "");
+    pQueue = std::make_unique<SpscQueueSeqLock<uint32_t>>(getpid(), SpscQueueSeqLock<uint32_t>::Role::Producer, CAPACITY, "");
 
     uint32_t numItems = state.range(0);
 
@@ -0,0 +1,34 @@
+#include <benchmark/benchmark.h>
+#include <cstdint>
+
+#include "stats/TscClock.h"
+#include "trace/Tracer.h"
+
+// Cost of a trace event on the recording thread, with tracing off and on. With tracing on the
+// ring wraps many times over, which is the steady state of a long running server.
+static void BM_TracerRecordDisabled(benchmark::State& state)
+{
+    Tracer::SetEnabled(false);
+    uint64_t arg = 0;
+    for (auto _ : state)
+    {
+        Tracer::Instant(0, arg++, 0);
+    }
+}
+
+static void BM_TracerRecordEnabled(benchmark::State& state)
+{
+    TscClock::Calibrate();
+    Tracer::SetEnabled(true);
+    uint64_t arg = 0;
+    for (auto _ : state)
+    {
+        Tracer::Instant(0, arg++, 0);
+    }
+    Tracer::SetEnabled(false);
+    Tracer::Clear();
+    state.SetLabel(TscClock::UsesTsc() ? "tsc" : "steady_clock");
+}
+
+BENCHMARK(BM_TracerRecordDisabled);
+BENCHMARK(BM_TracerRecordEnabled);
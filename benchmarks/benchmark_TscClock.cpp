@@ -0,0 +1,35 @@
+#include <benchmark/benchmark.h>
+#include <chrono>
+
+#include "stats/TscClock.h"
+
+// Cost of one timestamp with each clock, i.e. what a timed stage adds to the hot path
+static void BM_TscClockNow(benchmark::State& state)
+{
+    TscClock::Calibrate();
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(TscClock::Now());
+    }
+    state.SetLabel(TscClock::UsesTsc() ? "tsc" : "steady_clock");
+}
+
+static void BM_SteadyClockNow(benchmark::State& state)
+{
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(std::chrono::steady_clock::now());
+    }
+}
+
+static void BM_HighResolutionClockNow(benchmark::State& state)
+{
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(std::chrono::high_resolution_clock::now());
+    }
+}
+
+BENCHMARK(BM_TscClockNow);
+BENCHMARK(BM_SteadyClockNow);
+BENCHMARK(BM_HighResolutionClockNow);
@@ -0,0 +1,47 @@
+#include <benchmark/benchmark.h>
+#include <cstdint>
+#include <vector>
+
+#include "BenchmarkPerfCounters.h"
+#include "mat-transpose/mat-transpose.h"
+
+// The server's tile kernel on one thread, with hardware counters per KB moved. Square, tall and
+// wide shapes of the same size show whether a shape is limited by bandwidth, the TLB or cache
+// set conflicts between the rows of a tile.
+static void BM_TransposeTiledTileRangeCounters(benchmark::State& state)
+{
+    uint32_t rowCount = 1u << state.range(0);
+    uint32_t columnCount = 1u << state.range(1);
+    uint32_t tileSize = state.range(2);
+
+    std::vector<uint64_t> source(static_cast<size_t>(rowCount) * columnCount);
+    std::vector<uint64_t> destination(source.size());
+    for (size_t i = 0; i < source.size(); i++)
+    {
+        source[i] = i;
+    }
+
+    uint32_t tileCount = TiledTileCount(rowCount, columnCount, tileSize);
+    uint64_t bytesPerIteration = 2 * source.size() * sizeof(uint64_t);
+
+    BenchmarkPerfCounters perfCounters;
+    perfCounters.Start();
+    for (auto _ : state)
+    {
+        TransposeTiledTileRange(source.data(), destination.data(), rowCount, columnCount, tileSize, 0, tileCount);
+        benchmark::ClobberMemory();
+    }
+    perfCounters.Stop(state, bytesPerIteration * state.iterations());
+
+    state.SetBytesProcessed(bytesPerIteration * state.iterations());
+}
+
+BENCHMARK(BM_TransposeTiledTileRangeCounters)
+    ->Args({10, 10, 64})
+    ->Args({12, 8, 64})
+    ->Args({8, 12, 64})
+    ->Args({11, 11, 64})
+    ->Args({13, 9, 64})
+    ->Args({9, 13, 64})
+    ->ArgNames({"m", "n", "tileSize"})
+    ->Unit(benchmark::kMicrosecond);
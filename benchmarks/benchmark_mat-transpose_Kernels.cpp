@@ -0,0 +1,345 @@
+#include <algorithm>
+#include <benchmark/benchmark.h>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <thread>
+#include <vector>
+
+#include "mat-transpose/mat-transpose.h"
+
+// Every transpose kernel over square, tall and wide shapes, with the memory bandwidth it reaches.
+// A transpose does no arithmetic, so the roofline it can hit is the copy bandwidth of the
+// machine. The memcpy and STREAM copy baselines move the same bytes between buffers of the same
+// size, and each kernel reports its bandwidth as a share of the best baseline for its size. The
+// baselines have to run first for that, so filters that leave them out drop the share.
+//
+// Shapes are log2 of the row and column counts. 2^8 x 2^8 fits in L2; the others do not fit in
+// the caches.
+
+using Clock = std::chrono::steady_clock;
+
+static const std::vector<std::pair<int64_t, int64_t>> SHAPES = {
+    { 8, 8 }, { 10, 10 }, { 12, 8 }, { 8, 12 }, { 11, 11 }, { 13, 9 }, { 9, 13 },
+};
+static const std::vector<int64_t> SQUARE_SHAPES = { 8, 10, 11 };
+static const std::vector<int64_t> THREAD_COUNTS = { 1, 2, 4, 8 };
+static const std::vector<int64_t> TILE_SIZES = { 16, 32, 64, 128 };
+
+// Best bandwidth of the baselines by bytes moved per iteration
+static std::map<uint64_t, double> s_CopyBytesPerSecond;
+
+static std::vector<uint64_t> MakeSource(uint64_t elementCount)
+{
+    std::vector<uint64_t> source(elementCount);
+    for (uint64_t i = 0; i < elementCount; i++)
+    {
+        source[i] = i;
+    }
+    return source;
+}
+
+// Every element is read once and written once
+static uint64_t BytesPerIteration(uint64_t elementCount)
+{
+    return 2 * elementCount * sizeof(uint64_t);
+}
+
+// Measures the timed loop on the wall clock, which is what the multithreaded kernels take
+class BandwidthReport
+{
+public:
+    explicit BandwidthReport(uint64_t bytesPerIteration) :
+        m_BytesPerIteration(bytesPerIteration),
+        m_Start(Clock::now())
+    {
+    }
+
+    void Stop(benchmark::State& state, bool isBaseline)
+    {
+        double seconds = std::chrono::duration<double>(Clock::now() - m_Start).count();
+        double bytesPerSecond = m_BytesPerIteration * state.iterations() / seconds;
+        state.counters["GB/s"] = bytesPerSecond / 1e9;
+
+        double& copyBytesPerSecond = s_CopyBytesPerSecond[m_BytesPerIteration];
+        if (isBaseline)
+        {
+            copyBytesPerSecond = std::max(copyBytesPerSecond, bytesPerSecond);
+        }
+        else if (copyBytesPerSecond > 0.0)
+        {
+            state.counters["%ofCopy"] = 100.0 * bytesPerSecond / copyBytesPerSecond;
+        }
+    }
+
+private:
+    uint64_t m_BytesPerIteration;
+    Clock::time_point m_Start;
+};
+
+static void BM_Memcpy(benchmark::State& state)
+{
+    uint64_t elementCount = 1ull << state.range(0);
+    std::vector<uint64_t> source = MakeSource(elementCount);
+    std::vector<uint64_t> destination(elementCount);
+
+    BandwidthReport report(BytesPerIteration(elementCount));
+    for (auto _ : state)
+    {
+        std::memcpy(destination.data(), source.data(), elementCount * sizeof(uint64_t));
+        benchmark::ClobberMemory();
+    }
+    report.Stop(state, true);
+}
+
+// STREAM copy, c[j] = a[j], split into contiguous chunks. Threads are started on every
+// iteration, as TransposeTiledMultiThreaded does, so that both pay the same overhead.
+static void BM_StreamCopy(benchmark::State& state)
+{
+    uint64_t elementCount = 1ull << state.range(0);
+    uint32_t numThreads = state.range(1);
+    std::vector<uint64_t> source = MakeSource(elementCount);
+    std::vector<uint64_t> destination(elementCount);
+    uint64_t* pSource = source.data();
+    uint64_t* pDestination = destination.data();
+
+    BandwidthReport report(BytesPerIteration(elementCount));
+    for (auto _ : state)
+    {
+        std::vector<std::thread> threads;
+        for (uint32_t t = 0; t < numThreads; t++)
+        {
+            threads.emplace_back([=]()
+            {
+                uint64_t first = elementCount * t / numThreads;
+                uint64_t end = elementCount * (t + 1) / numThreads;
+                for (uint64_t j = first; j < end; j++)
+                {
+                    pDestination[j] = pSource[j];
+                }
+            });
+        }
+        for (std::thread& thread : threads)
+        {
+            thread.join();
+        }
+        benchmark::ClobberMemory();
+    }
+    report.Stop(state, true);
+}
+
+static void BM_TransposeNaive(benchmark::State& state)
+{
+    uint32_t rowCount = 1u << state.range(0);
+    uint32_t columnCount = 1u << state.range(1);
+    std::vector<uint64_t> source = MakeSource(static_cast<uint64_t>(rowCount) * columnCount);
+    std::vector<uint64_t> destination(source.size());
+
+    BandwidthReport report(BytesPerIteration(source.size()));
+    for (auto _ : state)
+    {
+        TransposeNaive(source.data(), destination.data(), rowCount, columnCount);
+        benchmark::ClobberMemory();
+    }
+    report.Stop(state, false);
+}
+
+static void BM_TransposeRecursive(benchmark::State& state)
+{
+    uint32_t rowCount = 1u << state.range(0);
+    uint32_t columnCount = 1u << state.range(1);
+    std::vector<uint64_t> source = MakeSource(static_cast<uint64_t>(rowCount) * columnCount);
+    std::vector<uint64_t> destination(source.size());
+
+    BandwidthReport report(BytesPerIteration(source.size()));
+    for (auto _ : state)
+    {
+        TransposeRecursive(source.data(), destination.data(), rowCount, columnCount);
+        benchmark::ClobberMemory();
+    }
+    report.Stop(state, false);
+}
+
+// The server's kernel: all tiles on the calling thread
+static void BM_TransposeTiledTileRange(benchmark::State& state)
+{
+    uint32_t rowCount = 1u << state.range(0);
+    uint32_t columnCount = 1u << state.range(1);
+    uint32_t tileSize = state.range(2);
+    std::vector<uint64_t> source = MakeSource(static_cast<uint64_t>(rowCount) * columnCount);
+    std::vector<uint64_t> destination(source.size());
+    uint32_t tileCount = TiledTileCount(rowCount, columnCount, tileSize);
+
+    BandwidthReport report(BytesPerIteration(source.size()));
+    for (auto _ : state)
+    {
+        TransposeTiledTileRange(source.data(), destination.data(), rowCount, columnCount, tileSize, 0, tileCount);
+        benchmark::ClobberMemory();
+    }
+    report.Stop(state, false);
+}
+
+static void BM_TransposeTiledMultiThreaded(benchmark::State& state)
+{
+    uint32_t rowCount = 1u << state.range(0);
+    uint32_t columnCount = 1u << state.range(1);
+    uint32_t tileSize = state.range(2);
+    uint32_t numThreads = state.range(3);
+    std::vector<uint64_t> source = MakeSource(static_cast<uint64_t>(rowCount) * columnCount);
+    std::vector<uint64_t> destination(source.size());
+
+    BandwidthReport report(BytesPerIteration(source.size()));
+    for (auto _ : state)
+    {
+        TransposeTiledMultiThreaded(source.data(), destination.data(), rowCount, columnCount, tileSize, numThreads);
+        benchmark::ClobberMemory();
+    }
+    report.Stop(state, false);
+}
+
+// In-place kernels transpose the same matrix back and forth, which leaves it as it started on
+// every other iteration
+static void BM_TransposeNaiveInPlace(benchmark::State& state)
+{
+    uint32_t rowCount = 1u << state.range(0);
+    std::vector<uint64_t> matrix = MakeSource(static_cast<uint64_t>(rowCount) * rowCount);
+
+    BandwidthReport report(BytesPerIteration(matrix.size()));
+    for (auto _ : state)
+    {
+        TransposeNaiveInPlace(matrix.data(), rowCount);
+        benchmark::ClobberMemory();
+    }
+    report.Stop(state, false);
+}
+
+static void BM_TransposeRecursiveInPlace(benchmark::State& state)
+{
+    uint32_t rowCount = 1u << state.range(0);
+    std::vector<uint64_t> matrix = MakeSource(static_cast<uint64_t>(rowCount) * rowCount);
+
+    BandwidthReport report(BytesPerIteration(matrix.size()));
+    for (auto _ : state)
+    {
+        TransposeRecursiveInPlace(matrix.data(), rowCount);
+        benchmark::ClobberMemory();
+    }
+    report.Stop(state, false);
+}
+
+static void BM_TransposeTiledInPlaceMultiThreaded(benchmark::State& state)
+{
+    uint32_t rowCount = 1u << state.range(0);
+    uint32_t tileSize = state.range(1);
+    uint32_t numThreads = state.range(2);
+    std::vector<uint64_t> matrix = MakeSource(static_cast<uint64_t>(rowCount) * rowCount);
+
+    BandwidthReport report(BytesPerIteration(matrix.size()));
+    for (auto _ : state)
+    {
+        TransposeTiledInPlaceMultiThreaded(matrix.data(), rowCount, tileSize, numThreads);
+        benchmark::ClobberMemory();
+    }
+    report.Stop(state, false);
+}
+
+// Sizes of the shapes, as log2 of the element count
+static std::vector<int64_t> ElementCountLog2s()
+{
+    std::vector<int64_t> elementCountLog2s;
+    for (const auto& [m, n] : SHAPES)
+    {
+        if (std::find(elementCountLog2s.begin(), elementCountLog2s.end(), m + n) == elementCountLog2s.end())
+        {
+            elementCountLog2s.push_back(m + n);
+        }
+    }
+    return elementCountLog2s;
+}
+
+static void CopySizes(benchmark::internal::Benchmark* pBenchmark)
+{
+    for (int64_t elementCountLog2 : ElementCountLog2s())
+    {
+        pBenchmark->Args({ elementCountLog2 });
+    }
+}
+
+static void StreamCopySizes(benchmark::internal::Benchmark* pBenchmark)
+{
+    for (int64_t elementCountLog2 : ElementCountLog2s())
+    {
+        for (int64_t numThreads : THREAD_COUNTS)
+        {
+            pBenchmark->Args({ elementCountLog2, numThreads });
+        }
+    }
+}
+
+static void Shapes(benchmark::internal::Benchmark* pBenchmark)
+{
+    for (const auto& [m, n] : SHAPES)
+    {
+        pBenchmark->Args({ m, n });
+    }
+}
+
+static void ShapesAndTileSizes(benchmark::internal::Benchmark* pBenchmark)
+{
+    for (const auto& [m, n] : SHAPES)
+    {
+        for (int64_t tileSize : TILE_SIZES)
+        {
+            pBenchmark->Args({ m, n, tileSize });
+        }
+    }
+}
+
+static void ShapesTileSizesAndThreads(benchmark::internal::Benchmark* pBenchmark)
+{
+    for (const auto& [m, n] : SHAPES)
+    {
+        for (int64_t tileSize : TILE_SIZES)
+        {
+            for (int64_t numThreads : THREAD_COUNTS)
+            {
+                pBenchmark->Args({ m, n, tileSize, numThreads });
+            }
+        }
+    }
+}
+
+static void SquareShapes(benchmark::internal::Benchmark* pBenchmark)
+{
+    for (int64_t m : SQUARE_SHAPES)
+    {
+        pBenchmark->Args({ m });
+    }
+}
+
+static void SquareShapesTileSizesAndThreads(benchmark::internal::Benchmark* pBenchmark)
+{
+    for (int64_t m : SQUARE_SHAPES)
+    {
+        for (int64_t tileSize : TILE_SIZES)
+        {
+            for (int64_t numThreads : THREAD_COUNTS)
+            {
+                pBenchmark->Args({ m, tileSize, numThreads });
+            }
+        }
+    }
+}
+
+// Baselines first, so that the kernels find them in s_CopyBytesPerSecond
+BENCHMARK(BM_Memcpy)->Apply(CopySizes)->ArgNames({ "log2Elements" })->UseRealTime()->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_StreamCopy)->Apply(StreamCopySizes)->ArgNames({ "log2Elements", "numThreads" })->UseRealTime()->Unit(benchmark::kMicrosecond);
+
+BENCHMARK(BM_TransposeNaive)->Apply(Shapes)->ArgNames({ "m", "n" })->UseRealTime()->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_TransposeRecursive)->Apply(Shapes)->ArgNames({ "m", "n" })->UseRealTime()->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_TransposeTiledTileRange)->Apply(ShapesAndTileSizes)->ArgNames({ "m", "n", "tileSize" })->UseRealTime()->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_TransposeTiledMultiThreaded)->Apply(ShapesTileSizesAndThreads)->ArgNames({ "m", "n", "tileSize", "numThreads" })->UseRealTime()->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_TransposeNaiveInPlace)->Apply(SquareShapes)->ArgNames({ "m" })->UseRealTime()->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_TransposeRecursiveInPlace)->Apply(SquareShapes)->ArgNames({ "m" })->UseRealTime()->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_TransposeTiledInPlaceMultiThreaded)->Apply(SquareShapesTileSizesAndThreads)->ArgNames({ "m", "tileSize", "numThreads" })->UseRealTime()->Unit(benchmark::kMicrosecond);
@@ -0,0 +1,115 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+// Two-level bitmap of up to 64 * 64 bits. A summary word records which 64-bit words are non-empty,
+// so iterating over the set bits only touches words that actually have bits set.
+template <uint32_t Capacity>
+class HierarchicalBitmap
+{
+public:
+    static_assert(Capacity > 0 && Capacity % 64 == 0, "Capacity must be a multiple of 64");
+    static_assert(Capacity <= 64 * 64, "Capacity must fit in a single summary word");
+
+    static constexpr uint32_t WORD_COUNT = Capacity / 64;
+    static constexpr int32_t NOT_FOUND = -1;
+
+    void Set(uint32_t index)
+    {
+        uint32_t wordIndex = index / 64;
+        m_Words[wordIndex] |= (1ULL << (index % 64));
+        m_Summary |= (1ULL << wordIndex);
+    }
+
+    void Clear(uint32_t index)
+    {
+        uint32_t wordIndex = index / 64;
+        m_Words[wordIndex] &= ~(1ULL << (index % 64));
+        if (m_Words[wordIndex] == 0)
+        {
+            m_Summary &= ~(1ULL << wordIndex);
+        }
+    }
+
+    bool Test(uint32_t index) const
+    {
+        return (m_Words[index / 64] & (1ULL << (index % 64))) != 0;
+    }
+
+    bool Empty() const
+    {
+        return m_Summary == 0;
+    }
+
+    uint32_t Count() const
+    {
+        uint32_t count = 0;
+        for (uint64_t summary = m_Summary; summary != 0; summary &= summary - 1)
+        {
+            count += __builtin_popcountll(m_Words[__builtin_ctzll(summary)]);
+        }
+        return count;
+    }
+
+    uint64_t GetWord(uint32_t wordIndex) const
+    {
+        return m_Words[wordIndex];
+    }
+
+    // Sets all bits of `bits` in the given word
+    void OrWord(uint32_t wordIndex, uint64_t bits)
+    {
+        if (bits == 0)
+        {
+            return;
+        }
+        m_Words[wordIndex] |= bits;
+        m_Summary |= (1ULL << wordIndex);
+    }
+
+    // Clears every bit that is not set in `mask`
+    void AndWith(const HierarchicalBitmap& mask)
+    {
+        for (uint64_t summary = m_Summary; summary != 0; summary &= summary - 1)
+        {
+            uint32_t wordIndex = __builtin_ctzll(summary);
+            m_Words[wordIndex] &= mask.m_Words[wordIndex];
+            if (m_Words[wordIndex] == 0)
+            {
+                m_Summary &= ~(1ULL << wordIndex);
+            }
+        }
+    }
+
+    int32_t FindFirstClear() const
+    {
+        for (uint32_t wordIndex = 0; wordIndex < WORD_COUNT; wordIndex++)
+        {
+            if (m_Words[wordIndex] != ~0ULL)
+            {
+                return wordIndex * 64 + __builtin_ctzll(~m_Words[wordIndex]);
+            }
+        }
+        return NOT_FOUND;
+    }
+
+    // Calls fn(index) for every set bit in ascending order. The callback may set or clear bits;
+    // changes to bits of the word being visited are not seen until the next iteration.
+    template <typename Fn>
+    void ForEachSet(Fn&& fn) const
+    {
+        for (uint64_t summary = m_Summary; summary != 0; summary &= summary - 1)
+        {
+            uint32_t wordIndex = __builtin_ctzll(summary);
+            for (uint64_t word = m_Words[wordIndex]; word != 0; word &= word - 1)
+            {
+                fn(wordIndex * 64 + __builtin_ctzll(word));
+            }
+        }
+    }
+
+private:
+    uint64_t m_Summary { 0 };
+    std::array<uint64_t, WORD_COUNT> m_Words {};
+};
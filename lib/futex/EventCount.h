@@ -0,0 +1,93 @@
+#pragma once
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <climits>
+#include <cstdint>
+#include <cstring>
+#include <ctime>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "Logger.h"
+
+// Eventcount for use in shared memory: lets one side sleep until a condition it polls (e.g. "the
+// queue is not empty") may have become true, without the other side paying a syscall when nobody
+// sleeps. Zeroed memory is a valid initial state.
+//
+// A waiter registers itself, reads the epoch, re-checks its condition and only then sleeps on the
+// epoch. A notifier first makes the condition true, then checks for registered waiters and only
+// bumps the epoch and wakes them if there are any. The sequentially consistent fences on both
+// sides guarantee that either the waiter sees the condition or the notifier sees the waiter.
+struct EventCount
+{
+    std::atomic<uint32_t> epoch;
+    std::atomic<uint32_t> waiters;
+
+    // Called after making the condition true
+    void Notify()
+    {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (waiters.load(std::memory_order_relaxed) == 0)
+        {
+            return;
+        }
+
+        epoch.fetch_add(1, std::memory_order_release);
+        long res = syscall(SYS_futex, &epoch, FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+        if (res == -1)
+        {
+            LOG_LIMITED(LogLevel::Error, 10, "FUTEX_WAKE error({}): {}", errno, strerror(errno));
+        }
+    }
+
+    // Calls tryOperation until it succeeds or the timeout expires. It is retried spinCount times
+    // first, then the caller sleeps between retries until the other side notifies.
+    template <typename TryOperation>
+    bool Await(TryOperation tryOperation, std::chrono::nanoseconds timeout, uint32_t spinCount)
+    {
+        for (uint32_t spin = 0; spin < spinCount; spin++)
+        {
+            if (tryOperation())
+            {
+                return true;
+            }
+        }
+
+        auto deadline = std::chrono::steady_clock::now() + timeout;
+        while (true)
+        {
+            waiters.fetch_add(1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            uint32_t key = epoch.load(std::memory_order_relaxed);
+
+            if (tryOperation())
+            {
+                waiters.fetch_sub(1, std::memory_order_relaxed);
+                return true;
+            }
+
+            auto remaining = deadline - std::chrono::steady_clock::now();
+            if (remaining <= std::chrono::nanoseconds::zero())
+            {
+                waiters.fetch_sub(1, std::memory_order_relaxed);
+                return false;
+            }
+
+            // Returns at once if the epoch has moved on since it was read
+            auto remainingNs = std::chrono::duration_cast<std::chrono::nanoseconds>(remaining).count();
+            struct timespec relativeTimeout { static_cast<time_t>(remainingNs / 1000000000), static_cast<long>(remainingNs % 1000000000) };
+            long res = syscall(SYS_futex, &epoch, FUTEX_WAIT, key, &relativeTimeout, nullptr, 0);
+            if (res == -1 && errno != EAGAIN && errno != ETIMEDOUT && errno != EINTR)
+            {
+                LOG_LIMITED(LogLevel::Error, 10, "FUTEX_WAIT error({}): {}", errno, strerror(errno));
+            }
+
+            waiters.fetch_sub(1, std::memory_order_relaxed);
+        }
+    }
+};
+
+static_assert(std::atomic<uint32_t>::is_always_lock_free, "EventCount needs lock-free 32-bit atomics in shared memory");
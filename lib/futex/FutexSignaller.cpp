@@ -1,4 +1,3 @@
-#include <iostream>
 #include <cstdint>
 #include <sys/types.h>
 #include <sys/mman.h>
@@ -8,20 +7,42 @@
 #include <linux/futex.h>
 #include <sys/syscall.h>
 #include <sstream>
+#include <algorithm>
 #include <string>
 #include <cstring>
 #include <atomic>
 #include <fstream>
 #include <cstdlib>
+#include <chrono>
+#include <climits>
+#include <sched.h>
+#include <thread>
 
-#include "MemoryUtils.h"
 #include "FutexSignaller.h"
+#include "Logger.h"
+#include "MemoryUtils.h"
 
 using std::string;
 
-FutexSignaller::FutexSignaller(uint32_t ownerPid, Role role, const std::string& nameSuffix) : 
+static inline void CpuRelax()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    asm volatile("yield");
+#endif
+}
+
+static inline uint64_t NowNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+FutexSignaller::FutexSignaller(uint32_t ownerPid, Role role, const std::string& nameSuffix, WaitPolicy waitPolicy) : 
     m_OwnerPid(ownerPid),
-    m_Role(role)
+    m_Role(role),
+    m_WaitPolicy(waitPolicy),
+    m_SpinningUseful(std::thread::hardware_concurrency() > 1)
 {
     SharedMemory::Ownership ownership = (role == Role::Waiter) ? SharedMemory::Ownership::Owner : SharedMemory::Ownership::Borrower;
     SharedMemory::BufferInitMode bufferInitMode = role == Role::Waiter ? SharedMemory::BufferInitMode::Zero : SharedMemory::BufferInitMode::NoInit;
@@ -57,40 +78,180 @@ FutexSignaller::~FutexSignaller()
 }
 
 void FutexSignaller::Wait()
+{
+    switch (m_WaitPolicy)
+    {
+    case WaitPolicy::Spin:
+        while (!TryConsumeSignal())
+        {
+            CpuRelax();
+        }
+        break;
+
+    case WaitPolicy::SpinThenYield:
+        for (uint32_t spin = 0; !TryConsumeSignal(); spin++)
+        {
+            if (spin < YIELD_SPIN_COUNT)
+            {
+                CpuRelax();
+            }
+            else
+            {
+                sched_yield();
+            }
+        }
+        break;
+
+    case WaitPolicy::Hybrid:
+        WaitHybrid();
+        break;
+
+    case WaitPolicy::Futex:
+    default:
+        Sleep();
+        break;
+    }
+}
+
+bool FutexSignaller::TryConsumeSignal()
+{
+    // Plain load first so that polling does not take the cache line away from the waker
+    if (m_RawPointer->load(std::memory_order_relaxed) != STATE_SIGNALLED)
+    {
+        return false;
+    }
+
+    uint32_t expected = STATE_SIGNALLED;
+    return m_RawPointer->compare_exchange_strong(expected, STATE_IDLE, std::memory_order_acquire);
+}
+
+bool FutexSignaller::SpinFor(uint64_t spinNs)
+{
+    uint64_t deadlineNs = NowNs() + spinNs;
+    while (true)
+    {
+        // Reading the clock costs more than a poll, so only look at it every few polls
+        for (uint32_t spin = 0; spin < 64; spin++)
+        {
+            if (TryConsumeSignal())
+            {
+                return true;
+            }
+            CpuRelax();
+        }
+
+        if (NowNs() >= deadlineNs)
+        {
+            return false;
+        }
+    }
+}
+
+void FutexSignaller::Sleep()
 {
     // Loop is required to handle spurious wakeups in FUTEX_WAIT
     while (1)
     {
-        uint32_t expected = 1; // Reset expected value in each iteration as compare_exchange_strong modifies it if the condition fails
-        if (m_RawPointer->compare_exchange_strong(expected, 0))
+        uint32_t expected = STATE_IDLE;
+        if (!m_RawPointer->compare_exchange_strong(expected, STATE_SLEEPING, std::memory_order_acquire))
         {
-            // Already signalled. No waiting required. Set the futex to non-signalled state and return.
-            break;
+            if (expected == STATE_SIGNALLED)
+            {
+                // Already signalled. No waiting required. Set the futex to non-signalled state and return.
+                if (TryConsumeSignal())
+                {
+                    break;
+                }
+                continue;
+            }
+
+            // Still Sleeping after a spurious wakeup, so the waker has not been here yet
         }
 
-        long res = syscall(SYS_futex, m_RawPointer, FUTEX_WAIT, 0, nullptr, nullptr, 0);
-        if (res == -1 && errno != EAGAIN)
+        long res = syscall(SYS_futex, m_RawPointer, FUTEX_WAIT, STATE_SLEEPING, nullptr, nullptr, 0);
+        if (res == -1 && errno != EAGAIN && errno != EINTR)
         {
-            std::cout << "FUTEX_WAIT error(" << errno << "): " << strerror(errno) << std::endl;
+            LOG_LIMITED(LogLevel::Error, 10, "FUTEX_WAIT error({}): {}", errno, strerror(errno));
         }
     }
 }
 
+void FutexSignaller::WaitHybrid()
+{
+    uint64_t startNs = NowNs();
+
+    bool signalled = TryConsumeSignal();
+    if (!signalled && m_SpinningUseful && m_WaitEstimateNs <= HYBRID_MAX_SPIN_NS)
+    {
+        uint64_t spinNs = std::clamp<uint64_t>(2 * m_WaitEstimateNs, HYBRID_MIN_SPIN_NS, HYBRID_MAX_SPIN_NS);
+        signalled = SpinFor(spinNs);
+    }
+
+    if (!signalled)
+    {
+        Sleep();
+    }
+
+    // Same 1/8 weight as the server's service time estimate
+    uint64_t elapsedNs = NowNs() - startNs;
+    m_WaitEstimateNs = (m_WaitEstimateNs == 0) ? elapsedNs : (7 * m_WaitEstimateNs + elapsedNs) / 8;
+}
+
 bool FutexSignaller::IsWaiting()
 {
-    return (m_RawPointer->load(std::memory_order_relaxed) == 0);
+    return (m_RawPointer->load(std::memory_order_relaxed) != STATE_SIGNALLED);
 }
 
 void FutexSignaller::Wake()
 {
-    uint32_t expected = 0;
-    if (m_RawPointer->compare_exchange_strong(expected, 1))
+    // A waiter that is still polling sees the new state by itself
+    uint32_t previous = m_RawPointer->exchange(STATE_SIGNALLED, std::memory_order_acq_rel);
+    if (previous == STATE_SLEEPING)
     {
-        // Wake up one waiting thread if any.
         int res = syscall(SYS_futex, m_RawPointer, FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
         if (res == -1)
         {
-            std::cout << "FUTEX_WAKE error(" << errno << "): " << strerror(errno) << std::endl;
+            LOG_LIMITED(LogLevel::Error, 10, "FUTEX_WAKE error({}): {}", errno, strerror(errno));
+        }
+    }
+}
+
+void FutexSignaller::SetWaitPolicy(WaitPolicy waitPolicy)
+{
+    m_WaitPolicy = waitPolicy;
+}
+
+FutexSignaller::WaitPolicy FutexSignaller::GetWaitPolicy() const
+{
+    return m_WaitPolicy;
+}
+
+uint64_t FutexSignaller::GetWaitEstimateNs() const
+{
+    return m_WaitEstimateNs;
+}
+
+const char* FutexSignaller::WaitPolicyToString(WaitPolicy waitPolicy)
+{
+    switch (waitPolicy)
+    {
+    case WaitPolicy::Futex: return "futex";
+    case WaitPolicy::Spin: return "spin";
+    case WaitPolicy::SpinThenYield: return "yield";
+    case WaitPolicy::Hybrid: return "hybrid";
+    default: return "unknown";
+    }
+}
+
+bool FutexSignaller::ParseWaitPolicy(const std::string& name, WaitPolicy& waitPolicy)
+{
+    for (WaitPolicy candidate : { WaitPolicy::Futex, WaitPolicy::Spin, WaitPolicy::SpinThenYield, WaitPolicy::Hybrid })
+    {
+        if (name == WaitPolicyToString(candidate))
+        {
+            waitPolicy = candidate;
+            return true;
         }
     }
-}
\ No newline at end of file
+    return false;
+}
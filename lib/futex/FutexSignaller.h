@@ -1,11 +1,17 @@
 #pragma once
 
+#include <atomic>
 #include <cstdint>
 #include <string>
 #include <memory>
 
 #include "SharedMemory.h"
 
+// One-shot completion signal in shared memory between a waker and a single waiter thread.
+//
+// The futex word is Idle, Signalled or Sleeping. Only a waiter about to call FUTEX_WAIT moves it
+// to Sleeping, so Wake can tell from the word it replaces whether the syscall is needed at all.
+// A waiter that is still spinning when the signal comes is never woken through the kernel.
 class FutexSignaller {
 public:
     enum class Role
@@ -14,7 +20,16 @@ public:
         Waiter
     };
 
-    FutexSignaller(uint32_t ownerPid, Role role, const std::string& nameSuffix);
+    // How the waiter waits for the signal. Only affects the waiter's side; Wake works with any.
+    enum class WaitPolicy
+    {
+        Futex,          // Sleep in the kernel right away
+        Spin,           // Poll the futex word until signalled, never sleep
+        SpinThenYield,  // Poll for a while, then keep polling with sched_yield in between
+        Hybrid          // Poll for about as long as recent waits took, then sleep in the kernel
+    };
+
+    FutexSignaller(uint32_t ownerPid, Role role, const std::string& nameSuffix, WaitPolicy waitPolicy = WaitPolicy::Futex);
     ~FutexSignaller();
 
     const std::string& GetName() const;
@@ -23,12 +38,43 @@ public:
 
     void Wake();
 
+    void SetWaitPolicy(WaitPolicy waitPolicy);
+    WaitPolicy GetWaitPolicy() const;
+
+    // Moving average of how long Wait took, only kept by the Hybrid policy
+    uint64_t GetWaitEstimateNs() const;
+
+    static const char* WaitPolicyToString(WaitPolicy waitPolicy);
+    static bool ParseWaitPolicy(const std::string& name, WaitPolicy& waitPolicy);
+
     std::atomic<uint32_t> *m_RawPointer;
 private:
+    static constexpr uint32_t STATE_IDLE = 0;
+    static constexpr uint32_t STATE_SIGNALLED = 1;
+    static constexpr uint32_t STATE_SLEEPING = 2;
+
+    // Polls before SpinThenYield starts yielding
+    static constexpr uint32_t YIELD_SPIN_COUNT = 1 << 12;
+
+    // Hybrid polls for twice the recent wait time, within these bounds. Waits longer than the
+    // upper bound are not worth spinning for and go to the kernel at once.
+    static constexpr uint64_t HYBRID_MIN_SPIN_NS = 2000;
+    static constexpr uint64_t HYBRID_MAX_SPIN_NS = 100000;
+
     static std::string CreateShmObjectName(uint32_t ownerPid, const std::string& nameSuffix);
 
+    bool TryConsumeSignal();
+    bool SpinFor(uint64_t spinNs);
+    void Sleep();
+    void WaitHybrid();
+
     uint32_t m_OwnerPid;
     Role m_Role;
+    WaitPolicy m_WaitPolicy;
+
+    // Spinning only pays off if the waker can run at the same time
+    bool m_SpinningUseful;
+    uint64_t m_WaitEstimateNs { 0 };
 
     std::unique_ptr<SharedMemory> mp_SharedMemory;
 
@@ -0,0 +1,342 @@
+#include <algorithm>
+#include <cerrno>
+#include <csignal>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <pthread.h>
+#include <thread>
+#include <unistd.h>
+#include <utility>
+#include <vector>
+
+#include "Logger.h"
+
+struct alignas(64) LogRing
+{
+    // Written by the logging thread
+    std::atomic<uint64_t> head { 0 };
+    std::atomic<uint64_t> droppedCount { 0 };
+
+    // Written by the background thread
+    alignas(64) std::atomic<uint64_t> tail { 0 };
+    uint64_t reportedDroppedCount { 0 };
+
+    std::unique_ptr<LogRecord[]> pRecords { std::make_unique<LogRecord[]>(Logger::RING_CAPACITY) };
+};
+
+// Never destroyed: the background thread keeps using it until the process is gone, and rings
+// outlive their threads so that nothing they logged is lost
+struct LoggerState
+{
+    std::mutex mutex;
+    std::vector<LogRing*> rings;
+    std::atomic<int> outputFd { STDERR_FILENO };
+    std::once_flag startFlag;
+};
+
+static LoggerState& GetState()
+{
+    static LoggerState* pState = new LoggerState();
+    return *pState;
+}
+
+static thread_local LogRing* t_pRing = nullptr;
+
+static constexpr auto IDLE_POLL_INTERVAL = std::chrono::milliseconds(1);
+
+static void WriteAll(int fd, const std::string& output)
+{
+    size_t written = 0;
+    while (written < output.size())
+    {
+        ssize_t result = write(fd, output.data() + written, output.size() - written);
+        if (result < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (result <= 0)
+        {
+            return;
+        }
+        written += result;
+    }
+}
+
+static void BackgroundThread()
+{
+    LoggerState& state = GetState();
+    std::vector<LogRing*> rings;
+    std::vector<std::pair<uint64_t, std::string>> lines;
+    std::vector<std::pair<LogRing*, uint64_t>> drainedHeads;
+    std::string output;
+
+    while (true)
+    {
+        {
+            std::lock_guard<std::mutex> lock(state.mutex);
+            rings = state.rings;
+        }
+
+        lines.clear();
+        drainedHeads.clear();
+        for (LogRing* pRing : rings)
+        {
+            uint64_t head = pRing->head.load(std::memory_order_acquire);
+            for (uint64_t index = pRing->tail.load(std::memory_order_relaxed); index < head; index++)
+            {
+                const LogRecord& record = pRing->pRecords[index % Logger::RING_CAPACITY];
+                lines.emplace_back(record.ticks, Logger::FormatRecord(record));
+            }
+
+            uint64_t droppedCount = pRing->droppedCount.load(std::memory_order_relaxed);
+            if (droppedCount != pRing->reportedDroppedCount)
+            {
+                uint64_t nowTicks = TscClock::Now();
+                lines.emplace_back(nowTicks, Logger::FormatPrefix(nowTicks, LogLevel::Warning) + "Dropped " + std::to_string(droppedCount - pRing->reportedDroppedCount) + " log records of a thread that logged faster than they were written");
+                pRing->reportedDroppedCount = droppedCount;
+            }
+            drainedHeads.emplace_back(pRing, head);
+        }
+
+        if (lines.empty())
+        {
+            std::this_thread::sleep_for(IDLE_POLL_INTERVAL);
+            continue;
+        }
+
+        // Interleaves the threads' records in the order they were logged
+        std::stable_sort(lines.begin(), lines.end(), [](const auto& a, const auto& b)
+        {
+            return a.first < b.first;
+        });
+
+        output.clear();
+        for (const auto& [ticks, line] : lines)
+        {
+            output += line;
+            output += '\n';
+        }
+        WriteAll(state.outputFd.load(std::memory_order_relaxed), output);
+
+        // Only now are the slots handed back, so Flush() returns once the lines are written
+        for (const auto& [pRing, head] : drainedHeads)
+        {
+            pRing->tail.store(head, std::memory_order_release);
+        }
+    }
+}
+
+static void FlushAtExit()
+{
+    Logger::Flush();
+}
+
+static LogRing* GetRing()
+{
+    if (t_pRing != nullptr)
+    {
+        return t_pRing;
+    }
+
+    LoggerState& state = GetState();
+    LogRing* pRing = new LogRing();
+    {
+        std::lock_guard<std::mutex> lock(state.mutex);
+        state.rings.push_back(pRing);
+    }
+
+    std::call_once(state.startFlag, []()
+    {
+        // The background thread may start before a program sets up signal handling (e.g. the
+        // trace control signals), so it blocks every signal and never takes one meant for
+        // another thread
+        sigset_t allSignals;
+        sigset_t previousSignals;
+        sigfillset(&allSignals);
+        pthread_sigmask(SIG_SETMASK, &allSignals, &previousSignals);
+        std::thread(BackgroundThread).detach();
+        pthread_sigmask(SIG_SETMASK, &previousSignals, nullptr);
+
+        std::atexit(FlushAtExit);
+    });
+
+    t_pRing = pRing;
+    return pRing;
+}
+
+const char* Logger::LevelToString(LogLevel level)
+{
+    switch (level)
+    {
+    case LogLevel::Debug:
+        return "debug";
+    case LogLevel::Info:
+        return "info";
+    case LogLevel::Warning:
+        return "warning";
+    case LogLevel::Error:
+        return "error";
+    case LogLevel::Off:
+        return "off";
+    default:
+        return "unknown";
+    }
+}
+
+bool Logger::ParseLevel(const std::string& text, LogLevel& level)
+{
+    for (LogLevel candidate : { LogLevel::Debug, LogLevel::Info, LogLevel::Warning, LogLevel::Error, LogLevel::Off })
+    {
+        if (text == LevelToString(candidate))
+        {
+            level = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool Logger::SetLevelFromEnvironment(const char* variableName)
+{
+    const char* pValue = std::getenv(variableName);
+    if (pValue == nullptr)
+    {
+        return true;
+    }
+
+    LogLevel level;
+    if (!ParseLevel(pValue, level))
+    {
+        return false;
+    }
+
+    SetLevel(level);
+    return true;
+}
+
+void Logger::SetOutput(int fd)
+{
+    GetState().outputFd.store(fd, std::memory_order_relaxed);
+}
+
+void Logger::PrepareThread()
+{
+    GetRing();
+}
+
+LogRecord* Logger::BeginRecord()
+{
+    LogRing& ring = *GetRing();
+    uint64_t head = ring.head.load(std::memory_order_relaxed);
+    if (head - ring.tail.load(std::memory_order_acquire) == RING_CAPACITY)
+    {
+        // Single writer, so a plain add keeps a flooding thread free of locked instructions
+        ring.droppedCount.store(ring.droppedCount.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        return nullptr;
+    }
+    return &ring.pRecords[head % RING_CAPACITY];
+}
+
+void Logger::CommitRecord()
+{
+    LogRing& ring = *t_pRing;
+    ring.head.store(ring.head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+bool Logger::Flush(uint32_t timeoutMs)
+{
+    LoggerState& state = GetState();
+    std::vector<std::pair<LogRing*, uint64_t>> heads;
+    {
+        std::lock_guard<std::mutex> lock(state.mutex);
+        for (LogRing* pRing : state.rings)
+        {
+            heads.emplace_back(pRing, pRing->head.load(std::memory_order_acquire));
+        }
+    }
+
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+    for (const auto& [pRing, head] : heads)
+    {
+        while (pRing->tail.load(std::memory_order_acquire) < head)
+        {
+            if (std::chrono::steady_clock::now() >= deadline)
+            {
+                return false;
+            }
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+        }
+    }
+    return true;
+}
+
+uint64_t Logger::GetDroppedCount()
+{
+    LoggerState& state = GetState();
+    std::lock_guard<std::mutex> lock(state.mutex);
+
+    uint64_t droppedCount = 0;
+    for (LogRing* pRing : state.rings)
+    {
+        droppedCount += pRing->droppedCount.load(std::memory_order_relaxed);
+    }
+    return droppedCount;
+}
+
+std::string Logger::FormatPrefix(uint64_t ticks, LogLevel level)
+{
+    uint64_t ns = TscClock::TicksToNs(ticks);
+    char buffer[64];
+    snprintf(buffer, sizeof(buffer), "[%llu.%06llu] [%s] ", static_cast<unsigned long long>(ns / 1000000000), static_cast<unsigned long long>(ns % 1000000000 / 1000), LevelToString(level));
+    return buffer;
+}
+
+std::string Logger::FormatRecord(const LogRecord& record)
+{
+    std::string line = FormatPrefix(record.ticks, record.level);
+    uint32_t argumentIndex = 0;
+    for (const char* pCharacter = record.format; *pCharacter != '\0'; pCharacter++)
+    {
+        if (pCharacter[0] != '{' || pCharacter[1] != '}' || argumentIndex == record.argumentCount)
+        {
+            line += *pCharacter;
+            continue;
+        }
+
+        uint64_t value = record.values[argumentIndex];
+        switch (record.types[argumentIndex])
+        {
+        case LogArgumentType::Signed:
+            line += std::to_string(static_cast<int64_t>(value));
+            break;
+        case LogArgumentType::Unsigned:
+            line += std::to_string(value);
+            break;
+        case LogArgumentType::Double:
+        {
+            // Same as an ostream with default settings
+            double doubleValue;
+            std::memcpy(&doubleValue, &value, sizeof(doubleValue));
+            char buffer[32];
+            snprintf(buffer, sizeof(buffer), "%g", doubleValue);
+            line += buffer;
+            break;
+        }
+        case LogArgumentType::Text:
+            line.append(record.text + (value >> 16), value & 0xFFFF);
+            break;
+        }
+
+        argumentIndex++;
+        pCharacter++;
+    }
+
+    if (record.suppressedCount != 0)
+    {
+        line += " (" + std::to_string(record.suppressedCount) + " similar messages suppressed)";
+    }
+    return line;
+}
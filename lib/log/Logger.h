@@ -0,0 +1,252 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+#include "TscClock.h"
+
+enum class LogLevel : uint8_t
+{
+    Debug,
+    Info,
+    Warning,
+    Error,
+    Off,
+};
+
+enum class LogArgumentType : uint8_t
+{
+    Signed,
+    Unsigned,
+    Double,
+    Text,
+};
+
+// One log line before formatting. The format is a string literal with a {} for each argument.
+// Numbers are stored as they are and strings are copied into text, so the record stays valid
+// after the caller's strings are gone.
+struct LogRecord
+{
+    static constexpr uint32_t MAX_ARGUMENTS = 16;
+    static constexpr uint32_t TEXT_CAPACITY = 344;
+
+    uint64_t ticks;
+    const char* format;
+    LogLevel level;
+    uint8_t argumentCount;
+    uint16_t textLength;
+
+    // Records of the same rate limited call site dropped since the previous one
+    uint32_t suppressedCount;
+    std::array<LogArgumentType, MAX_ARGUMENTS> types;
+
+    // Text arguments are stored as offset << 16 | length
+    std::array<uint64_t, MAX_ARGUMENTS> values;
+    char text[TEXT_CAPACITY];
+};
+
+static_assert(sizeof(LogRecord) == 512, "LogRecord should stay a whole number of cache lines");
+
+// Asynchronous logger. Logging threads encode their records into a ring of their own, without
+// locks, allocations or system calls, and a background thread formats them and writes them to
+// the output in timestamp order. A thread whose ring is full drops the record and the drop is
+// reported later, so logging never blocks the caller.
+//
+// Use the LOG_* macros, which skip evaluating the arguments of disabled levels, and
+// LOG_LIMITED for messages that a peer can trigger at will.
+class Logger
+{
+public:
+    // Records each logging thread can have waiting for the background thread
+    static constexpr uint32_t RING_CAPACITY = 256;
+
+    static void SetLevel(LogLevel level)
+    {
+        s_Level.store(level, std::memory_order_relaxed);
+    }
+
+    static LogLevel GetLevel()
+    {
+        return s_Level.load(std::memory_order_relaxed);
+    }
+
+    static bool IsEnabled(LogLevel level)
+    {
+        return level >= s_Level.load(std::memory_order_relaxed);
+    }
+
+    static const char* LevelToString(LogLevel level);
+    static bool ParseLevel(const std::string& text, LogLevel& level);
+
+    // Sets the level from an environment variable holding debug, info, warning, error or off.
+    // Returns false if the variable holds something else.
+    static bool SetLevelFromEnvironment(const char* variableName);
+
+    // Descriptor the background thread writes to, stderr by default
+    static void SetOutput(int fd);
+
+    // Sets up the calling thread's ring ahead of its first record, for threads that must not
+    // allocate once they are running
+    static void PrepareThread();
+
+    template<typename... Args>
+    static void Write(LogLevel level, uint32_t suppressedCount, const char* format, const Args&... args)
+    {
+        static_assert(sizeof...(Args) <= LogRecord::MAX_ARGUMENTS, "Too many log arguments");
+
+        LogRecord* pRecord = BeginRecord();
+        if (pRecord == nullptr)
+        {
+            return;
+        }
+
+        pRecord->ticks = TscClock::Now();
+        pRecord->format = format;
+        pRecord->level = level;
+        pRecord->argumentCount = 0;
+        pRecord->textLength = 0;
+        pRecord->suppressedCount = suppressedCount;
+        (Encode(*pRecord, args), ...);
+        CommitRecord();
+    }
+
+    // Waits until the background thread has written every record logged before the call, for
+    // at most timeoutMs. Returns false on timeout.
+    static bool Flush(uint32_t timeoutMs = 1000);
+
+    // Records dropped because their thread's ring was full
+    static uint64_t GetDroppedCount();
+
+    // Start of every written line: the time in seconds and the level. The time is the record's
+    // TscClock ticks converted to nanoseconds. Processes on the same clock mode count from the
+    // same point, so the lines of a server and its clients can be lined up.
+    static std::string FormatPrefix(uint64_t ticks, LogLevel level);
+
+    // The line a record is written as, without the newline
+    static std::string FormatRecord(const LogRecord& record);
+
+private:
+    template<typename T>
+    static void Encode(LogRecord& record, const T& value)
+    {
+        uint32_t index = record.argumentCount++;
+        if constexpr (std::is_same_v<T, char>)
+        {
+            EncodeText(record, index, std::string_view(&value, 1));
+        }
+        else if constexpr (std::is_integral_v<T> && std::is_signed_v<T>)
+        {
+            record.types[index] = LogArgumentType::Signed;
+            record.values[index] = static_cast<uint64_t>(static_cast<int64_t>(value));
+        }
+        else if constexpr (std::is_integral_v<T>)
+        {
+            record.types[index] = LogArgumentType::Unsigned;
+            record.values[index] = static_cast<uint64_t>(value);
+        }
+        else if constexpr (std::is_floating_point_v<T>)
+        {
+            double doubleValue = static_cast<double>(value);
+            record.types[index] = LogArgumentType::Double;
+            std::memcpy(&record.values[index], &doubleValue, sizeof(doubleValue));
+        }
+        else
+        {
+            static_assert(std::is_convertible_v<const T&, std::string_view>, "Log arguments must be numbers or strings");
+            EncodeText(record, index, std::string_view(value));
+        }
+    }
+
+    // Copies as much of the text as still fits into the record
+    static void EncodeText(LogRecord& record, uint32_t index, std::string_view text)
+    {
+        uint32_t length = std::min<uint32_t>(text.size(), LogRecord::TEXT_CAPACITY - record.textLength);
+        std::memcpy(record.text + record.textLength, text.data(), length);
+        record.types[index] = LogArgumentType::Text;
+        record.values[index] = (static_cast<uint64_t>(record.textLength) << 16) | length;
+        record.textLength += length;
+    }
+
+    // Slot for the calling thread's next record, or nullptr if its ring is full
+    static LogRecord* BeginRecord();
+    static void CommitRecord();
+
+    static inline std::atomic<LogLevel> s_Level { LogLevel::Info };
+};
+
+// Lets through at most maxPerSecond records per second and counts the others, so that a call
+// site a peer can trigger in a loop costs little and cannot flood the output
+class LogRateLimiter
+{
+public:
+    explicit LogRateLimiter(uint32_t maxPerSecond) :
+        m_MaxPerSecond(maxPerSecond)
+    {
+    }
+
+    // Returns whether a record may be logged now, with the records suppressed since the last one
+    bool Allow(uint32_t& suppressedCount)
+    {
+        uint64_t nowTicks = TscClock::Now();
+        uint64_t windowTicks = static_cast<uint64_t>(1e9 * TscClock::GetTicksPerNs());
+        uint64_t windowStartTicks = m_WindowStartTicks.load(std::memory_order_relaxed);
+
+        // Also starts a new window if the clock was calibrated since, which changes the ticks
+        if (nowTicks - windowStartTicks >= windowTicks &&
+            m_WindowStartTicks.compare_exchange_strong(windowStartTicks, nowTicks, std::memory_order_relaxed))
+        {
+            m_WindowCount.store(0, std::memory_order_relaxed);
+        }
+
+        if (m_WindowCount.fetch_add(1, std::memory_order_relaxed) >= m_MaxPerSecond)
+        {
+            m_SuppressedCount.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+
+        suppressedCount = m_SuppressedCount.exchange(0, std::memory_order_relaxed);
+        return true;
+    }
+
+private:
+    uint32_t m_MaxPerSecond;
+    std::atomic<uint64_t> m_WindowStartTicks { 0 };
+    std::atomic<uint32_t> m_WindowCount { 0 };
+    std::atomic<uint32_t> m_SuppressedCount { 0 };
+};
+
+#define LOG(level, ...) \
+    do \
+    { \
+        if (Logger::IsEnabled(level)) \
+        { \
+            Logger::Write(level, 0, __VA_ARGS__); \
+        } \
+    } while (0)
+
+#define LOG_DEBUG(...) LOG(LogLevel::Debug, __VA_ARGS__)
+#define LOG_INFO(...) LOG(LogLevel::Info, __VA_ARGS__)
+#define LOG_WARNING(...) LOG(LogLevel::Warning, __VA_ARGS__)
+#define LOG_ERROR(...) LOG(LogLevel::Error, __VA_ARGS__)
+
+// At most maxPerSecond records per second from this call site; the next record let through says
+// how many were suppressed
+#define LOG_LIMITED(level, maxPerSecond, ...) \
+    do \
+    { \
+        if (Logger::IsEnabled(level)) \
+        { \
+            static LogRateLimiter rateLimiter(maxPerSecond); \
+            uint32_t suppressedCount; \
+            if (rateLimiter.Allow(suppressedCount)) \
+            { \
+                Logger::Write(level, suppressedCount, __VA_ARGS__); \
+            } \
+        } \
+    } while (0)
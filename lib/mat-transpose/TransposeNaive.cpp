@@ -1,4 +1,5 @@
 #include <cstdint>
+#include <utility>
 
 void TransposeNaive(uint64_t* src, uint64_t* dst, uint32_t rowCount, uint32_t colCount)
 {
@@ -9,4 +10,16 @@ void TransposeNaive(uint64_t* src, uint64_t* dst, uint32_t rowCount, uint32_t co
             dst[j * rowCount + i] = src[i * colCount + j];
         }
     }
-}
\ No newline at end of file
+}
+
+// Square matrices only
+void TransposeNaiveInPlace(uint64_t* matrix, uint32_t rowCount)
+{
+    for (uint32_t i = 0; i < rowCount; i++)
+    {
+        for (uint32_t j = i + 1; j < rowCount; j++)
+        {
+            std::swap(matrix[i * rowCount + j], matrix[j * rowCount + i]);
+        }
+    }
+}
@@ -0,0 +1,100 @@
+#include <cstdint>
+#include <utility>
+
+// Blocks at most this wide and tall are transposed with plain loops. Two 16x16 blocks of
+// uint64_t take 4 KB, which fits L1 on anything this runs on.
+static constexpr uint32_t RECURSION_BLOCK_SIZE = 16;
+
+// Transposes rows [iStart, iEnd) and columns [jStart, jEnd) of src, halving the longer side
+// until the block fits in cache. No tile size to tune: every level of the cache hierarchy sees
+// blocks of about its own size.
+static void TransposeRecursiveBlock(uint64_t* src, uint64_t* dst, uint32_t rowCount, uint32_t colCount, uint32_t iStart, uint32_t iEnd, uint32_t jStart, uint32_t jEnd)
+{
+    if (iEnd - iStart <= RECURSION_BLOCK_SIZE && jEnd - jStart <= RECURSION_BLOCK_SIZE)
+    {
+        for (uint32_t i = iStart; i < iEnd; i++)
+        {
+            for (uint32_t j = jStart; j < jEnd; j++)
+            {
+                dst[j * rowCount + i] = src[i * colCount + j];
+            }
+        }
+        return;
+    }
+
+    if (iEnd - iStart >= jEnd - jStart)
+    {
+        uint32_t iMiddle = iStart + (iEnd - iStart) / 2;
+        TransposeRecursiveBlock(src, dst, rowCount, colCount, iStart, iMiddle, jStart, jEnd);
+        TransposeRecursiveBlock(src, dst, rowCount, colCount, iMiddle, iEnd, jStart, jEnd);
+    }
+    else
+    {
+        uint32_t jMiddle = jStart + (jEnd - jStart) / 2;
+        TransposeRecursiveBlock(src, dst, rowCount, colCount, iStart, iEnd, jStart, jMiddle);
+        TransposeRecursiveBlock(src, dst, rowCount, colCount, iStart, iEnd, jMiddle, jEnd);
+    }
+}
+
+// Swaps the block at rows [iStart, iEnd) and columns [jStart, jEnd), which lies above the
+// diagonal, with its mirror image below it
+static void SwapRecursiveBlocks(uint64_t* matrix, uint32_t rowCount, uint32_t iStart, uint32_t iEnd, uint32_t jStart, uint32_t jEnd)
+{
+    if (iEnd - iStart <= RECURSION_BLOCK_SIZE && jEnd - jStart <= RECURSION_BLOCK_SIZE)
+    {
+        for (uint32_t i = iStart; i < iEnd; i++)
+        {
+            for (uint32_t j = jStart; j < jEnd; j++)
+            {
+                std::swap(matrix[i * rowCount + j], matrix[j * rowCount + i]);
+            }
+        }
+        return;
+    }
+
+    if (iEnd - iStart >= jEnd - jStart)
+    {
+        uint32_t iMiddle = iStart + (iEnd - iStart) / 2;
+        SwapRecursiveBlocks(matrix, rowCount, iStart, iMiddle, jStart, jEnd);
+        SwapRecursiveBlocks(matrix, rowCount, iMiddle, iEnd, jStart, jEnd);
+    }
+    else
+    {
+        uint32_t jMiddle = jStart + (jEnd - jStart) / 2;
+        SwapRecursiveBlocks(matrix, rowCount, iStart, iEnd, jStart, jMiddle);
+        SwapRecursiveBlocks(matrix, rowCount, iStart, iEnd, jMiddle, jEnd);
+    }
+}
+
+// Transposes the square block on the diagonal at rows and columns [start, end)
+static void TransposeRecursiveDiagonal(uint64_t* matrix, uint32_t rowCount, uint32_t start, uint32_t end)
+{
+    if (end - start <= RECURSION_BLOCK_SIZE)
+    {
+        for (uint32_t i = start; i < end; i++)
+        {
+            for (uint32_t j = i + 1; j < end; j++)
+            {
+                std::swap(matrix[i * rowCount + j], matrix[j * rowCount + i]);
+            }
+        }
+        return;
+    }
+
+    uint32_t middle = start + (end - start) / 2;
+    TransposeRecursiveDiagonal(matrix, rowCount, start, middle);
+    TransposeRecursiveDiagonal(matrix, rowCount, middle, end);
+    SwapRecursiveBlocks(matrix, rowCount, start, middle, middle, end);
+}
+
+// Cache-oblivious transpose
+void TransposeRecursive(uint64_t* src, uint64_t* dst, uint32_t rowCount, uint32_t colCount)
+{
+    TransposeRecursiveBlock(src, dst, rowCount, colCount, 0, rowCount, 0, colCount);
+}
+
+// Cache-oblivious transpose of a square matrix in place
+void TransposeRecursiveInPlace(uint64_t* matrix, uint32_t rowCount)
+{
+    TransposeRecursiveDiagonal(matrix, rowCount, 0, rowCount);
+}
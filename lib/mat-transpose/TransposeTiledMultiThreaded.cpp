@@ -1,5 +1,7 @@
+#include <algorithm>
 #include <cstdint>
 #include <thread>
+#include <utility>
 #include <vector>
 
 struct Block
@@ -14,17 +16,18 @@ void TransposeTiledMultiThreaded(uint64_t* src, uint64_t* dst, uint32_t rowCount
     uint32_t numBlocksInCol = (colCount + tileSize - 1) / tileSize;
     
     std::vector<std::thread> threads(numThreads);
-    std::vector<Block> blocks(numBlocksInRow * numBlocksInCol);
+    std::vector<Block> blocks;
+    blocks.reserve(numBlocksInRow * numBlocksInCol);
 
-    // Works only for matrices with row/column count of power of 2
+    // Tiles in the last block row and column are cut off at the matrix edge
     for (uint32_t bj = 0; bj < numBlocksInCol; bj++)
     {
         for (uint32_t bi = 0; bi < numBlocksInRow; bi++)
         {
             uint32_t iStart = bi * tileSize;
             uint32_t jStart = bj * tileSize;
-            uint32_t iEnd = iStart + tileSize, rowCount;
-            uint32_t jEnd = jStart + tileSize, colCount;
+            uint32_t iEnd = std::min(iStart + tileSize, rowCount);
+            uint32_t jEnd = std::min(jStart + tileSize, colCount);
             blocks.push_back({iStart, iEnd, jStart, jEnd});
         }
     }
@@ -51,4 +54,52 @@ void TransposeTiledMultiThreaded(uint64_t* src, uint64_t* dst, uint32_t rowCount
     {
         th.join();
     }
-}
\ No newline at end of file
+}
+
+// Square matrices only. Each diagonal tile is transposed in place, and each tile above the
+// diagonal is swapped with its mirror below it. No two threads touch the same tile pair, so they
+// need no synchronisation.
+void TransposeTiledInPlaceMultiThreaded(uint64_t* matrix, uint32_t rowCount, uint32_t tileSize, uint32_t numThreads)
+{
+    uint32_t numBlocks = (rowCount + tileSize - 1) / tileSize;
+
+    std::vector<std::pair<uint32_t, uint32_t>> blockPairs;
+    blockPairs.reserve(static_cast<size_t>(numBlocks) * (numBlocks + 1) / 2);
+    for (uint32_t bi = 0; bi < numBlocks; bi++)
+    {
+        for (uint32_t bj = bi; bj < numBlocks; bj++)
+        {
+            blockPairs.push_back({ bi, bj });
+        }
+    }
+
+    std::vector<std::thread> threads(numThreads);
+    for (uint32_t t = 0; t < numThreads; t++)
+    {
+        threads[t] = std::thread([&, t]()
+        {
+            for (size_t idx = t; idx < blockPairs.size(); idx += numThreads)
+            {
+                auto [bi, bj] = blockPairs[idx];
+                uint32_t iStart = bi * tileSize;
+                uint32_t iEnd = std::min(iStart + tileSize, rowCount);
+                uint32_t jStart = bj * tileSize;
+                uint32_t jEnd = std::min(jStart + tileSize, rowCount);
+
+                for (uint32_t i = iStart; i < iEnd; i++)
+                {
+                    // On a diagonal tile only the part above the diagonal is swapped
+                    for (uint32_t j = (bi == bj) ? i + 1 : jStart; j < jEnd; j++)
+                    {
+                        std::swap(matrix[i * rowCount + j], matrix[j * rowCount + i]);
+                    }
+                }
+            }
+        });
+    }
+
+    for (auto& th : threads)
+    {
+        th.join();
+    }
+}
@@ -0,0 +1,37 @@
+#include <algorithm>
+#include <cstdint>
+
+uint32_t TiledTileCount(uint32_t rowCount, uint32_t colCount, uint32_t tileSize)
+{
+    uint32_t numBlocksInRow = (rowCount + tileSize - 1) / tileSize;
+    uint32_t numBlocksInCol = (colCount + tileSize - 1) / tileSize;
+
+    return numBlocksInRow * numBlocksInCol;
+}
+
+// Transposes tiles [firstTile, endTile) on the calling thread. Tiles are numbered in the same
+// column-of-blocks-major order used by TransposeTiledMultiThreaded, so any partition of
+// [0, TiledTileCount()) into ranges covers the whole matrix exactly once.
+void TransposeTiledTileRange(uint64_t* src, uint64_t* dst, uint32_t rowCount, uint32_t colCount, uint32_t tileSize, uint32_t firstTile, uint32_t endTile)
+{
+    uint32_t numBlocksInRow = (rowCount + tileSize - 1) / tileSize;
+
+    for (uint32_t tile = firstTile; tile < endTile; tile++)
+    {
+        uint32_t bi = tile % numBlocksInRow;
+        uint32_t bj = tile / numBlocksInRow;
+
+        uint32_t iStart = bi * tileSize;
+        uint32_t jStart = bj * tileSize;
+        uint32_t iEnd = std::min(iStart + tileSize, rowCount);
+        uint32_t jEnd = std::min(jStart + tileSize, colCount);
+
+        for (uint32_t i = iStart; i < iEnd; i++)
+        {
+            for (uint32_t j = jStart; j < jEnd; j++)
+            {
+                dst[j * rowCount + i] = src[i * colCount + j];
+            }
+        }
+    }
+}
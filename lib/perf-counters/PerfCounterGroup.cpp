@@ -0,0 +1,182 @@
+#include <cerrno>
+#include <cstring>
+#include <linux/perf_event.h>
+#include <sstream>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "PerfCounterGroup.h"
+
+struct CounterConfig
+{
+    uint32_t type;
+    uint64_t config;
+};
+
+static constexpr uint64_t HwCacheConfig(uint64_t cache, uint64_t op, uint64_t result)
+{
+    return cache | (op << 8) | (result << 16);
+}
+
+static constexpr std::array<CounterConfig, PERF_COUNTER_COUNT> COUNTER_CONFIGS = {{
+    { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+    { PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+    { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES },
+    { PERF_TYPE_HW_CACHE, HwCacheConfig(PERF_COUNT_HW_CACHE_DTLB, PERF_COUNT_HW_CACHE_OP_READ, PERF_COUNT_HW_CACHE_RESULT_MISS) },
+    { PERF_TYPE_HARDWARE, PERF_COUNT_HW_STALLED_CYCLES_BACKEND },
+    { PERF_TYPE_SOFTWARE, PERF_COUNT_SW_TASK_CLOCK },
+}};
+
+// Layout of a group read with PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING
+struct GroupReadFormat
+{
+    uint64_t counterCount;
+    uint64_t timeEnabled;
+    uint64_t timeRunning;
+    uint64_t values[PERF_COUNTER_COUNT];
+};
+
+static int OpenCounter(const CounterConfig& counterConfig, int groupFd)
+{
+    struct perf_event_attr attributes;
+    memset(&attributes, 0, sizeof(attributes));
+    attributes.size = sizeof(attributes);
+    attributes.type = counterConfig.type;
+    attributes.config = counterConfig.config;
+    attributes.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    attributes.exclude_kernel = 1;
+    attributes.exclude_hv = 1;
+
+    // The members follow the leader, which is enabled once the whole group is open
+    attributes.disabled = (groupFd == -1) ? 1 : 0;
+
+    return static_cast<int>(syscall(SYS_perf_event_open, &attributes, 0, -1, groupFd, PERF_FLAG_FD_CLOEXEC));
+}
+
+PerfCounterGroup::PerfCounterGroup()
+{
+    m_Fds.fill(-1);
+    std::ostringstream errors;
+
+    for (uint32_t counter = 0; counter < PERF_COUNTER_COUNT; counter++)
+    {
+        int fd = OpenCounter(COUNTER_CONFIGS[counter], m_LeaderFd);
+        if (fd < 0)
+        {
+            int openErrno = errno;
+            errors << (errors.tellp() > 0 ? ", " : "") << CounterName(static_cast<PerfCounter>(counter)) << ": " << strerror(openErrno);
+            continue;
+        }
+
+        if (m_LeaderFd == -1)
+        {
+            m_LeaderFd = fd;
+        }
+
+        m_Fds[counter] = fd;
+        m_ReadIndices[counter] = m_OpenedCount++;
+        m_AvailableMask |= 1u << counter;
+    }
+
+    m_Error = errors.str();
+
+    if (m_LeaderFd != -1)
+    {
+        ioctl(m_LeaderFd, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+        ioctl(m_LeaderFd, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    }
+}
+
+PerfCounterGroup::~PerfCounterGroup()
+{
+    for (int fd : m_Fds)
+    {
+        if (fd >= 0)
+        {
+            close(fd);
+        }
+    }
+}
+
+bool PerfCounterGroup::IsAvailable() const
+{
+    return m_LeaderFd != -1;
+}
+
+bool PerfCounterGroup::IsCounterAvailable(PerfCounter counter) const
+{
+    return (m_AvailableMask & (1u << static_cast<uint32_t>(counter))) != 0;
+}
+
+uint32_t PerfCounterGroup::GetAvailableMask() const
+{
+    return m_AvailableMask;
+}
+
+const std::string& PerfCounterGroup::GetError() const
+{
+    return m_Error;
+}
+
+bool PerfCounterGroup::Read(PerfCounterValues& values) const
+{
+    if (m_LeaderFd == -1)
+    {
+        return false;
+    }
+
+    GroupReadFormat groupRead;
+    ssize_t expectedSize = static_cast<ssize_t>((3 + m_OpenedCount) * sizeof(uint64_t));
+    if (read(m_LeaderFd, &groupRead, sizeof(groupRead)) != expectedSize || groupRead.counterCount != m_OpenedCount)
+    {
+        return false;
+    }
+
+    // The group was only on the PMU for timeRunning of timeEnabled if the kernel multiplexed it
+    double scale = (groupRead.timeRunning == 0) ? 0.0 : static_cast<double>(groupRead.timeEnabled) / static_cast<double>(groupRead.timeRunning);
+
+    values = PerfCounterValues {};
+    values.availableMask = m_AvailableMask;
+    for (uint32_t counter = 0; counter < PERF_COUNTER_COUNT; counter++)
+    {
+        if (m_Fds[counter] >= 0)
+        {
+            values.counts[counter] = static_cast<uint64_t>(static_cast<double>(groupRead.values[m_ReadIndices[counter]]) * scale);
+        }
+    }
+    return true;
+}
+
+const char* PerfCounterGroup::CounterName(PerfCounter counter)
+{
+    switch (counter)
+    {
+    case PerfCounter::Cycles:
+        return "cycles";
+    case PerfCounter::Instructions:
+        return "instructions";
+    case PerfCounter::LlcMisses:
+        return "llcMisses";
+    case PerfCounter::DtlbMisses:
+        return "dtlbMisses";
+    case PerfCounter::BackendStallCycles:
+        return "backendStallCycles";
+    case PerfCounter::TaskClock:
+        return "taskClockNs";
+    default:
+        return "unknown";
+    }
+}
+
+PerfCounterValues PerfCounterGroup::Difference(const PerfCounterValues& end, const PerfCounterValues& start)
+{
+    PerfCounterValues difference;
+    difference.availableMask = end.availableMask;
+    for (uint32_t counter = 0; counter < PERF_COUNTER_COUNT; counter++)
+    {
+        // Scaled counts of a multiplexed group can step back slightly
+        difference.counts[counter] = (end.counts[counter] > start.counts[counter]) ? end.counts[counter] - start.counts[counter] : 0;
+    }
+    return difference;
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string>
+
+// Hardware events counted per thread. TaskClock is a software event: nanoseconds the thread was
+// on a CPU, which tells preemption apart from slow memory.
+enum class PerfCounter : uint32_t
+{
+    Cycles,
+    Instructions,
+    LlcMisses,
+    DtlbMisses,
+    BackendStallCycles,
+    TaskClock,
+    Count
+};
+
+constexpr uint32_t PERF_COUNTER_COUNT = static_cast<uint32_t>(PerfCounter::Count);
+
+struct PerfCounterValues
+{
+    std::array<uint64_t, PERF_COUNTER_COUNT> counts {};
+
+    // Bit per PerfCounter that was counted; the others are 0
+    uint32_t availableMask { 0 };
+
+    uint64_t Get(PerfCounter counter) const
+    {
+        return counts[static_cast<uint32_t>(counter)];
+    }
+
+    bool Has(PerfCounter counter) const
+    {
+        return (availableMask & (1u << static_cast<uint32_t>(counter))) != 0;
+    }
+
+    PerfCounterValues& operator+=(const PerfCounterValues& other)
+    {
+        for (uint32_t counter = 0; counter < PERF_COUNTER_COUNT; counter++)
+        {
+            counts[counter] += other.counts[counter];
+        }
+        availableMask |= other.availableMask;
+        return *this;
+    }
+};
+
+// Group of perf_event_open counters on the calling thread, scheduled on the PMU together so that
+// all of them cover the same instructions. Each counter the kernel or the CPU does not support is
+// left out, and if none can be opened (no PMU, e.g. in a VM, or perf_event_paranoid too high) the
+// group is unavailable and reads return false. Counts are scaled up if the kernel had to
+// multiplex the group with other users of the PMU.
+//
+// Counts only user space code of the thread that created the group, so it must be created on the
+// thread to be measured. Reading takes one read() syscall.
+class PerfCounterGroup
+{
+public:
+    PerfCounterGroup();
+    ~PerfCounterGroup();
+
+    PerfCounterGroup(const PerfCounterGroup&) = delete;
+    PerfCounterGroup& operator=(const PerfCounterGroup&) = delete;
+
+    bool IsAvailable() const;
+    bool IsCounterAvailable(PerfCounter counter) const;
+    uint32_t GetAvailableMask() const;
+
+    // Why the group or some counter could not be opened, empty if every counter was
+    const std::string& GetError() const;
+
+    // Counts since the group was created. Only differences of two reads are meaningful.
+    bool Read(PerfCounterValues& values) const;
+
+    static const char* CounterName(PerfCounter counter);
+
+    // Differences of two reads, with the availability of the later one
+    static PerfCounterValues Difference(const PerfCounterValues& end, const PerfCounterValues& start);
+
+private:
+    int m_LeaderFd { -1 };
+
+    // Descriptor of each counter, -1 if not available
+    std::array<int, PERF_COUNTER_COUNT> m_Fds;
+
+    // Position of each available counter in the group read, in the order they were opened
+    std::array<uint32_t, PERF_COUNTER_COUNT> m_ReadIndices {};
+    uint32_t m_OpenedCount { 0 };
+    uint32_t m_AvailableMask { 0 };
+    std::string m_Error;
+};
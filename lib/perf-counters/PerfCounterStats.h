@@ -0,0 +1,93 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <sstream>
+#include <string>
+#include <utility>
+
+#include "PerfCounterGroup.h"
+
+// Hardware counter totals of requests, kept per matrix shape: the shape decides whether a
+// transpose is bound by memory bandwidth, TLB reach or cache set conflicts. A new shape
+// allocates its entry; after that recording does not allocate.
+class PerfCounterStats
+{
+public:
+    struct ShapeTotals
+    {
+        uint64_t requests { 0 };
+        uint64_t bytes { 0 };
+        PerfCounterValues values;
+    };
+
+    using Shape = std::pair<uint32_t, uint32_t>;
+
+    void Record(uint32_t rowCount, uint32_t columnCount, uint64_t bytes, const PerfCounterValues& values)
+    {
+        ShapeTotals& totals = m_Shapes[Shape(rowCount, columnCount)];
+        totals.requests++;
+        totals.bytes += bytes;
+        totals.values += values;
+    }
+
+    void Merge(const PerfCounterStats& other)
+    {
+        for (const auto& [shape, otherTotals] : other.m_Shapes)
+        {
+            ShapeTotals& totals = m_Shapes[shape];
+            totals.requests += otherTotals.requests;
+            totals.bytes += otherTotals.bytes;
+            totals.values += otherTotals.values;
+        }
+    }
+
+    bool Empty() const
+    {
+        return m_Shapes.empty();
+    }
+
+    const std::map<Shape, ShapeTotals>& GetShapes() const
+    {
+        return m_Shapes;
+    }
+
+    // Counts normalized per request, per instruction or per KB moved, leaving out counters that
+    // were not available
+    static std::string GetShapeSummary(const Shape& shape, const ShapeTotals& totals)
+    {
+        const PerfCounterValues& values = totals.values;
+        double kilobytes = totals.bytes / 1024.0;
+
+        std::ostringstream oss;
+        oss << "shape: " << shape.first << "x" << shape.second << ", reqs: " << totals.requests;
+        if (values.Has(PerfCounter::Cycles) && values.Has(PerfCounter::Instructions) && values.Get(PerfCounter::Cycles) != 0)
+        {
+            oss << ", IPC: " << static_cast<double>(values.Get(PerfCounter::Instructions)) / values.Get(PerfCounter::Cycles);
+        }
+        if (values.Has(PerfCounter::Cycles) && kilobytes != 0.0)
+        {
+            oss << ", cycles/KB: " << values.Get(PerfCounter::Cycles) / kilobytes;
+        }
+        if (values.Has(PerfCounter::LlcMisses) && kilobytes != 0.0)
+        {
+            oss << ", llcMisses/KB: " << values.Get(PerfCounter::LlcMisses) / kilobytes;
+        }
+        if (values.Has(PerfCounter::DtlbMisses) && kilobytes != 0.0)
+        {
+            oss << ", dtlbMisses/KB: " << values.Get(PerfCounter::DtlbMisses) / kilobytes;
+        }
+        if (values.Has(PerfCounter::Cycles) && values.Has(PerfCounter::BackendStallCycles) && values.Get(PerfCounter::Cycles) != 0)
+        {
+            oss << ", backendStalls: " << 100.0 * values.Get(PerfCounter::BackendStallCycles) / values.Get(PerfCounter::Cycles) << "%";
+        }
+        if (values.Has(PerfCounter::TaskClock) && totals.requests != 0)
+        {
+            oss << ", onCpuTime: " << values.Get(PerfCounter::TaskClock) / totals.requests << " (ns/req)";
+        }
+        return oss.str();
+    }
+
+private:
+    std::map<Shape, ShapeTotals> m_Shapes;
+};
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+// Value with a sequence number for one writer and any number of readers, which may be in other
+// processes and may have mapped the memory read-only. The writer never waits for readers; a
+// reader that overlaps a write sees the sequence change and copies the value again. Zeroed memory
+// is a valid initial state holding a zeroed value.
+//
+// The sequence is odd while a write is in progress. The release fence after making it odd keeps
+// the value stores after it, and the acquire fence after the reader's copy keeps the copy before
+// the second sequence load, so equal even sequences before and after the copy mean no write
+// overlapped it.
+template <typename T>
+class Seqlock
+{
+    static_assert(std::is_trivially_copyable_v<T>, "Seqlock values are copied byte by byte, so T must be trivially copyable");
+
+public:
+    // Writer side
+    void Store(const T& value)
+    {
+        uint64_t sequence = m_Sequence.load(std::memory_order_relaxed);
+        m_Sequence.store(sequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        std::memcpy(&m_Value, &value, sizeof(T));
+
+        m_Sequence.store(sequence + 2, std::memory_order_release);
+    }
+
+    // Writer side: the value last stored, which only the writer may read without the sequence
+    const T& GetStored() const
+    {
+        return m_Value;
+    }
+
+    // Copies a value that no write overlapped. Returns false if a write got in the way.
+    bool TryLoad(T& value) const
+    {
+        uint64_t sequenceBefore = m_Sequence.load(std::memory_order_acquire);
+        if (sequenceBefore % 2 != 0)
+        {
+            return false;
+        }
+
+        std::memcpy(&value, &m_Value, sizeof(T));
+        std::atomic_thread_fence(std::memory_order_acquire);
+
+        return m_Sequence.load(std::memory_order_relaxed) == sequenceBefore;
+    }
+
+    // Retries until a copy is not overlapped by a write. Writes are short, so this does not wait long.
+    T Load() const
+    {
+        T value;
+        while (!TryLoad(value))
+        {
+        }
+        return value;
+    }
+
+    // Number of completed writes
+    uint64_t GetVersion() const
+    {
+        return m_Sequence.load(std::memory_order_acquire) / 2;
+    }
+
+private:
+    std::atomic<uint64_t> m_Sequence { 0 };
+    T m_Value {};
+};
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "Seqlock needs lock-free 64-bit atomics in shared memory");
@@ -1,9 +1,10 @@
 #include <cstdint>
-#include <iostream>
 #include <sstream>
+#include <sys/stat.h>
 #include <sys/types.h>
 #include <unistd.h>
 
+#include "Logger.h"
 #include "SharedMemory.h"
 
 using std::ostringstream;
@@ -23,7 +24,7 @@ SharedMemory::SharedMemory(size_t sizeInBytes, const std::string name, Ownership
         {
             ostringstream oss;
             oss << "Failed to create shared memory object for " << name << ". errno(" << errno << "): " << strerror(errno);
-            std::cerr << oss.str() << std::endl;
+            LOG_ERROR("{}", oss.str());
             throw std::runtime_error(oss.str());
         }
 
@@ -34,7 +35,7 @@ SharedMemory::SharedMemory(size_t sizeInBytes, const std::string name, Ownership
             
             ostringstream oss;
             oss << "Failed to set shared memory size (" << m_SizeInBytes << " bytes) for " << name << ". errno(" << errno << "): " << strerror(errno);
-            std::cerr << oss.str() << std::endl;
+            LOG_ERROR("{}", oss.str());
             throw std::runtime_error(oss.str());
         }
     }
@@ -46,20 +47,49 @@ SharedMemory::SharedMemory(size_t sizeInBytes, const std::string name, Ownership
         {
             ostringstream oss;
             oss << "Failed to create shared memory object for " << name << ". errno(" << errno << "): " << strerror(errno);
-            std::cerr << oss.str() << std::endl;
+            LOG_ERROR("{}", oss.str());
             throw std::runtime_error(oss.str());
         }
     }
 
-    m_RawPointer = mmap(0, m_SizeInBytes, PROT_READ | PROT_WRITE, MAP_SHARED, m_FileDescriptor, 0);
+    else if (m_Ownership == Ownership::Observer)
+    {
+        m_FileDescriptor = shm_open(m_ShmObjectName.c_str(), O_RDONLY, 0);
+
+        if (m_FileDescriptor < 0)
+        {
+            ostringstream oss;
+            oss << "Failed to open shared memory object for " << name << ". errno(" << errno << "): " << strerror(errno);
+            LOG_ERROR("{}", oss.str());
+            throw std::runtime_error(oss.str());
+        }
+
+        // Pages past the end of the object would fault on access
+        struct stat objectStat;
+        if (fstat(m_FileDescriptor, &objectStat) < 0 || static_cast<size_t>(objectStat.st_size) < m_SizeInBytes)
+        {
+            close(m_FileDescriptor);
+
+            ostringstream oss;
+            oss << "Shared memory object " << name << " is smaller than " << m_SizeInBytes << " bytes";
+            LOG_ERROR("{}", oss.str());
+            throw std::runtime_error(oss.str());
+        }
+    }
+
+    int protection = (m_Ownership == Ownership::Observer) ? PROT_READ : (PROT_READ | PROT_WRITE);
+    m_RawPointer = mmap(0, m_SizeInBytes, protection, MAP_SHARED, m_FileDescriptor, 0);
     if (m_RawPointer == MAP_FAILED || m_RawPointer == nullptr)
     {
         close(m_FileDescriptor);
-        shm_unlink(m_ShmObjectName.c_str());
+        if (m_Ownership != Ownership::Observer)
+        {
+            shm_unlink(m_ShmObjectName.c_str());
+        }
         
         ostringstream oss;
         oss << "Failed to map shared memory for " << name << ". errno (" << errno << "): " << strerror(errno);
-        std::cerr << oss.str() << std::endl;
+        LOG_ERROR("{}", oss.str());
         throw std::runtime_error(oss.str());
     }
 
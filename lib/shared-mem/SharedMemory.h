@@ -14,7 +14,9 @@ public:
     enum class Ownership
     {
         Owner,
-        Borrower
+        Borrower,
+        // Maps an existing object read-only, e.g. to monitor it from another process
+        Observer
     };
 
     enum class BufferInitMode
@@ -1,15 +1,31 @@
 #pragma once
 
+#include <algorithm>
 #include <atomic>
+#include <chrono>
 #include <cstdint>
+#include <sstream>
+#include <stdexcept>
 #include <string>
 #include <memory>
+#include <type_traits>
 
+#include "MemoryUtils.h"
 #include "SharedMemory.h"
+#include "EventCount.h"
 #include "FutexSignaller.h"
 
+// Items are copied into and out of shared memory, so T must be trivially copyable.
+//
+// Each side keeps a private copy of the other side's index and only reloads the shared one when
+// the copy says the queue is full (producer) or empty (consumer). As long as the queue is neither,
+// an operation touches only its own index and the slots, and no cache line moves between cores
+// for the remote index. The bulk operations publish a whole batch with a single release store.
+template <typename T>
 class SpscQueueRingBuffer
 {
+    static_assert(std::is_trivially_copyable_v<T>, "Queue items must be trivially copyable");
+
 public:
     enum class Role
     {
@@ -20,19 +36,43 @@ public:
     SpscQueueRingBuffer(uint32_t ownerPid, Role role, size_t capacity, const std::string& nameSuffix);
     ~SpscQueueRingBuffer();
 
-    const std::string& GetName() const;
     size_t GetRealCapacity() const;
-    bool Enqueue(uint32_t item);
-    bool Dequeue(uint32_t& item);
+    bool Enqueue(const T& item);
+    bool Dequeue(T& item);
+
+    // Blocking versions: retry for a while, then sleep until the other side makes progress.
+    // Return false if the timeout expires first. Only the blocking versions wake a sleeping peer,
+    // so the non-blocking ones stay free of the eventcount's fence; a side that sleeps should be
+    // paired with a peer that also uses the blocking versions, or it only wakes at its timeout.
+    bool Enqueue(const T& item, std::chrono::nanoseconds timeout);
+    bool Dequeue(T& item, std::chrono::nanoseconds timeout);
+
+    // Enqueues as many of the count items as fit and returns how many that was
+    size_t EnqueueBulk(const T* pItems, size_t count);
+
+    // Dequeues up to maxCount items and returns how many were dequeued
+    size_t DequeueBulk(T* pItems, size_t maxCount);
+
+    // Blocking bulk versions: wait until at least one item fits or is ready, then move as many as
+    // possible. Return 0 if the timeout expires first.
+    size_t EnqueueBulk(const T* pItems, size_t count, std::chrono::nanoseconds timeout);
+    size_t DequeueBulk(T* pItems, size_t maxCount, std::chrono::nanoseconds timeout);
 
 private:
     struct QueueData
     {
         alignas(64) std::atomic<size_t> head;
         alignas(64) std::atomic<size_t> tail;
-        alignas(64) uint32_t buffer[];
+
+        // Slept on by a blocked consumer and by a blocked producer, respectively
+        alignas(64) EventCount notEmpty;
+        alignas(64) EventCount notFull;
+        alignas(64) T buffer[];
     };
 
+    // Attempts before a blocking operation starts sleeping
+    static constexpr uint32_t BLOCKING_SPIN_COUNT = 1024;
+
     size_t CalculateBufferSize();
     static std::string CreateShmObjectName(uint32_t ownerPid, const std::string& nameSuffix);
 
@@ -43,5 +83,219 @@ private:
 
     QueueData* mp_QueueData;
 
+    // Last seen tail, only used by the producer, and last seen head, only used by the consumer.
+    // On separate cache lines since one object may be used from two threads.
+    alignas(64) size_t m_CachedTail { 0 };
+    alignas(64) size_t m_CachedHead { 0 };
+
     std::unique_ptr<SharedMemory> mp_SharedMemory;
 };
+
+template <typename T>
+SpscQueueRingBuffer<T>::SpscQueueRingBuffer(uint32_t ownerPid, Role role, size_t capacity, const std::string& nameSuffix) :
+    m_OwnerPid(ownerPid),
+    m_Role(role),
+    m_Capacity(capacity),
+    m_CapacityMinusOne(capacity - 1)
+{
+    if (false == std::atomic<size_t>::is_always_lock_free)
+    {
+        throw std::runtime_error("Atomic size_t is not always lock-free. Cannot create queue.");
+    }
+
+    if (m_Capacity < 2)
+    {
+        throw std::invalid_argument("Capacity must be at least 2");
+    }
+
+    if ((capacity & (capacity - 1)) != 0)
+    {
+        throw std::invalid_argument("Capacity must be a power of 2");
+    }
+
+    SharedMemory::Ownership bufferOwnership = (role == Role::Producer) ? SharedMemory::Ownership::Owner : SharedMemory::Ownership::Borrower;
+    SharedMemory::BufferInitMode bufferInitMode = (role == Role::Producer) ? SharedMemory::BufferInitMode::Zero : SharedMemory::BufferInitMode::NoInit;
+    std::string bufferShmObjectName = CreateShmObjectName(m_OwnerPid, nameSuffix);
+    size_t bufferSizeInBytes = CalculateBufferSize();
+    mp_SharedMemory = std::make_unique<SharedMemory>(bufferSizeInBytes, bufferShmObjectName, bufferOwnership, bufferInitMode);
+    mp_QueueData = reinterpret_cast<QueueData*>(mp_SharedMemory->GetRawPointer());
+
+    if (role == Role::Producer)
+    {
+        new (&mp_QueueData->head) std::atomic<size_t>(0);
+        new (&mp_QueueData->tail) std::atomic<size_t>(0);
+    }
+}
+
+template <typename T>
+SpscQueueRingBuffer<T>::~SpscQueueRingBuffer()
+{
+}
+
+template <typename T>
+bool SpscQueueRingBuffer<T>::Enqueue(const T& item)
+{
+    size_t head = mp_QueueData->head.load(std::memory_order_relaxed);
+    size_t nextHead = (head + 1) & m_CapacityMinusOne;
+
+    if (nextHead == m_CachedTail)
+    {
+        m_CachedTail = mp_QueueData->tail.load(std::memory_order_acquire);
+        if (nextHead == m_CachedTail)
+        {
+            return false;
+        }
+    }
+
+    mp_QueueData->buffer[head] = item;
+    mp_QueueData->head.store(nextHead, std::memory_order_release);
+    return true;
+}
+
+template <typename T>
+bool SpscQueueRingBuffer<T>::Dequeue(T& item)
+{
+    size_t tail = mp_QueueData->tail.load(std::memory_order_relaxed);
+
+    if (tail == m_CachedHead)
+    {
+        m_CachedHead = mp_QueueData->head.load(std::memory_order_acquire);
+        if (tail == m_CachedHead)
+        {
+            return false;
+        }
+    }
+
+    item = mp_QueueData->buffer[tail];
+    mp_QueueData->tail.store((tail + 1) & m_CapacityMinusOne, std::memory_order_release);
+    return true;
+}
+
+template <typename T>
+size_t SpscQueueRingBuffer<T>::EnqueueBulk(const T* pItems, size_t count)
+{
+    size_t head = mp_QueueData->head.load(std::memory_order_relaxed);
+
+    size_t freeSlots = (m_CachedTail - head - 1) & m_CapacityMinusOne;
+    if (freeSlots < count)
+    {
+        m_CachedTail = mp_QueueData->tail.load(std::memory_order_acquire);
+        freeSlots = (m_CachedTail - head - 1) & m_CapacityMinusOne;
+    }
+
+    count = std::min(count, freeSlots);
+    if (count == 0)
+    {
+        return 0;
+    }
+
+    // Up to the end of the buffer, then the rest from the start
+    size_t firstPart = std::min(count, m_Capacity - head);
+    std::copy(pItems, pItems + firstPart, &mp_QueueData->buffer[head]);
+    std::copy(pItems + firstPart, pItems + count, &mp_QueueData->buffer[0]);
+
+    mp_QueueData->head.store((head + count) & m_CapacityMinusOne, std::memory_order_release);
+    return count;
+}
+
+template <typename T>
+size_t SpscQueueRingBuffer<T>::DequeueBulk(T* pItems, size_t maxCount)
+{
+    size_t tail = mp_QueueData->tail.load(std::memory_order_relaxed);
+
+    size_t readySlots = (m_CachedHead - tail) & m_CapacityMinusOne;
+    if (readySlots < maxCount)
+    {
+        m_CachedHead = mp_QueueData->head.load(std::memory_order_acquire);
+        readySlots = (m_CachedHead - tail) & m_CapacityMinusOne;
+    }
+
+    size_t count = std::min(maxCount, readySlots);
+    if (count == 0)
+    {
+        return 0;
+    }
+
+    size_t firstPart = std::min(count, m_Capacity - tail);
+    std::copy(&mp_QueueData->buffer[tail], &mp_QueueData->buffer[tail] + firstPart, pItems);
+    std::copy(&mp_QueueData->buffer[0], &mp_QueueData->buffer[0] + (count - firstPart), pItems + firstPart);
+
+    mp_QueueData->tail.store((tail + count) & m_CapacityMinusOne, std::memory_order_release);
+    return count;
+}
+
+template <typename T>
+bool SpscQueueRingBuffer<T>::Enqueue(const T& item, std::chrono::nanoseconds timeout)
+{
+    if (!mp_QueueData->notFull.Await([&]() { return Enqueue(item); }, timeout, BLOCKING_SPIN_COUNT))
+    {
+        return false;
+    }
+
+    mp_QueueData->notEmpty.Notify();
+    return true;
+}
+
+template <typename T>
+bool SpscQueueRingBuffer<T>::Dequeue(T& item, std::chrono::nanoseconds timeout)
+{
+    if (!mp_QueueData->notEmpty.Await([&]() { return Dequeue(item); }, timeout, BLOCKING_SPIN_COUNT))
+    {
+        return false;
+    }
+
+    mp_QueueData->notFull.Notify();
+    return true;
+}
+
+template <typename T>
+size_t SpscQueueRingBuffer<T>::EnqueueBulk(const T* pItems, size_t count, std::chrono::nanoseconds timeout)
+{
+    size_t enqueued = 0;
+    if (!mp_QueueData->notFull.Await([&]() { return (enqueued = EnqueueBulk(pItems, count)) != 0; }, timeout, BLOCKING_SPIN_COUNT))
+    {
+        return 0;
+    }
+
+    mp_QueueData->notEmpty.Notify();
+    return enqueued;
+}
+
+template <typename T>
+size_t SpscQueueRingBuffer<T>::DequeueBulk(T* pItems, size_t maxCount, std::chrono::nanoseconds timeout)
+{
+    size_t dequeued = 0;
+    if (!mp_QueueData->notEmpty.Await([&]() { return (dequeued = DequeueBulk(pItems, maxCount)) != 0; }, timeout, BLOCKING_SPIN_COUNT))
+    {
+        return 0;
+    }
+
+    mp_QueueData->notFull.Notify();
+    return dequeued;
+}
+
+template <typename T>
+size_t SpscQueueRingBuffer<T>::GetRealCapacity() const
+{
+    return m_CapacityMinusOne;
+}
+
+template <typename T>
+std::string SpscQueueRingBuffer<T>::CreateShmObjectName(uint32_t ownerPid, const std::string& nameSuffix)
+{
+    std::ostringstream oss;
+    oss << "spsc_queue_buffer_uid{" << ownerPid << "}" << nameSuffix;
+    return oss.str();
+}
+
+template <typename T>
+size_t SpscQueueRingBuffer<T>::CalculateBufferSize()
+{
+    size_t cacheLineSize = MemoryUtils::GetCacheLineSize();
+    if (cacheLineSize == 0)
+    {
+        cacheLineSize = 64; // At least one full cache line of size 64 bytes
+    }
+
+    return (((sizeof(QueueData) + m_Capacity * sizeof(T))/cacheLineSize) + 1)* cacheLineSize;
+}
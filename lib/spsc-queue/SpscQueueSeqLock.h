@@ -1,15 +1,25 @@
 #pragma once
 
 #include <atomic>
+#include <chrono>
 #include <cstdint>
+#include <sstream>
+#include <stdexcept>
 #include <string>
 #include <memory>
+#include <type_traits>
 
+#include "MemoryUtils.h"
 #include "SharedMemory.h"
+#include "EventCount.h"
 #include "FutexSignaller.h"
 
+// Items are copied into and out of shared memory, so T must be trivially copyable
+template <typename T>
 class SpscQueueSeqLock
 {
+    static_assert(std::is_trivially_copyable_v<T>, "Queue items must be trivially copyable");
+
 public:
     enum class Role
     {
@@ -20,20 +30,34 @@ public:
     SpscQueueSeqLock(uint32_t ownerPid, Role role, size_t capacity, const std::string& nameSuffix);
     ~SpscQueueSeqLock();
 
-    const std::string& GetName() const;
     size_t GetRealCapacity() const;
-    bool Enqueue(uint32_t item);
-    bool Dequeue(uint32_t& item);
+    bool Enqueue(const T& item);
+    bool Dequeue(T& item);
+
+    // Blocking versions: retry for a while, then sleep until the other side makes progress.
+    // Return false if the timeout expires first. Only the blocking versions wake a sleeping peer,
+    // so a side that sleeps should be paired with a peer that also uses them.
+    bool Enqueue(const T& item, std::chrono::nanoseconds timeout);
+    bool Dequeue(T& item, std::chrono::nanoseconds timeout);
 
 private:
+    // head and tail are atomics because the queue is inlined into both endpoints; with plain
+    // loads the compiler may hoist them out of a polling loop
     struct QueueData
     {
-        alignas(64) size_t head;
-        alignas(64) size_t tail;
+        alignas(64) std::atomic<size_t> head;
+        alignas(64) std::atomic<size_t> tail;
         alignas(64) std::atomic<size_t> seq;
-        alignas(64) uint32_t buffer[];
+
+        // Slept on by a blocked consumer and by a blocked producer, respectively
+        alignas(64) EventCount notEmpty;
+        alignas(64) EventCount notFull;
+        alignas(64) T buffer[];
     };
 
+    // Attempts before a blocking operation starts sleeping
+    static constexpr uint32_t BLOCKING_SPIN_COUNT = 1024;
+
     size_t CalculateBufferSize();
     static std::string CreateShmObjectName(uint32_t ownerPid, const std::string& nameSuffix);
 
@@ -46,3 +70,145 @@ private:
 
     std::unique_ptr<SharedMemory> mp_SharedMemory;
 };
+
+template <typename T>
+SpscQueueSeqLock<T>::SpscQueueSeqLock(uint32_t ownerPid, Role role, size_t capacity, const std::string& nameSuffix) : 
+    m_OwnerPid(ownerPid),
+    m_Role(role),
+    m_Capacity(capacity),
+    m_CapacityMinusOne(capacity - 1)
+{
+    if (false == std::atomic<size_t>::is_always_lock_free)
+    {
+        throw std::runtime_error("Atomic size_t is not always lock-free. Cannot create queue.");
+    }
+
+    if (m_Capacity < 2)
+    {
+        throw std::invalid_argument("Capacity must be at least 2");
+    }
+
+    if ((capacity & (capacity - 1)) != 0)
+    {
+        throw std::invalid_argument("Capacity must be a power of 2");
+    }
+
+    SharedMemory::Ownership bufferOwnership = (role == Role::Producer) ? SharedMemory::Ownership::Owner : SharedMemory::Ownership::Borrower;
+    SharedMemory::BufferInitMode bufferInitMode = (role == Role::Producer) ? SharedMemory::BufferInitMode::Zero : SharedMemory::BufferInitMode::NoInit;    
+    std::string bufferShmObjectName = CreateShmObjectName(m_OwnerPid, nameSuffix);
+    size_t bufferSizeInBytes = CalculateBufferSize();
+    mp_SharedMemory = std::make_unique<SharedMemory>(bufferSizeInBytes, bufferShmObjectName, bufferOwnership, bufferInitMode);
+    mp_QueueData = reinterpret_cast<QueueData*>(mp_SharedMemory->GetRawPointer());
+
+    if (role == Role::Producer)
+    {
+        new (&mp_QueueData->head) std::atomic<size_t>(0);
+        new (&mp_QueueData->tail) std::atomic<size_t>(0);
+    }
+}
+
+template <typename T>
+SpscQueueSeqLock<T>::~SpscQueueSeqLock()
+{
+}
+
+template <typename T>
+bool SpscQueueSeqLock<T>::Enqueue(const T& item)
+{
+    size_t head = mp_QueueData->head.load(std::memory_order_relaxed);
+    size_t nextHead = (head + 1) & m_CapacityMinusOne;
+
+    if (nextHead == mp_QueueData->tail.load(std::memory_order_acquire)) {
+        return false;
+    }
+
+    mp_QueueData->seq.fetch_add(1, std::memory_order_acq_rel);
+
+    mp_QueueData->buffer[head] = item;
+    mp_QueueData->head.store(nextHead, std::memory_order_release);
+
+    mp_QueueData->seq.fetch_add(1, std::memory_order_acq_rel);
+
+    return true;
+}
+
+template <typename T>
+bool SpscQueueSeqLock<T>::Dequeue(T& item)
+{
+    size_t head = mp_QueueData->head.load(std::memory_order_acquire);
+    size_t tail = mp_QueueData->tail.load(std::memory_order_relaxed);
+
+    if (tail == head)
+    {
+        return false;
+    }
+
+    size_t seqStart = mp_QueueData->seq.load(std::memory_order_acquire);
+    if (seqStart % 2 != 0)
+    {
+        return false;
+    }
+
+    item = mp_QueueData->buffer[tail];
+    size_t nextTail = (tail + 1) & m_CapacityMinusOne;
+
+    size_t seqEnd = mp_QueueData->seq.load(std::memory_order_acquire);
+
+    if (seqStart == seqEnd)
+    {
+        mp_QueueData->tail.store(nextTail, std::memory_order_release);
+        return true;
+    }
+
+    return false;
+}
+
+template <typename T>
+bool SpscQueueSeqLock<T>::Enqueue(const T& item, std::chrono::nanoseconds timeout)
+{
+    if (!mp_QueueData->notFull.Await([&]() { return Enqueue(item); }, timeout, BLOCKING_SPIN_COUNT))
+    {
+        return false;
+    }
+
+    mp_QueueData->notEmpty.Notify();
+    return true;
+}
+
+template <typename T>
+bool SpscQueueSeqLock<T>::Dequeue(T& item, std::chrono::nanoseconds timeout)
+{
+    if (!mp_QueueData->notEmpty.Await([&]() { return Dequeue(item); }, timeout, BLOCKING_SPIN_COUNT))
+    {
+        return false;
+    }
+
+    mp_QueueData->notFull.Notify();
+    return true;
+}
+
+template <typename T>
+size_t SpscQueueSeqLock<T>::GetRealCapacity() const
+{
+    return m_CapacityMinusOne;
+}
+
+template <typename T>
+std::string SpscQueueSeqLock<T>::CreateShmObjectName(uint32_t ownerPid, const std::string& nameSuffix)
+{
+    std::ostringstream oss;
+    oss << "spsc_queue_buffer_uid{" << ownerPid << "}" << nameSuffix;
+    return oss.str();
+}
+
+template <typename T>
+size_t SpscQueueSeqLock<T>::CalculateBufferSize()
+{
+    size_t cacheLineSize = MemoryUtils::GetCacheLineSize();
+    if (cacheLineSize == 0)
+    {
+        cacheLineSize = 64; // At least one full cache line of size 64 bytes
+    }
+
+    return (((sizeof(QueueData) + m_Capacity * sizeof(T))/cacheLineSize) + 1)* cacheLineSize;
+}
@@ -0,0 +1,176 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <new>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <memory>
+#include <type_traits>
+
+#include "SharedMemory.h"
+
+// SPSC queue in shared memory whose slots carry a sequence number next to the item. It uses the
+// same shared memory naming and construction as SpscQueueRingBuffer, but has no shared head or tail.
+//
+// Slot (position % capacity) is free for the producer when its sequence equals position. The
+// producer writes the item and publishes it by storing position + 1. The consumer takes the item
+// once it sees position + 1, then hands the slot to the next lap by storing position + capacity.
+// Each side keeps its own position privately, so the consumer recognizes a ready slot without
+// reading the producer's index, and the slots are the only cache lines the two sides share. All
+// capacity slots are usable.
+//
+// Items are copied into and out of shared memory, so T must be trivially copyable.
+template <typename T>
+class SpscQueueSequenced
+{
+    static_assert(std::is_trivially_copyable_v<T>, "Queue items must be trivially copyable");
+
+public:
+    enum class Role
+    {
+        Producer,
+        Consumer
+    };
+
+    SpscQueueSequenced(uint32_t ownerPid, Role role, size_t capacity, const std::string& nameSuffix);
+    ~SpscQueueSequenced();
+
+    size_t GetRealCapacity() const;
+    bool Enqueue(const T& item);
+    bool Dequeue(T& item);
+
+    // Consumer side: number of items ready to be dequeued. Items the producer publishes while the
+    // slots are counted may or may not be included.
+    size_t GetReadyCount() const;
+
+private:
+    struct alignas(64) Slot
+    {
+        std::atomic<uint64_t> sequence;
+        T item;
+    };
+
+    static std::string CreateShmObjectName(uint32_t ownerPid, const std::string& nameSuffix);
+
+    uint32_t m_OwnerPid;
+    Role m_Role;
+    size_t m_Capacity;
+    size_t m_CapacityMinusOne;
+
+    Slot* mp_Slots;
+
+    // Only used by the producer and only used by the consumer, respectively
+    alignas(64) uint64_t m_ProducerPosition { 0 };
+    alignas(64) uint64_t m_ConsumerPosition { 0 };
+
+    std::unique_ptr<SharedMemory> mp_SharedMemory;
+};
+
+template <typename T>
+SpscQueueSequenced<T>::SpscQueueSequenced(uint32_t ownerPid, Role role, size_t capacity, const std::string& nameSuffix) :
+    m_OwnerPid(ownerPid),
+    m_Role(role),
+    m_Capacity(capacity),
+    m_CapacityMinusOne(capacity - 1)
+{
+    if (false == std::atomic<uint64_t>::is_always_lock_free)
+    {
+        throw std::runtime_error("Atomic uint64_t is not always lock-free. Cannot create queue.");
+    }
+
+    if (m_Capacity < 2)
+    {
+        throw std::invalid_argument("Capacity must be at least 2");
+    }
+
+    if ((capacity & (capacity - 1)) != 0)
+    {
+        throw std::invalid_argument("Capacity must be a power of 2");
+    }
+
+    SharedMemory::Ownership bufferOwnership = (role == Role::Producer) ? SharedMemory::Ownership::Owner : SharedMemory::Ownership::Borrower;
+    SharedMemory::BufferInitMode bufferInitMode = (role == Role::Producer) ? SharedMemory::BufferInitMode::Zero : SharedMemory::BufferInitMode::NoInit;
+    std::string bufferShmObjectName = CreateShmObjectName(m_OwnerPid, nameSuffix);
+    size_t bufferSizeInBytes = m_Capacity * sizeof(Slot);
+    mp_SharedMemory = std::make_unique<SharedMemory>(bufferSizeInBytes, bufferShmObjectName, bufferOwnership, bufferInitMode);
+    mp_Slots = reinterpret_cast<Slot*>(mp_SharedMemory->GetRawPointer());
+
+    // Every slot starts free for the first lap
+    if (role == Role::Producer)
+    {
+        for (size_t slotIndex = 0; slotIndex < m_Capacity; slotIndex++)
+        {
+            new (&mp_Slots[slotIndex].sequence) std::atomic<uint64_t>(slotIndex);
+        }
+    }
+}
+
+template <typename T>
+SpscQueueSequenced<T>::~SpscQueueSequenced()
+{
+}
+
+template <typename T>
+bool SpscQueueSequenced<T>::Enqueue(const T& item)
+{
+    Slot& slot = mp_Slots[m_ProducerPosition & m_CapacityMinusOne];
+
+    // Still holds the item of the previous lap
+    if (slot.sequence.load(std::memory_order_acquire) != m_ProducerPosition)
+    {
+        return false;
+    }
+
+    slot.item = item;
+    slot.sequence.store(m_ProducerPosition + 1, std::memory_order_release);
+    m_ProducerPosition++;
+    return true;
+}
+
+template <typename T>
+bool SpscQueueSequenced<T>::Dequeue(T& item)
+{
+    Slot& slot = mp_Slots[m_ConsumerPosition & m_CapacityMinusOne];
+
+    if (slot.sequence.load(std::memory_order_acquire) != m_ConsumerPosition + 1)
+    {
+        return false;
+    }
+
+    item = slot.item;
+    slot.sequence.store(m_ConsumerPosition + m_Capacity, std::memory_order_release);
+    m_ConsumerPosition++;
+    return true;
+}
+
+template <typename T>
+size_t SpscQueueSequenced<T>::GetReadyCount() const
+{
+    size_t readyCount = 0;
+    while (readyCount < m_Capacity)
+    {
+        uint64_t position = m_ConsumerPosition + readyCount;
+        if (mp_Slots[position & m_CapacityMinusOne].sequence.load(std::memory_order_relaxed) != position + 1)
+        {
+            break;
+        }
+        readyCount++;
+    }
+    return readyCount;
+}
+
+template <typename T>
+size_t SpscQueueSequenced<T>::GetRealCapacity() const
+{
+    return m_Capacity;
+}
+
+template <typename T>
+std::string SpscQueueSequenced<T>::CreateShmObjectName(uint32_t ownerPid, const std::string& nameSuffix)
+{
+    std::ostringstream oss;
+    oss << "spsc_queue_buffer_uid{" << ownerPid << "}" << nameSuffix;
+    return oss.str();
+}
@@ -1,24 +1,31 @@
 #pragma once
 
+#include <array>
 #include <cstdint>
 #include <chrono>
+#include <sstream>
+#include <string>
+
+#include "LatencyHistogram.h"
+#include "TscClock.h"
 
 class ClientStats
 {
 public:
-    using Clock = std::chrono::high_resolution_clock;
-    using TimePoint = std::chrono::time_point<Clock>;
+    // Request stages that can be timed separately, see RecordStageTime()
+    static constexpr uint32_t MAX_STAGES = 8;
 
     void StartTimer()
     {
-        startTime = Clock::now();
+        m_StartTicks = TscClock::Now();
     }
 
     void StopTimer()
     {
-        endTime = Clock::now();
+        uint64_t elapsedNs = TscClock::TicksToNs(TscClock::Now() - m_StartTicks);
         m_TotalRequests++;
-        m_TotalElapsedTimeUs += std::chrono::duration_cast<std::chrono::nanoseconds>(endTime - startTime).count();
+        m_TotalElapsedTimeNs += elapsedNs;
+        m_ElapsedTimes.Record(elapsedNs);
     }
 
     uint64_t GetTotalRequests() const
@@ -26,19 +33,109 @@ public:
         return m_TotalRequests;
     }
 
-    uint64_t GetAverageElapsedTimeUs() const
+    uint64_t GetAverageElapsedTimeNs() const
     {
         if (m_TotalRequests == 0)
         {
             return 0;
         }
-        return m_TotalElapsedTimeUs / m_TotalRequests;
+        return m_TotalElapsedTimeNs / m_TotalRequests;
+    }
+
+    const LatencyHistogram& GetElapsedTimes() const
+    {
+        return m_ElapsedTimes;
+    }
+
+    // Elapsed time percentiles in the form printed by both the server and the client
+    std::string GetLatencySummary() const
+    {
+        std::ostringstream oss;
+        oss << "avgTime: " << GetAverageElapsedTimeNs()
+            << ", p50: " << m_ElapsedTimes.GetPercentileNs(50.0)
+            << ", p99: " << m_ElapsedTimes.GetPercentileNs(99.0)
+            << ", p99.9: " << m_ElapsedTimes.GetPercentileNs(99.9)
+            << ", max: " << m_ElapsedTimes.GetMaxNs() << " (ns)";
+        return oss.str();
+    }
+
+    // Time a request spent in one stage of its processing; the stages are up to the user
+    void RecordStageTime(uint32_t stage, uint64_t elapsedNs)
+    {
+        m_StageTimes[stage].Record(elapsedNs);
+    }
+
+    const LatencyHistogram& GetStageTimes(uint32_t stage) const
+    {
+        return m_StageTimes[stage];
+    }
+
+    void RecordDeadlineOutcome(bool deadlineMet)
+    {
+        if (deadlineMet)
+        {
+            m_MetDeadlines++;
+        }
+        else
+        {
+            m_MissedDeadlines++;
+        }
+    }
+
+    uint64_t GetMetDeadlines() const
+    {
+        return m_MetDeadlines;
+    }
+
+    uint64_t GetMissedDeadlines() const
+    {
+        return m_MissedDeadlines;
+    }
+
+    void AddBytes(uint64_t bytes)
+    {
+        m_TotalBytes += bytes;
+    }
+
+    uint64_t GetTotalBytes() const
+    {
+        return m_TotalBytes;
+    }
+
+    // Adds the counts of another set of stats, e.g. of another lane of the same client
+    void Merge(const ClientStats& other)
+    {
+        m_TotalElapsedTimeNs += other.m_TotalElapsedTimeNs;
+        m_ElapsedTimes.Merge(other.m_ElapsedTimes);
+        for (uint32_t stage = 0; stage < MAX_STAGES; stage++)
+        {
+            m_StageTimes[stage].Merge(other.m_StageTimes[stage]);
+        }
+        m_TotalRequests += other.m_TotalRequests;
+        m_TotalBytes += other.m_TotalBytes;
+        m_MetDeadlines += other.m_MetDeadlines;
+        m_MissedDeadlines += other.m_MissedDeadlines;
+    }
+
+    // Fraction of allClientsBytes that was moved for this client
+    double GetBytesShare(uint64_t allClientsBytes) const
+    {
+        if (allClientsBytes == 0)
+        {
+            return 0.0;
+        }
+        return static_cast<double>(m_TotalBytes) / static_cast<double>(allClientsBytes);
     }
 
 // private:
-    TimePoint startTime;
-    TimePoint endTime;
-    uint64_t m_TotalElapsedTimeUs { 0 };
+    // TscClock ticks
+    uint64_t m_StartTicks { 0 };
+    uint64_t m_TotalElapsedTimeNs { 0 };
+    LatencyHistogram m_ElapsedTimes;
+    std::array<LatencyHistogram, MAX_STAGES> m_StageTimes;
     uint64_t m_TotalRequests { 0 };
+    uint64_t m_TotalBytes { 0 };
+    uint64_t m_MetDeadlines { 0 };
+    uint64_t m_MissedDeadlines { 0 };
 
 };
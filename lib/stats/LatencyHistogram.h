@@ -0,0 +1,130 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <limits>
+
+// Log-linear latency histogram with fixed memory, in the style of HdrHistogram. Values below
+// SUB_BUCKET_COUNT get a bucket each. Above that, every power of two is split into
+// SUB_BUCKET_COUNT equal buckets, so a reported value is never more than 1/SUB_BUCKET_COUNT
+// (about 3%) above the value recorded. Values from 2^MAX_VALUE_BITS ns (about 18 minutes) up
+// share one overflow bucket at the end.
+//
+// Recording never allocates. Histograms of different threads are combined with Merge.
+class LatencyHistogram
+{
+public:
+    static constexpr uint32_t SUB_BUCKET_BITS = 5;
+    static constexpr uint32_t SUB_BUCKET_COUNT = 1 << SUB_BUCKET_BITS;
+    static constexpr uint32_t MAX_VALUE_BITS = 40;
+    static constexpr uint32_t BUCKET_COUNT = (MAX_VALUE_BITS - SUB_BUCKET_BITS + 1) * SUB_BUCKET_COUNT + 1;
+
+    void Record(uint64_t valueNs)
+    {
+        m_Counts[BucketIndex(valueNs)]++;
+        m_Count++;
+        m_SumNs += valueNs;
+        m_MinNs = std::min(m_MinNs, valueNs);
+        m_MaxNs = std::max(m_MaxNs, valueNs);
+    }
+
+    void Merge(const LatencyHistogram& other)
+    {
+        for (uint32_t bucket = 0; bucket < BUCKET_COUNT; bucket++)
+        {
+            m_Counts[bucket] += other.m_Counts[bucket];
+        }
+        m_Count += other.m_Count;
+        m_SumNs += other.m_SumNs;
+        m_MinNs = std::min(m_MinNs, other.m_MinNs);
+        m_MaxNs = std::max(m_MaxNs, other.m_MaxNs);
+    }
+
+    uint64_t GetCount() const
+    {
+        return m_Count;
+    }
+
+    uint64_t GetMinNs() const
+    {
+        return (m_Count == 0) ? 0 : m_MinNs;
+    }
+
+    uint64_t GetMaxNs() const
+    {
+        return m_MaxNs;
+    }
+
+    uint64_t GetMeanNs() const
+    {
+        return (m_Count == 0) ? 0 : m_SumNs / m_Count;
+    }
+
+    // Smallest value that at least percentile percent of the recorded values do not exceed, up to
+    // the bucket resolution. Never above the largest value recorded.
+    uint64_t GetPercentileNs(double percentile) const
+    {
+        if (m_Count == 0)
+        {
+            return 0;
+        }
+
+        double clampedPercentile = std::clamp(percentile, 0.0, 100.0);
+        uint64_t rank = static_cast<uint64_t>(clampedPercentile / 100.0 * static_cast<double>(m_Count) + 0.5);
+        rank = std::clamp<uint64_t>(rank, 1, m_Count);
+
+        uint64_t seen = 0;
+        for (uint32_t bucket = 0; bucket < BUCKET_COUNT; bucket++)
+        {
+            seen += m_Counts[bucket];
+            if (seen >= rank)
+            {
+                return std::min(BucketUpperBound(bucket), m_MaxNs);
+            }
+        }
+        return m_MaxNs;
+    }
+
+    static uint32_t BucketIndex(uint64_t valueNs)
+    {
+        if (valueNs < SUB_BUCKET_COUNT)
+        {
+            return static_cast<uint32_t>(valueNs);
+        }
+
+        uint32_t topBit = std::bit_width(valueNs) - 1;
+        if (topBit >= MAX_VALUE_BITS)
+        {
+            return BUCKET_COUNT - 1;
+        }
+
+        // The SUB_BUCKET_BITS bits below the top bit select the sub-bucket
+        uint32_t shift = topBit - SUB_BUCKET_BITS;
+        return (shift + 1) * SUB_BUCKET_COUNT + static_cast<uint32_t>((valueNs >> shift) - SUB_BUCKET_COUNT);
+    }
+
+    static uint64_t BucketUpperBound(uint32_t bucket)
+    {
+        if (bucket < SUB_BUCKET_COUNT)
+        {
+            return bucket;
+        }
+        if (bucket == BUCKET_COUNT - 1)
+        {
+            return std::numeric_limits<uint64_t>::max();
+        }
+
+        uint32_t shift = bucket / SUB_BUCKET_COUNT - 1;
+        uint64_t lowerBound = static_cast<uint64_t>(SUB_BUCKET_COUNT + bucket % SUB_BUCKET_COUNT) << shift;
+        return lowerBound + (1ULL << shift) - 1;
+    }
+
+private:
+    std::array<uint64_t, BUCKET_COUNT> m_Counts {};
+    uint64_t m_Count { 0 };
+    uint64_t m_SumNs { 0 };
+    uint64_t m_MinNs { std::numeric_limits<uint64_t>::max() };
+    uint64_t m_MaxNs { 0 };
+};
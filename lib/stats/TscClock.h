@@ -0,0 +1,225 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <sched.h>
+#include <thread>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#include <x86intrin.h>
+#endif
+
+// Clock for hot-path timing that reads the CPU's time stamp counter instead of calling into the
+// vDSO. Ticks are TSC cycles once Calibrate() has found the TSC usable: invariant (constant rate,
+// running in every C-state) and in step across the cores the process may run on. Otherwise, and
+// before Calibrate() is called, ticks are steady_clock nanoseconds, so the clock always works.
+//
+// On a machine with a usable TSC all processes read the same counter, so ticks taken in
+// different processes can be subtracted as long as both use the TSC. Each process decides that
+// for the cores it may run on, so processes that exchange ticks agree on one mode with Adopt().
+// Only differences of ticks should be converted to nanoseconds; absolute times that another
+// process must interpret (e.g. deadlines) belong on steady_clock.
+class TscClock
+{
+public:
+    static uint64_t Now()
+    {
+#if defined(__x86_64__) || defined(__i386__)
+        if (s_UsesTsc.load(std::memory_order_relaxed))
+        {
+            return __rdtsc();
+        }
+#endif
+        return SteadyNowNs();
+    }
+
+    static uint64_t TicksToNs(uint64_t ticks)
+    {
+        return static_cast<uint64_t>(static_cast<double>(ticks) * s_NsPerTick.load(std::memory_order_relaxed));
+    }
+
+    static bool UsesTsc()
+    {
+        return s_UsesTsc.load(std::memory_order_relaxed);
+    }
+
+    static double GetTicksPerNs()
+    {
+        return 1.0 / s_NsPerTick.load(std::memory_order_relaxed);
+    }
+
+    // Decides whether to use the TSC and measures its rate against steady_clock for the given
+    // time. Meant to be called once at startup before any thread takes timestamps. Returns
+    // whether the TSC is used.
+    static bool Calibrate(std::chrono::milliseconds duration = std::chrono::milliseconds(20))
+    {
+        UseSteadyClock();
+        if (!IsInvariant() || !IsConsistentAcrossCores())
+        {
+            return false;
+        }
+        return UseTsc(duration);
+    }
+
+    // Switches to the mode of another process whose ticks this one compares with its own, e.g.
+    // one that found the TSC in step across its cores while this one did not, or the other way
+    // round. Meant to be called before any thread takes timestamps to compare. Returns false if
+    // useTsc is set but the TSC cannot be used here at all, leaving the clock on steady_clock.
+    static bool Adopt(bool useTsc, std::chrono::milliseconds duration = std::chrono::milliseconds(20))
+    {
+        if (useTsc == UsesTsc())
+        {
+            return true;
+        }
+
+        UseSteadyClock();
+        return !useTsc || (IsInvariant() && UseTsc(duration));
+    }
+
+    // CPUID advertises an invariant TSC
+    static bool IsInvariant()
+    {
+#if defined(__x86_64__) || defined(__i386__)
+        unsigned int eax, ebx, ecx, edx;
+        if (__get_cpuid(0x80000000, &eax, &ebx, &ecx, &edx) == 0 || eax < 0x80000007)
+        {
+            return false;
+        }
+
+        __get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx);
+        return (edx & (1u << 8)) != 0;
+#else
+        return false;
+#endif
+    }
+
+    // Passes a token between a thread on the first allowed CPU and a thread on each other allowed
+    // CPU. Every holder reads the TSC after the previous holder did, so a reading below the
+    // previous one means the two counters are out of step.
+    static bool IsConsistentAcrossCores(uint32_t handoverCount = 10000)
+    {
+#if defined(__x86_64__) || defined(__i386__)
+        cpu_set_t allowedCpus;
+        if (sched_getaffinity(0, sizeof(allowedCpus), &allowedCpus) != 0)
+        {
+            return false;
+        }
+
+        std::vector<int> cpus;
+        for (int cpu = 0; cpu < CPU_SETSIZE; cpu++)
+        {
+            if (CPU_ISSET(cpu, &allowedCpus))
+            {
+                cpus.push_back(cpu);
+            }
+        }
+
+        for (size_t cpuIndex = 1; cpuIndex < cpus.size(); cpuIndex++)
+        {
+            std::atomic<uint32_t> turn { 0 };
+            std::atomic<uint64_t> lastTicks { 0 };
+            std::atomic<bool> warped { false };
+
+            auto passToken = [&](int cpu, uint32_t side)
+            {
+                cpu_set_t cpuSet;
+                CPU_ZERO(&cpuSet);
+                CPU_SET(cpu, &cpuSet);
+                sched_setaffinity(0, sizeof(cpuSet), &cpuSet);
+
+                for (uint32_t handover = side; handover < 2 * handoverCount; handover += 2)
+                {
+                    while (turn.load(std::memory_order_acquire) != handover)
+                    {
+                        _mm_pause();
+                    }
+
+                    unsigned int aux;
+                    uint64_t ticks = __rdtscp(&aux);
+                    if (ticks < lastTicks.load(std::memory_order_relaxed))
+                    {
+                        warped.store(true, std::memory_order_relaxed);
+                    }
+                    lastTicks.store(ticks, std::memory_order_relaxed);
+                    turn.store(handover + 1, std::memory_order_release);
+                }
+            };
+
+            std::thread first(passToken, cpus[0], 0);
+            std::thread second(passToken, cpus[cpuIndex], 1);
+            first.join();
+            second.join();
+
+            if (warped.load())
+            {
+                return false;
+            }
+        }
+        return true;
+#else
+        return false;
+#endif
+    }
+
+private:
+    static void UseSteadyClock()
+    {
+        s_UsesTsc.store(false, std::memory_order_relaxed);
+        s_NsPerTick.store(1.0, std::memory_order_relaxed);
+    }
+
+    // Measures the TSC rate against steady_clock for the given time and switches to the TSC
+    static bool UseTsc(std::chrono::milliseconds duration)
+    {
+#if defined(__x86_64__) || defined(__i386__)
+        uint64_t startNs = 0, startTicks = 0, endNs = 0, endTicks = 0;
+        ReadPair(startNs, startTicks);
+        std::this_thread::sleep_for(duration);
+        ReadPair(endNs, endTicks);
+
+        if (endTicks <= startTicks || endNs <= startNs)
+        {
+            return false;
+        }
+
+        s_NsPerTick.store(static_cast<double>(endNs - startNs) / static_cast<double>(endTicks - startTicks), std::memory_order_relaxed);
+        s_UsesTsc.store(true, std::memory_order_relaxed);
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    static uint64_t SteadyNowNs()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+#if defined(__x86_64__) || defined(__i386__)
+    // steady_clock time and TSC read as close together as a few attempts allow
+    static void ReadPair(uint64_t& ns, uint64_t& ticks)
+    {
+        uint64_t bestWindow = UINT64_MAX;
+        for (int attempt = 0; attempt < 16; attempt++)
+        {
+            uint64_t before = __rdtsc();
+            uint64_t nowNs = SteadyNowNs();
+            uint64_t after = __rdtsc();
+            if (after - before < bestWindow)
+            {
+                bestWindow = after - before;
+                ns = nowNs;
+                ticks = before + (after - before) / 2;
+            }
+        }
+    }
+#endif
+
+    // Atomic only so that a thread reading the clock while Calibrate() or Adopt() runs is not a
+    // data race; relaxed loads cost the same as plain ones
+    static inline std::atomic<bool> s_UsesTsc { false };
+    static inline std::atomic<double> s_NsPerTick { 1.0 };
+};
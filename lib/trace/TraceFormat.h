@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+// Binary layout of the trace dumps written by Tracer::Dump and read by TraceReader. A dump is a
+// TraceFileHeader, the descriptions of event ids 0, 1, ... (name, arg0 name and arg1 name, each a
+// uint16_t length followed by the characters), then for each thread a TraceThreadHeader followed
+// by its events, oldest first.
+
+enum class TracePhase : uint8_t
+{
+    Begin,      // Starts a span on the thread; spans nest
+    End,        // Ends the innermost open span of the thread
+    Instant,    // A point in time
+};
+
+// 32 bytes, two events per cache line. Ticks are TscClock ticks.
+struct TraceEvent
+{
+    uint64_t ticks;
+    uint64_t arg0;
+    uint64_t arg1;
+    uint16_t eventId;
+    TracePhase phase;
+    uint8_t reserved[5];
+};
+
+static_assert(sizeof(TraceEvent) == 32, "TraceEvent should stay two per cache line");
+
+// What an event id stands for. An argument without a name is not shown.
+struct TraceEventInfo
+{
+    std::string name;
+    std::string arg0Name;
+    std::string arg1Name;
+};
+
+constexpr char TRACE_FILE_MAGIC[8] = { 'T', 'R', 'P', 'T', 'R', 'A', 'C', 'E' };
+constexpr uint32_t TRACE_FILE_VERSION = 1;
+constexpr uint32_t TRACE_NAME_LENGTH = 32;
+
+struct TraceFileHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t pid;
+    char processName[TRACE_NAME_LENGTH];
+
+    // Converts ticks to time. Ticks of processes on the same machine share a time base, since
+    // TscClock reads the same counter (or steady_clock) in every process.
+    double nsPerTick;
+    uint32_t eventInfoCount;
+    uint32_t threadCount;
+};
+
+struct TraceThreadHeader
+{
+    uint32_t tid;
+    char name[TRACE_NAME_LENGTH];
+    uint32_t reserved;
+    uint64_t eventCount;
+};
@@ -0,0 +1,209 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "TraceFormat.h"
+
+// A trace dump written by Tracer::Dump
+struct TraceDump
+{
+    struct Thread
+    {
+        uint32_t tid;
+        std::string name;
+        std::vector<TraceEvent> events;
+    };
+
+    uint32_t pid;
+    std::string processName;
+    double nsPerTick;
+    std::vector<TraceEventInfo> eventInfos;
+    std::vector<Thread> threads;
+};
+
+// Reads trace dumps and writes them as Chrome trace event JSON, which chrome://tracing and the
+// Perfetto UI open directly. Dumps of several processes are merged onto one timeline, so a
+// request can be followed from the client's submit through the server and back.
+class TraceReader
+{
+public:
+    // Throws if the file cannot be read or is not a trace dump
+    static TraceDump Read(const std::string& path)
+    {
+        std::ifstream file(path, std::ios::binary);
+        if (!file)
+        {
+            throw std::runtime_error("Failed to open trace " + path);
+        }
+
+        TraceFileHeader fileHeader;
+        ReadBytes(file, path, &fileHeader, sizeof(fileHeader));
+        if (std::memcmp(fileHeader.magic, TRACE_FILE_MAGIC, sizeof(fileHeader.magic)) != 0)
+        {
+            throw std::runtime_error(path + " is not a trace dump");
+        }
+        if (fileHeader.version != TRACE_FILE_VERSION)
+        {
+            throw std::runtime_error(path + " has trace format version " + std::to_string(fileHeader.version) + ", expected " + std::to_string(TRACE_FILE_VERSION));
+        }
+
+        TraceDump dump;
+        dump.pid = fileHeader.pid;
+        dump.processName = TerminatedName(fileHeader.processName);
+        dump.nsPerTick = fileHeader.nsPerTick;
+
+        dump.eventInfos.resize(fileHeader.eventInfoCount);
+        for (TraceEventInfo& eventInfo : dump.eventInfos)
+        {
+            eventInfo.name = ReadString(file, path);
+            eventInfo.arg0Name = ReadString(file, path);
+            eventInfo.arg1Name = ReadString(file, path);
+        }
+
+        dump.threads.resize(fileHeader.threadCount);
+        for (TraceDump::Thread& thread : dump.threads)
+        {
+            TraceThreadHeader threadHeader;
+            ReadBytes(file, path, &threadHeader, sizeof(threadHeader));
+            thread.tid = threadHeader.tid;
+            thread.name = TerminatedName(threadHeader.name);
+            thread.events.resize(threadHeader.eventCount);
+            ReadBytes(file, path, thread.events.data(), thread.events.size() * sizeof(TraceEvent));
+        }
+        return dump;
+    }
+
+    // Writes the events of all dumps as one Chrome trace. Timestamps are microseconds since the
+    // earliest event of any dump. Spans whose begin was overwritten in the ring are left out.
+    static void WriteChromeTrace(const std::vector<TraceDump>& dumps, std::ostream& out)
+    {
+        uint64_t firstTicks = UINT64_MAX;
+        for (const TraceDump& dump : dumps)
+        {
+            for (const TraceDump::Thread& thread : dump.threads)
+            {
+                for (const TraceEvent& event : thread.events)
+                {
+                    firstTicks = std::min(firstTicks, event.ticks);
+                }
+            }
+        }
+
+        out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+        bool first = true;
+        auto separate = [&]()
+        {
+            out << (first ? "\n" : ",\n");
+            first = false;
+        };
+
+        out << std::fixed << std::setprecision(3);
+        for (const TraceDump& dump : dumps)
+        {
+            separate();
+            out << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":" << dump.pid << ",\"args\":{\"name\":\"" << Escape(dump.processName) << "\"}}";
+
+            for (const TraceDump::Thread& thread : dump.threads)
+            {
+                separate();
+                out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":" << dump.pid << ",\"tid\":" << thread.tid
+                    << ",\"args\":{\"name\":\"" << Escape(thread.name) << "\"}}";
+
+                uint32_t openSpans = 0;
+                for (const TraceEvent& event : thread.events)
+                {
+                    if (event.phase == TracePhase::End && openSpans == 0)
+                    {
+                        continue;
+                    }
+                    openSpans += (event.phase == TracePhase::Begin) ? 1 : 0;
+                    openSpans -= (event.phase == TracePhase::End) ? 1 : 0;
+
+                    separate();
+                    WriteEvent(dump, thread, event, firstTicks, out);
+                }
+            }
+        }
+        out << "\n]}\n";
+    }
+
+private:
+    static void ReadBytes(std::ifstream& file, const std::string& path, void* pDestination, size_t size)
+    {
+        if (!file.read(static_cast<char*>(pDestination), size))
+        {
+            throw std::runtime_error(path + " is truncated");
+        }
+    }
+
+    static std::string ReadString(std::ifstream& file, const std::string& path)
+    {
+        uint16_t length;
+        ReadBytes(file, path, &length, sizeof(length));
+        std::string text(length, '\0');
+        ReadBytes(file, path, text.data(), length);
+        return text;
+    }
+
+    static std::string TerminatedName(const char (&name)[TRACE_NAME_LENGTH])
+    {
+        return std::string(name, strnlen(name, TRACE_NAME_LENGTH));
+    }
+
+    static std::string Escape(const std::string& text)
+    {
+        std::string escaped;
+        for (char character : text)
+        {
+            if (character == '"' || character == '\\')
+            {
+                escaped += '\\';
+            }
+            if (static_cast<unsigned char>(character) >= 0x20)
+            {
+                escaped += character;
+            }
+        }
+        return escaped;
+    }
+
+    static void WriteEvent(const TraceDump& dump, const TraceDump::Thread& thread, const TraceEvent& event, uint64_t firstTicks, std::ostream& out)
+    {
+        static const TraceEventInfo unknownEvent { "unknown", "arg0", "arg1" };
+        const TraceEventInfo& eventInfo = (event.eventId < dump.eventInfos.size()) ? dump.eventInfos[event.eventId] : unknownEvent;
+
+        const char* phase = (event.phase == TracePhase::Begin) ? "B" : (event.phase == TracePhase::End) ? "E" : "i";
+        double timestampUs = static_cast<double>(event.ticks - firstTicks) * dump.nsPerTick / 1000.0;
+
+        out << "{\"name\":\"" << Escape(eventInfo.name) << "\",\"ph\":\"" << phase << "\",\"ts\":" << timestampUs
+            << ",\"pid\":" << dump.pid << ",\"tid\":" << thread.tid;
+
+        if (event.phase == TracePhase::Instant)
+        {
+            out << ",\"s\":\"t\"";
+        }
+
+        if (event.phase != TracePhase::End && (!eventInfo.arg0Name.empty() || !eventInfo.arg1Name.empty()))
+        {
+            out << ",\"args\":{";
+            if (!eventInfo.arg0Name.empty())
+            {
+                out << "\"" << Escape(eventInfo.arg0Name) << "\":" << event.arg0;
+            }
+            if (!eventInfo.arg1Name.empty())
+            {
+                out << (eventInfo.arg0Name.empty() ? "" : ",") << "\"" << Escape(eventInfo.arg1Name) << "\":" << event.arg1;
+            }
+            out << "}";
+        }
+        out << "}";
+    }
+};
@@ -0,0 +1,296 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <csignal>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <sys/syscall.h>
+#include <thread>
+#include <unistd.h>
+#include <utility>
+#include <vector>
+
+#include "Logger.h"
+#include "TraceFormat.h"
+#include "TscClock.h"
+
+// Flight recorder of compact binary events. Every thread that records gets a ring of its own on
+// its first event, so recording takes no lock and shares no cache line with other threads: a
+// relaxed load of the switch, a TscClock read and a 32 byte store. The rings keep the latest
+// RING_CAPACITY events of each thread, and Dump() writes them to a file that TraceReader turns
+// into a Chrome trace.
+//
+// Tracing is off until SetEnabled(true), and can be switched at any time from any thread. Rings
+// outlive their threads so that a dump still shows threads that have exited.
+class Tracer
+{
+public:
+    // Events kept per thread, 2 MB of ring
+    static constexpr uint64_t RING_CAPACITY = 1 << 16;
+
+    static void SetEnabled(bool enabled)
+    {
+        s_Enabled.store(enabled, std::memory_order_relaxed);
+    }
+
+    static bool IsEnabled()
+    {
+        return s_Enabled.load(std::memory_order_relaxed);
+    }
+
+    // Descriptions of the event ids, written into every dump
+    static void SetEventInfos(std::vector<TraceEventInfo> eventInfos)
+    {
+        std::lock_guard<std::mutex> lock(s_Mutex);
+        s_EventInfos = std::move(eventInfos);
+    }
+
+    // Names the calling thread in dumps. Cheap enough to call at the start of every thread,
+    // whether or not tracing is on.
+    static void SetThreadName(const std::string& name)
+    {
+        CopyName(t_ThreadName, name);
+        if (t_pRing != nullptr)
+        {
+            CopyName(t_pRing->name, name);
+        }
+    }
+
+    static void Record(uint16_t eventId, TracePhase phase, uint64_t arg0 = 0, uint64_t arg1 = 0)
+    {
+        if (!s_Enabled.load(std::memory_order_relaxed))
+        {
+            return;
+        }
+
+        TraceRing* pRing = t_pRing;
+        if (pRing == nullptr)
+        {
+            pRing = RegisterThread();
+        }
+
+        // Only this thread writes the ring, the release store publishes the event to Dump()
+        uint64_t head = pRing->head.load(std::memory_order_relaxed);
+        TraceEvent& event = pRing->pEvents[head & (RING_CAPACITY - 1)];
+        event.ticks = TscClock::Now();
+        event.arg0 = arg0;
+        event.arg1 = arg1;
+        event.eventId = eventId;
+        event.phase = phase;
+        pRing->head.store(head + 1, std::memory_order_release);
+    }
+
+    static void Begin(uint16_t eventId, uint64_t arg0 = 0, uint64_t arg1 = 0)
+    {
+        Record(eventId, TracePhase::Begin, arg0, arg1);
+    }
+
+    static void End(uint16_t eventId)
+    {
+        Record(eventId, TracePhase::End);
+    }
+
+    static void Instant(uint16_t eventId, uint64_t arg0 = 0, uint64_t arg1 = 0)
+    {
+        Record(eventId, TracePhase::Instant, arg0, arg1);
+    }
+
+    // Events recorded by all threads so far, including those overwritten since
+    static uint64_t GetRecordedCount()
+    {
+        std::lock_guard<std::mutex> lock(s_Mutex);
+        uint64_t count = 0;
+        for (const auto& pRing : s_Rings)
+        {
+            count += pRing->head.load(std::memory_order_relaxed);
+        }
+        return count;
+    }
+
+    // Writes the events currently held by every ring to path and returns how many were written.
+    // Threads keep recording meanwhile; events they overwrite while being copied are left out.
+    // Throws if the file cannot be written.
+    static uint64_t Dump(const std::string& path)
+    {
+        TraceFileHeader fileHeader {};
+        std::memcpy(fileHeader.magic, TRACE_FILE_MAGIC, sizeof(fileHeader.magic));
+        fileHeader.version = TRACE_FILE_VERSION;
+        fileHeader.pid = static_cast<uint32_t>(getpid());
+        CopyName(fileHeader.processName, program_invocation_short_name);
+        fileHeader.nsPerTick = 1.0 / TscClock::GetTicksPerNs();
+
+        std::vector<TraceEventInfo> eventInfos;
+        std::vector<std::pair<TraceThreadHeader, std::vector<TraceEvent>>> threads;
+        {
+            std::lock_guard<std::mutex> lock(s_Mutex);
+            eventInfos = s_EventInfos;
+            for (const auto& pRing : s_Rings)
+            {
+                TraceThreadHeader threadHeader {};
+                threadHeader.tid = pRing->tid;
+                std::memcpy(threadHeader.name, pRing->name, sizeof(threadHeader.name));
+                threads.emplace_back(threadHeader, Snapshot(*pRing));
+            }
+        }
+
+        fileHeader.eventInfoCount = static_cast<uint32_t>(eventInfos.size());
+        fileHeader.threadCount = static_cast<uint32_t>(threads.size());
+
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char*>(&fileHeader), sizeof(fileHeader));
+        for (const TraceEventInfo& eventInfo : eventInfos)
+        {
+            WriteString(file, eventInfo.name);
+            WriteString(file, eventInfo.arg0Name);
+            WriteString(file, eventInfo.arg1Name);
+        }
+
+        uint64_t eventCount = 0;
+        for (auto& [threadHeader, events] : threads)
+        {
+            threadHeader.eventCount = events.size();
+            file.write(reinterpret_cast<const char*>(&threadHeader), sizeof(threadHeader));
+            file.write(reinterpret_cast<const char*>(events.data()), events.size() * sizeof(TraceEvent));
+            eventCount += events.size();
+        }
+
+        file.flush();
+        if (!file)
+        {
+            throw std::runtime_error("Failed to write trace to " + path);
+        }
+        return eventCount;
+    }
+
+    // Drops the events of every ring. Only for when no thread is recording, e.g. between tests.
+    static void Clear()
+    {
+        std::lock_guard<std::mutex> lock(s_Mutex);
+        for (const auto& pRing : s_Rings)
+        {
+            pRing->head.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    // Serves SIGUSR1 and SIGUSR2 on a thread of its own: SIGUSR1 switches tracing on or off and
+    // SIGUSR2 dumps to <dumpPathPrefix>.<pid>.<n>.trace. Blocks both signals on the calling
+    // thread, so it must be called from main before other threads are started for them to
+    // inherit the mask.
+    static void StartSignalControl(const std::string& dumpPathPrefix)
+    {
+        sigset_t signals;
+        sigemptyset(&signals);
+        sigaddset(&signals, SIGUSR1);
+        sigaddset(&signals, SIGUSR2);
+        pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+
+        std::thread([signals, dumpPathPrefix]()
+        {
+            SetThreadName("trace control");
+
+            uint32_t dumpCount = 0;
+            while (true)
+            {
+                int signal;
+                if (sigwait(&signals, &signal) != 0)
+                {
+                    continue;
+                }
+
+                if (signal == SIGUSR1)
+                {
+                    SetEnabled(!IsEnabled());
+                    LOG_INFO("Tracing {}", IsEnabled() ? "enabled" : "disabled");
+                    continue;
+                }
+
+                std::string path = dumpPathPrefix + "." + std::to_string(getpid()) + "." + std::to_string(dumpCount++) + ".trace";
+                try
+                {
+                    uint64_t eventCount = Dump(path);
+                    LOG_INFO("Wrote {} trace events to {}", eventCount, path);
+                }
+                catch(const std::exception& e)
+                {
+                    LOG_ERROR("{}", e.what());
+                }
+            }
+        }).detach();
+    }
+
+private:
+    struct alignas(64) TraceRing
+    {
+        // Events ever recorded into the ring; event i is at pEvents[i % RING_CAPACITY]
+        std::atomic<uint64_t> head { 0 };
+        uint32_t tid { 0 };
+        char name[TRACE_NAME_LENGTH] {};
+        std::unique_ptr<TraceEvent[]> pEvents { std::make_unique<TraceEvent[]>(RING_CAPACITY) };
+    };
+
+    template<size_t Length>
+    static void CopyName(char (&destination)[Length], const std::string& name)
+    {
+        size_t length = std::min(name.size(), Length - 1);
+        std::memcpy(destination, name.data(), length);
+        destination[length] = '\0';
+    }
+
+    static void WriteString(std::ofstream& file, const std::string& text)
+    {
+        uint16_t length = static_cast<uint16_t>(std::min<size_t>(text.size(), UINT16_MAX));
+        file.write(reinterpret_cast<const char*>(&length), sizeof(length));
+        file.write(text.data(), length);
+    }
+
+    static TraceRing* RegisterThread()
+    {
+        auto pRing = std::make_unique<TraceRing>();
+        pRing->tid = static_cast<uint32_t>(syscall(SYS_gettid));
+        std::memcpy(pRing->name, t_ThreadName, sizeof(pRing->name));
+
+        std::lock_guard<std::mutex> lock(s_Mutex);
+        t_pRing = pRing.get();
+        s_Rings.push_back(std::move(pRing));
+        return t_pRing;
+    }
+
+    // Copies the events of the ring, oldest first, while its thread may keep recording
+    static std::vector<TraceEvent> Snapshot(const TraceRing& ring)
+    {
+        uint64_t endIndex = ring.head.load(std::memory_order_acquire);
+        uint64_t beginIndex = (endIndex > RING_CAPACITY) ? endIndex - RING_CAPACITY : 0;
+
+        std::vector<TraceEvent> events(endIndex - beginIndex);
+        for (uint64_t index = beginIndex; index < endIndex; index++)
+        {
+            events[index - beginIndex] = ring.pEvents[index & (RING_CAPACITY - 1)];
+        }
+
+        // The writer may have wrapped around into the copied range meanwhile, including the slot
+        // of the event it is writing right now
+        std::atomic_thread_fence(std::memory_order_acquire);
+        uint64_t headAfterCopy = ring.head.load(std::memory_order_relaxed);
+        uint64_t firstIntactIndex = (headAfterCopy + 1 > RING_CAPACITY) ? headAfterCopy + 1 - RING_CAPACITY : 0;
+        if (firstIntactIndex > beginIndex)
+        {
+            events.erase(events.begin(), events.begin() + std::min(firstIntactIndex - beginIndex, events.size()));
+        }
+        return events;
+    }
+
+    static inline std::atomic<bool> s_Enabled { false };
+    static inline std::mutex s_Mutex;
+    static inline std::vector<std::unique_ptr<TraceRing>> s_Rings;
+    static inline std::vector<TraceEventInfo> s_EventInfos;
+
+    static inline thread_local TraceRing* t_pRing { nullptr };
+    static inline thread_local char t_ThreadName[TRACE_NAME_LENGTH] {};
+};
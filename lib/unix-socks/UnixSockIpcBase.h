@@ -11,6 +11,8 @@
 #include <cerrno>
 #include <cstring>
 
+#include "Logger.h"
+
 template <typename T>
 class UnixSockIpcBase
 {
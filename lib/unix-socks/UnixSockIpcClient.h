@@ -1,6 +1,5 @@
 #pragma once
 
-#include <iostream>
 #include <atomic>
 #include <cstdint>
 #include <sys/epoll.h>
@@ -36,7 +35,7 @@ public:
         if(connect(this->m_BaseSocketFd, (const sockaddr*)(&(this->m_AddrStruct)), sizeof(this->m_AddrStruct)) < 0)
         {
             close(this->m_BaseSocketFd);
-            std::cerr << "Failed to connect to server (errno: " + std::to_string(errno) + "): " + std::string(strerror(errno)) << std::endl;
+            LOG_ERROR("Failed to connect to server (errno: {}): {}", errno, strerror(errno));
             throw std::runtime_error("Failed to connect to server (errno: " + std::to_string(errno) + "): " + std::string(strerror(errno)));
         }
 
@@ -44,7 +43,7 @@ public:
         if (this->m_epollFd < 0)
         {
             close(this->m_BaseSocketFd);
-            std::cerr << "Failed to create epoll instance (errno: " + std::to_string(errno) + "): " + std::string(strerror(errno)) << std::endl;
+            LOG_ERROR("Failed to create epoll instance (errno: {}): {}", errno, strerror(errno));
             throw std::runtime_error("Failed to create epoll instance (errno: " + std::to_string(errno) + "): " + std::string(strerror(errno)));
         }
 
@@ -53,7 +52,7 @@ public:
 
         if (epoll_ctl(this->m_epollFd, EPOLL_CTL_ADD, this->m_BaseSocketFd, &(this->ePollEvent)) < 0) {
             close(this->m_BaseSocketFd);
-            std::cerr << "Failed to add server socket to epoll instance (errno: " + std::to_string(errno) + "): " + std::string(strerror(errno)) << std::endl;
+            LOG_ERROR("Failed to add server socket to epoll instance (errno: {}): {}", errno, strerror(errno));
             throw std::runtime_error("Failed to add server socket to epoll instance (errno: " + std::to_string(errno) + "): " + std::string(strerror(errno)));
         }
 
@@ -65,14 +64,44 @@ public:
     {
         if (!this->m_Running)
         {
-            std::cerr << "Communicator is not initialized or is not running" << std::endl;
+            LOG_LIMITED(LogLevel::Error, 10, "Communicator is not initialized or is not running");
             throw std::runtime_error("Communicator is not initialized or is not running");
         }
         
         int r = send(this->m_BaseSocketFd, &message, sizeof(T), 0);
         if (r < 0)
         {
-            std::cerr << "Failed to send message (errno: " + std::to_string(errno) + "): " + std::string(strerror(errno)) << std::endl;
+            LOG_LIMITED(LogLevel::Error, 10, "Failed to send message (errno: {}): {}", errno, strerror(errno));
+        }
+    }
+
+    // Sends the message with a duplicate of fd attached (SCM_RIGHTS). The caller keeps fd.
+    void Send(const T& message, int fd)
+    {
+        if (!this->m_Running)
+        {
+            LOG_LIMITED(LogLevel::Error, 10, "Communicator is not initialized or is not running");
+            throw std::runtime_error("Communicator is not initialized or is not running");
+        }
+
+        alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int))] = {};
+        iovec iov { const_cast<T*>(&message), sizeof(T) };
+        msghdr header {};
+        header.msg_iov = &iov;
+        header.msg_iovlen = 1;
+        header.msg_control = control;
+        header.msg_controllen = sizeof(control);
+
+        cmsghdr* pControl = CMSG_FIRSTHDR(&header);
+        pControl->cmsg_level = SOL_SOCKET;
+        pControl->cmsg_type = SCM_RIGHTS;
+        pControl->cmsg_len = CMSG_LEN(sizeof(int));
+        memcpy(CMSG_DATA(pControl), &fd, sizeof(int));
+
+        int r = sendmsg(this->m_BaseSocketFd, &header, 0);
+        if (r < 0)
+        {
+            LOG_LIMITED(LogLevel::Error, 10, "Failed to send message (errno: {}): {}", errno, strerror(errno));
         }
     }
 
@@ -123,7 +152,7 @@ private:
                         }
                         else
                         {
-                            std::cerr << "recv() Failed (errno: " + std::to_string(errno) + "): " + std::string(strerror(errno)) << std::endl;
+                            LOG_LIMITED(LogLevel::Error, 10, "recv() Failed (errno: {}): {}", errno, strerror(errno));
                             epoll_ctl(this->m_epollFd, EPOLL_CTL_DEL, event.data.fd, nullptr);
                             this->m_ConnectionCount--;
                             this->m_Running = false;
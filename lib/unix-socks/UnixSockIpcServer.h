@@ -1,6 +1,5 @@
 #pragma once
 
-#include <iostream>
 
 #include "UnixSockIpcBase.h"
 
@@ -8,6 +7,10 @@
 struct UnixSockIpcContext final
 {
     int socket;
+
+    // Descriptor the client attached to the message being handled (SCM_RIGHTS), or -1. The
+    // handler owns it and must close it if it does not keep it.
+    int receivedFd { -1 };
 };
 
 template <typename T>
@@ -34,14 +37,14 @@ public:
         if(bind(this->m_BaseSocketFd, (const sockaddr*)(&(this->m_AddrStruct)), sizeof(this->m_AddrStruct)) < 0)
         {
             close(this->m_BaseSocketFd);
-            std::cerr << "Failed to bind socket (errno: " + std::to_string(errno) + "): " + std::string(strerror(errno)) << std::endl;
+            LOG_ERROR("Failed to bind socket (errno: {}): {}", errno, strerror(errno));
             throw std::runtime_error("Failed to bind socket (errno: " + std::to_string(errno) + "): " + std::string(strerror(errno)));
         }
 
         if (listen(this->m_BaseSocketFd, 16) < 0)
         {
             close(this->m_BaseSocketFd);
-            std::cerr << "Failed to listen on socket (errno: " + std::to_string(errno) + "): " + std::string(strerror(errno)) << std::endl;
+            LOG_ERROR("Failed to listen on socket (errno: {}): {}", errno, strerror(errno));
             throw std::runtime_error("Failed to listen on socket (errno: " + std::to_string(errno) + "): " + std::string(strerror(errno)));
         }
 
@@ -49,7 +52,7 @@ public:
         if (this->m_epollFd < 0)
         {
             close(this->m_BaseSocketFd);
-            std::cerr << "Failed to create epoll instance (errno: " + std::to_string(errno) + "): " + std::string(strerror(errno)) << std::endl;
+            LOG_ERROR("Failed to create epoll instance (errno: {}): {}", errno, strerror(errno));
             throw std::runtime_error("Failed to create epoll instance (errno: " + std::to_string(errno) + "): " + std::string(strerror(errno)));
         }
 
@@ -59,7 +62,7 @@ public:
         if (epoll_ctl(this->m_epollFd, EPOLL_CTL_ADD, this->m_BaseSocketFd, &(this->ePollEvent)) < 0)
         {
             close(this->m_BaseSocketFd);
-            std::cerr << "Failed to add server socket to epoll instance (errno: " + std::to_string(errno) + "): " + std::string(strerror(errno)) << std::endl;
+            LOG_ERROR("Failed to add server socket to epoll instance (errno: {}): {}", errno, strerror(errno));
             throw std::runtime_error("Failed to add server socket to epoll instance (errno: " + std::to_string(errno) + "): " + std::string(strerror(errno)));
         }
 
@@ -77,7 +80,7 @@ public:
         int r = send(context.socket, &message, sizeof(T), 0);
         if (r < 0)
         {
-            std::cerr << "Failed to send message (errno: " + std::to_string(errno) + "): " + std::string(strerror(errno)) << std::endl;
+            LOG_LIMITED(LogLevel::Error, 10, "Failed to send message (errno: {}): {}", errno, strerror(errno));
         }
     }
 
@@ -126,10 +129,12 @@ private:
                 else if (events[i].events & EPOLLIN)
                 {
                     totalRead = 0;
+                    int receivedFd = -1;
+                    bool failed = false;
 
                     while ((totalRead < BUFFER_SIZE) && this->m_Running)
                     {
-                        bytesRead = recv(events[i].data.fd, buffer + totalRead, BUFFER_SIZE - totalRead, MSG_DONTWAIT);
+                        bytesRead = ReceiveWithDescriptor(events[i].data.fd, buffer + totalRead, BUFFER_SIZE - totalRead, receivedFd);
                         if (bytesRead < 0)
                         {
                             if (errno == EAGAIN || errno == EWOULDBLOCK)
@@ -138,19 +143,41 @@ private:
                             }
                             else
                             {
-                                std::cerr << "recv() Failed (errno: " + std::to_string(errno) + "): " + std::string(strerror(errno)) << std::endl;
+                                LOG_LIMITED(LogLevel::Error, 10, "recv() Failed (errno: {}): {}", errno, strerror(errno));
                                 epoll_ctl(this->m_epollFd, EPOLL_CTL_DEL, events[i].data.fd, nullptr);
                                 close(events[i].data.fd);
                                 this->m_ConnectionCount--;
 
+                                failed = true;
                                 break;
                             }
                         }
 
+                        // The client closed the connection part way through a message
+                        if (bytesRead == 0)
+                        {
+                            epoll_ctl(this->m_epollFd, EPOLL_CTL_DEL, events[i].data.fd, nullptr);
+                            close(events[i].data.fd);
+                            this->m_ConnectionCount--;
+
+                            failed = true;
+                            break;
+                        }
+
                         totalRead += bytesRead;
                     }
 
-                    m_Handler({events[i].data.fd}, *reinterpret_cast<T*>(buffer));
+                    // A partial message of a connection that failed is not handled
+                    if (failed || totalRead < BUFFER_SIZE)
+                    {
+                        if (receivedFd >= 0)
+                        {
+                            close(receivedFd);
+                        }
+                        continue;
+                    }
+
+                    m_Handler({events[i].data.fd, receivedFd}, *reinterpret_cast<T*>(buffer));
                 }
             }
         }
@@ -168,5 +195,36 @@ private:
         }
     }
 
+    // recv() that also picks up a descriptor sent along with the bytes read
+    static ssize_t ReceiveWithDescriptor(int socket, char* pBuffer, size_t size, int& receivedFd)
+    {
+        alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int))];
+        iovec iov { pBuffer, size };
+        msghdr header {};
+        header.msg_iov = &iov;
+        header.msg_iovlen = 1;
+        header.msg_control = control;
+        header.msg_controllen = sizeof(control);
+
+        ssize_t bytesRead = recvmsg(socket, &header, MSG_DONTWAIT | MSG_CMSG_CLOEXEC);
+        if (bytesRead <= 0)
+        {
+            return bytesRead;
+        }
+
+        for (cmsghdr* pControl = CMSG_FIRSTHDR(&header); pControl != nullptr; pControl = CMSG_NXTHDR(&header, pControl))
+        {
+            if (pControl->cmsg_level == SOL_SOCKET && pControl->cmsg_type == SCM_RIGHTS)
+            {
+                if (receivedFd >= 0)
+                {
+                    close(receivedFd);
+                }
+                memcpy(&receivedFd, CMSG_DATA(pControl), sizeof(int));
+            }
+        }
+        return bytesRead;
+    }
+
     ServerMessageHandler<T> m_Handler;
 };
\ No newline at end of file
@@ -0,0 +1,75 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+
+#include "futex/EventCount.h"
+
+TEST(EventCountTestSuite, NotifyWithoutWaitersSkipsWake)
+{
+    EventCount eventCount {};
+
+    eventCount.Notify();
+
+    // Nobody was registered, so the epoch was not bumped and no wake syscall was made
+    ASSERT_EQ(eventCount.epoch.load(), 0);
+    ASSERT_EQ(eventCount.waiters.load(), 0);
+}
+
+TEST(EventCountTestSuite, AwaitTimesOut)
+{
+    EventCount eventCount {};
+
+    auto start = std::chrono::steady_clock::now();
+    bool success = eventCount.Await([]() { return false; }, std::chrono::milliseconds(20), 16);
+    auto elapsed = std::chrono::steady_clock::now() - start;
+
+    ASSERT_FALSE(success);
+    ASSERT_GE(elapsed, std::chrono::milliseconds(20));
+    ASSERT_EQ(eventCount.waiters.load(), 0);
+}
+
+TEST(EventCountTestSuite, AwaitWakesOnNotify)
+{
+    EventCount eventCount {};
+    std::atomic<bool> flag { false };
+
+    std::thread notifier([&]()
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        flag.store(true, std::memory_order_release);
+        eventCount.Notify();
+    });
+
+    bool success = eventCount.Await([&]() { return flag.load(std::memory_order_acquire); }, std::chrono::seconds(10), 16);
+    notifier.join();
+
+    ASSERT_TRUE(success);
+    ASSERT_EQ(eventCount.waiters.load(), 0);
+}
+
+TEST(EventCountTestSuite, NoLostWakeups)
+{
+    constexpr uint32_t ROUNDS = 2000;
+    EventCount eventCount {};
+    std::atomic<uint32_t> published { 0 };
+
+    // Every round the waiter waits for the next value without spinning, so a lost wakeup would
+    // leave it asleep until the timeout
+    std::thread waiter([&]()
+    {
+        for (uint32_t round = 1; round <= ROUNDS; round++)
+        {
+            ASSERT_TRUE(eventCount.Await([&]() { return published.load(std::memory_order_acquire) >= round; }, std::chrono::seconds(10), 0));
+        }
+    });
+
+    for (uint32_t round = 1; round <= ROUNDS; round++)
+    {
+        published.store(round, std::memory_order_release);
+        eventCount.Notify();
+    }
+
+    waiter.join();
+}
@@ -122,11 +122,11 @@ TEST(FutexTestSuite, TwoProcesses)
     if (pid == 0)
     {
         // Child process - Signaler
-        std::unique_ptr<FutexSignaller> pFutex;
-        pFutex = std::make_unique<FutexSignaller>(uniqueId, FutexSignaller::Role::Waker, "");
-
         // Wait for the waiter to create the futex
         std::this_thread::sleep_for(std::chrono::milliseconds(10));
+
+        std::unique_ptr<FutexSignaller> pFutex;
+        pFutex = std::make_unique<FutexSignaller>(uniqueId, FutexSignaller::Role::Waker, "");
         pFutexSignalledFlag->store(true, std::memory_order_relaxed);
         pFutex->Wake();
 
@@ -145,4 +145,107 @@ TEST(FutexTestSuite, TwoProcesses)
         pFutexSignalledFlag->store(false, std::memory_order_relaxed);
         munmap(ptr, sizeof(bool));
     }
-}
\ No newline at end of file
+}
+
+static const FutexSignaller::WaitPolicy ALL_WAIT_POLICIES[] =
+{
+    FutexSignaller::WaitPolicy::Futex,
+    FutexSignaller::WaitPolicy::Spin,
+    FutexSignaller::WaitPolicy::SpinThenYield,
+    FutexSignaller::WaitPolicy::Hybrid
+};
+
+TEST(FutexTestSuite, ParseWaitPolicy)
+{
+    for (FutexSignaller::WaitPolicy policy : ALL_WAIT_POLICIES)
+    {
+        FutexSignaller::WaitPolicy parsed;
+        ASSERT_TRUE(FutexSignaller::ParseWaitPolicy(FutexSignaller::WaitPolicyToString(policy), parsed));
+        EXPECT_EQ(parsed, policy);
+    }
+
+    FutexSignaller::WaitPolicy parsed;
+    EXPECT_FALSE(FutexSignaller::ParseWaitPolicy("busy", parsed));
+}
+
+TEST(FutexTestSuite, WakeBeforeWait)
+{
+    uint32_t uniqueId = getpid();
+
+    for (FutexSignaller::WaitPolicy policy : ALL_WAIT_POLICIES)
+    {
+        FutexSignaller waiter(uniqueId, FutexSignaller::Role::Waiter, "", policy);
+        FutexSignaller waker(uniqueId, FutexSignaller::Role::Waker, "");
+
+        waker.Wake();
+        EXPECT_FALSE(waiter.IsWaiting());
+        waiter.Wait();
+        EXPECT_TRUE(waiter.IsWaiting());
+    }
+}
+
+// A waiter blocked in the kernel leaves a mark in the futex word for Wake to find
+TEST(FutexTestSuite, FutexPolicyMarksSleeping)
+{
+    uint32_t uniqueId = getpid();
+    FutexSignaller waiter(uniqueId, FutexSignaller::Role::Waiter, "", FutexSignaller::WaitPolicy::Futex);
+    FutexSignaller waker(uniqueId, FutexSignaller::Role::Waker, "");
+
+    std::thread tWait([&waiter]() { waiter.Wait(); });
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+    EXPECT_EQ(waker.m_RawPointer->load(), 2u);
+    waker.Wake();
+    tWait.join();
+    EXPECT_EQ(waker.m_RawPointer->load(), 0u);
+}
+
+// A spinning waiter never asks to be woken, so Wake does not need the syscall
+TEST(FutexTestSuite, SpinPolicyNeverSleeps)
+{
+    uint32_t uniqueId = getpid();
+    FutexSignaller waiter(uniqueId, FutexSignaller::Role::Waiter, "", FutexSignaller::WaitPolicy::Spin);
+    FutexSignaller waker(uniqueId, FutexSignaller::Role::Waker, "");
+
+    std::thread tWait([&waiter]() { waiter.Wait(); });
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+    EXPECT_EQ(waker.m_RawPointer->load(), 0u);
+    waker.Wake();
+    tWait.join();
+    EXPECT_EQ(waker.m_RawPointer->load(), 0u);
+}
+
+// Two signallers bounce a counter back and forth under every policy without losing a wakeup
+TEST(FutexTestSuite, PingPongAllPolicies)
+{
+    constexpr uint32_t ROUND_TRIPS = 100;
+    uint32_t uniqueId = getpid();
+
+    for (FutexSignaller::WaitPolicy policy : ALL_WAIT_POLICIES)
+    {
+        FutexSignaller pingWaiter(uniqueId, FutexSignaller::Role::Waiter, "_ping", policy);
+        FutexSignaller pongWaiter(uniqueId, FutexSignaller::Role::Waiter, "_pong", policy);
+        FutexSignaller pingWaker(uniqueId, FutexSignaller::Role::Waker, "_ping");
+        FutexSignaller pongWaker(uniqueId, FutexSignaller::Role::Waker, "_pong");
+        uint32_t counter = 0;
+
+        std::thread tPong([&]()
+        {
+            for (uint32_t i = 0; i < ROUND_TRIPS; i++)
+            {
+                pingWaiter.Wait();
+                counter++;
+                pongWaker.Wake();
+            }
+        });
+
+        for (uint32_t i = 0; i < ROUND_TRIPS; i++)
+        {
+            pingWaker.Wake();
+            pongWaiter.Wait();
+            EXPECT_EQ(counter, i + 1) << FutexSignaller::WaitPolicyToString(policy);
+        }
+        tPong.join();
+    }
+}
@@ -0,0 +1,123 @@
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <vector>
+
+#include "bitmap/HierarchicalBitmap.h"
+
+TEST(HierarchicalBitmapTestSuite, InitiallyEmpty)
+{
+    HierarchicalBitmap<4096> bitmap;
+
+    EXPECT_TRUE(bitmap.Empty());
+    EXPECT_EQ(bitmap.Count(), 0);
+    EXPECT_EQ(bitmap.FindFirstClear(), 0);
+
+    for (uint32_t i = 0; i < 4096; i++)
+    {
+        ASSERT_FALSE(bitmap.Test(i));
+    }
+}
+
+TEST(HierarchicalBitmapTestSuite, SetAndClear)
+{
+    HierarchicalBitmap<4096> bitmap;
+
+    bitmap.Set(0);
+    bitmap.Set(63);
+    bitmap.Set(64);
+    bitmap.Set(4095);
+
+    EXPECT_FALSE(bitmap.Empty());
+    EXPECT_EQ(bitmap.Count(), 4);
+    EXPECT_TRUE(bitmap.Test(0));
+    EXPECT_TRUE(bitmap.Test(63));
+    EXPECT_TRUE(bitmap.Test(64));
+    EXPECT_TRUE(bitmap.Test(4095));
+    EXPECT_FALSE(bitmap.Test(1));
+
+    bitmap.Clear(63);
+    bitmap.Clear(0);
+    EXPECT_EQ(bitmap.Count(), 2);
+    EXPECT_FALSE(bitmap.Test(0));
+    EXPECT_FALSE(bitmap.Test(63));
+
+    bitmap.Clear(64);
+    bitmap.Clear(4095);
+    EXPECT_TRUE(bitmap.Empty());
+}
+
+TEST(HierarchicalBitmapTestSuite, ForEachSetVisitsInOrder)
+{
+    HierarchicalBitmap<4096> bitmap;
+    std::vector<uint32_t> expected = { 3, 64, 65, 700, 2048, 4000, 4095 };
+
+    for (auto it = expected.rbegin(); it != expected.rend(); ++it)
+    {
+        bitmap.Set(*it);
+    }
+
+    std::vector<uint32_t> visited;
+    bitmap.ForEachSet([&](uint32_t index)
+    {
+        visited.push_back(index);
+    });
+
+    EXPECT_EQ(visited, expected);
+}
+
+TEST(HierarchicalBitmapTestSuite, ForEachSetAllowsClearing)
+{
+    HierarchicalBitmap<256> bitmap;
+
+    for (uint32_t i = 0; i < 256; i += 3)
+    {
+        bitmap.Set(i);
+    }
+
+    uint32_t visitedCount = 0;
+    bitmap.ForEachSet([&](uint32_t index)
+    {
+        visitedCount++;
+        bitmap.Clear(index);
+    });
+
+    EXPECT_EQ(visitedCount, 86);
+    EXPECT_TRUE(bitmap.Empty());
+}
+
+TEST(HierarchicalBitmapTestSuite, FindFirstClear)
+{
+    HierarchicalBitmap<128> bitmap;
+
+    for (uint32_t i = 0; i < 128; i++)
+    {
+        ASSERT_EQ(bitmap.FindFirstClear(), i);
+        bitmap.Set(i);
+    }
+
+    EXPECT_EQ(bitmap.FindFirstClear(), HierarchicalBitmap<128>::NOT_FOUND);
+
+    bitmap.Clear(77);
+    EXPECT_EQ(bitmap.FindFirstClear(), 77);
+}
+
+TEST(HierarchicalBitmapTestSuite, OrWordAndMask)
+{
+    HierarchicalBitmap<256> bitmap;
+    HierarchicalBitmap<256> mask;
+
+    bitmap.OrWord(1, 0xF0F0ULL);
+    bitmap.OrWord(3, 0x1ULL);
+    EXPECT_EQ(bitmap.Count(), 9);
+    EXPECT_TRUE(bitmap.Test(64 + 4));
+
+    mask.Set(64 + 4);
+    mask.Set(64 + 12);
+    bitmap.AndWith(mask);
+
+    EXPECT_EQ(bitmap.Count(), 2);
+    EXPECT_TRUE(bitmap.Test(64 + 4));
+    EXPECT_TRUE(bitmap.Test(64 + 12));
+    EXPECT_FALSE(bitmap.Test(192));
+    EXPECT_EQ(bitmap.GetWord(3), 0);
+}
@@ -0,0 +1,113 @@
+#include <cstdint>
+#include <gtest/gtest.h>
+#include <limits>
+#include <random>
+
+#include "stats/LatencyHistogram.h"
+
+TEST(LatencyHistogramTestSuite, Empty)
+{
+    LatencyHistogram histogram;
+    EXPECT_EQ(histogram.GetCount(), 0u);
+    EXPECT_EQ(histogram.GetMinNs(), 0u);
+    EXPECT_EQ(histogram.GetMaxNs(), 0u);
+    EXPECT_EQ(histogram.GetMeanNs(), 0u);
+    EXPECT_EQ(histogram.GetPercentileNs(50.0), 0u);
+}
+
+TEST(LatencyHistogramTestSuite, SmallValuesAreExact)
+{
+    LatencyHistogram histogram;
+    for (uint64_t value = 1; value <= LatencyHistogram::SUB_BUCKET_COUNT; value++)
+    {
+        histogram.Record(value);
+    }
+
+    EXPECT_EQ(histogram.GetMinNs(), 1u);
+    EXPECT_EQ(histogram.GetMaxNs(), LatencyHistogram::SUB_BUCKET_COUNT);
+    EXPECT_EQ(histogram.GetPercentileNs(50.0), LatencyHistogram::SUB_BUCKET_COUNT / 2);
+    EXPECT_EQ(histogram.GetPercentileNs(100.0), LatencyHistogram::SUB_BUCKET_COUNT);
+}
+
+// Every value falls into a bucket whose upper bound is within the advertised relative error
+TEST(LatencyHistogramTestSuite, BucketBounds)
+{
+    std::mt19937_64 generator(42);
+    for (int i = 0; i < 100000; i++)
+    {
+        uint64_t value = generator() >> (generator() % 64);
+        if (value >= (1ULL << LatencyHistogram::MAX_VALUE_BITS))
+        {
+            continue;
+        }
+
+        uint32_t bucket = LatencyHistogram::BucketIndex(value);
+        ASSERT_LT(bucket, LatencyHistogram::BUCKET_COUNT);
+
+        uint64_t upperBound = LatencyHistogram::BucketUpperBound(bucket);
+        ASSERT_GE(upperBound, value);
+        ASSERT_LE(upperBound - value, value / LatencyHistogram::SUB_BUCKET_COUNT);
+        if (bucket > 0)
+        {
+            ASSERT_LT(LatencyHistogram::BucketUpperBound(bucket - 1), value);
+        }
+    }
+}
+
+TEST(LatencyHistogramTestSuite, HugeValuesClamped)
+{
+    LatencyHistogram histogram;
+    histogram.Record(std::numeric_limits<uint64_t>::max());
+    EXPECT_EQ(LatencyHistogram::BucketIndex(std::numeric_limits<uint64_t>::max()), LatencyHistogram::BUCKET_COUNT - 1);
+    EXPECT_EQ(histogram.GetPercentileNs(99.0), std::numeric_limits<uint64_t>::max());
+}
+
+TEST(LatencyHistogramTestSuite, Percentiles)
+{
+    LatencyHistogram histogram;
+    for (uint64_t value = 1; value <= 100000; value++)
+    {
+        histogram.Record(value * 1000);
+    }
+
+    EXPECT_EQ(histogram.GetCount(), 100000u);
+    EXPECT_EQ(histogram.GetMeanNs(), 50000500u);
+    EXPECT_EQ(histogram.GetMaxNs(), 100000000u);
+
+    auto expectNear = [&](double percentile, double expected)
+    {
+        double reported = static_cast<double>(histogram.GetPercentileNs(percentile));
+        EXPECT_GE(reported, expected * 0.99) << percentile;
+        EXPECT_LE(reported, expected * (1.0 + 1.0 / LatencyHistogram::SUB_BUCKET_COUNT)) << percentile;
+    };
+    expectNear(50.0, 50000000.0);
+    expectNear(99.0, 99000000.0);
+    expectNear(99.9, 99900000.0);
+    EXPECT_EQ(histogram.GetPercentileNs(100.0), 100000000u);
+}
+
+TEST(LatencyHistogramTestSuite, MergeMatchesCombined)
+{
+    LatencyHistogram first;
+    LatencyHistogram second;
+    LatencyHistogram combined;
+
+    std::mt19937_64 generator(7);
+    std::lognormal_distribution<double> distribution(10.0, 1.5);
+    for (int i = 0; i < 20000; i++)
+    {
+        uint64_t value = static_cast<uint64_t>(distribution(generator));
+        ((i % 3 == 0) ? first : second).Record(value);
+        combined.Record(value);
+    }
+
+    first.Merge(second);
+    EXPECT_EQ(first.GetCount(), combined.GetCount());
+    EXPECT_EQ(first.GetMinNs(), combined.GetMinNs());
+    EXPECT_EQ(first.GetMaxNs(), combined.GetMaxNs());
+    EXPECT_EQ(first.GetMeanNs(), combined.GetMeanNs());
+    for (double percentile : { 1.0, 50.0, 90.0, 99.0, 99.9 })
+    {
+        EXPECT_EQ(first.GetPercentileNs(percentile), combined.GetPercentileNs(percentile)) << percentile;
+    }
+}
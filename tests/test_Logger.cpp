@@ -0,0 +1,243 @@
+#include <gtest/gtest.h>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <fcntl.h>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include "log/Logger.h"
+
+// Sends the background thread's output to a file for the duration of a test
+class LoggerOutputFile
+{
+public:
+    explicit LoggerOutputFile(const std::string& name) :
+        m_Path("/tmp/test_logger_" + std::to_string(getpid()) + "_" + name + ".log")
+    {
+        m_Fd = open(m_Path.c_str(), O_CREAT | O_TRUNC | O_WRONLY, 0644);
+        Logger::SetOutput(m_Fd);
+    }
+
+    ~LoggerOutputFile()
+    {
+        Logger::Flush();
+        Logger::SetOutput(STDERR_FILENO);
+        close(m_Fd);
+        unlink(m_Path.c_str());
+    }
+
+    std::vector<std::string> ReadLines() const
+    {
+        std::ifstream file(m_Path);
+        std::vector<std::string> lines;
+        for (std::string line; std::getline(file, line);)
+        {
+            lines.push_back(line);
+        }
+        return lines;
+    }
+
+    // Lines without their time and level prefix
+    std::vector<std::string> ReadMessages() const
+    {
+        std::vector<std::string> messages;
+        for (const std::string& line : ReadLines())
+        {
+            size_t levelEnd = line.find("] ", line.find("] [") + 3);
+            messages.push_back(levelEnd == std::string::npos ? line : line.substr(levelEnd + 2));
+        }
+        return messages;
+    }
+
+private:
+    std::string m_Path;
+    int m_Fd;
+};
+
+TEST(LoggerTestSuite, Levels)
+{
+    LogLevel level;
+    ASSERT_TRUE(Logger::ParseLevel("warning", level));
+    ASSERT_EQ(level, LogLevel::Warning);
+    ASSERT_FALSE(Logger::ParseLevel("verbose", level));
+
+    Logger::SetLevel(LogLevel::Warning);
+    ASSERT_FALSE(Logger::IsEnabled(LogLevel::Info));
+    ASSERT_TRUE(Logger::IsEnabled(LogLevel::Error));
+    Logger::SetLevel(LogLevel::Info);
+}
+
+TEST(LoggerTestSuite, FormatArguments)
+{
+    LoggerOutputFile output("format");
+    std::string text = "too many";
+    LOG_INFO("{} lanes for client {}, share {}%, {}: {} {}", 17u, -3, 72.72727, text, "left", 'x');
+    LOG_INFO("no arguments {}");
+    LOG_LIMITED(LogLevel::Error, 1, "limited {}", uint64_t(1) << 40);
+    ASSERT_TRUE(Logger::Flush());
+
+    std::vector<std::string> lines = output.ReadMessages();
+    ASSERT_EQ(lines.size(), 3);
+    EXPECT_EQ(lines[0], "17 lanes for client -3, share 72.7273%, too many: left x");
+    EXPECT_EQ(lines[1], "no arguments {}");
+    EXPECT_EQ(lines[2], "limited 1099511627776");
+
+    LogRecord record {};
+    record.format = "rejected";
+    record.level = LogLevel::Warning;
+    record.suppressedCount = 4;
+    EXPECT_EQ(Logger::FormatRecord(record), "[0.000000] [warning] rejected (4 similar messages suppressed)");
+}
+
+// Lines start with the time of their record in seconds and their level
+TEST(LoggerTestSuite, TimeAndLevelPrefix)
+{
+    TscClock::Calibrate();
+    LoggerOutputFile output("prefix");
+    uint64_t beforeNs = TscClock::TicksToNs(TscClock::Now());
+    LOG_WARNING("checked");
+    uint64_t afterNs = TscClock::TicksToNs(TscClock::Now());
+    ASSERT_TRUE(Logger::Flush());
+
+    std::vector<std::string> lines = output.ReadLines();
+    ASSERT_EQ(lines.size(), 1);
+    unsigned long long seconds, micros;
+    char level[16];
+    char message[16];
+    ASSERT_EQ(sscanf(lines[0].c_str(), "[%llu.%6llu] [%15[a-z]] %15s", &seconds, &micros, level, message), 4) << lines[0];
+    EXPECT_STREQ(level, "warning");
+    EXPECT_STREQ(message, "checked");
+
+    uint64_t lineUs = seconds * 1000000 + micros;
+    EXPECT_GE(lineUs, beforeNs / 1000);
+    EXPECT_LE(lineUs, afterNs / 1000);
+}
+
+TEST(LoggerTestSuite, LongTextIsTruncated)
+{
+    LoggerOutputFile output("truncated");
+    std::string longText(2 * LogRecord::TEXT_CAPACITY, 'a');
+    LOG_INFO("{}|{}", longText, "b");
+    ASSERT_TRUE(Logger::Flush());
+
+    std::vector<std::string> lines = output.ReadMessages();
+    ASSERT_EQ(lines.size(), 1);
+    EXPECT_EQ(lines[0], std::string(LogRecord::TEXT_CAPACITY, 'a') + "|");
+}
+
+TEST(LoggerTestSuite, DisabledLevelSkipsArguments)
+{
+    LoggerOutputFile output("disabled");
+    int evaluations = 0;
+    auto countEvaluation = [&evaluations]()
+    {
+        return ++evaluations;
+    };
+
+    LOG_DEBUG("{}", countEvaluation());
+    ASSERT_TRUE(Logger::Flush());
+    EXPECT_EQ(evaluations, 0);
+    EXPECT_TRUE(output.ReadLines().empty());
+}
+
+// Lines of several threads come out whole and in the order each thread logged them. Each
+// thread logs less than its ring holds, so nothing is dropped.
+TEST(LoggerTestSuite, ManyThreads)
+{
+    LoggerOutputFile output("threads");
+    constexpr uint32_t THREAD_COUNT = 4;
+    constexpr uint32_t LINE_COUNT = 100;
+
+    std::vector<std::thread> threads;
+    for (uint32_t threadIndex = 0; threadIndex < THREAD_COUNT; threadIndex++)
+    {
+        threads.emplace_back([threadIndex]()
+        {
+            for (uint32_t lineIndex = 0; lineIndex < LINE_COUNT; lineIndex++)
+            {
+                LOG_INFO("thread {} line {}", threadIndex, lineIndex);
+            }
+        });
+    }
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+    ASSERT_TRUE(Logger::Flush());
+
+    std::vector<uint32_t> nextLine(THREAD_COUNT, 0);
+    for (const std::string& line : output.ReadMessages())
+    {
+        uint32_t threadIndex, lineIndex;
+        ASSERT_EQ(sscanf(line.c_str(), "thread %u line %u", &threadIndex, &lineIndex), 2) << line;
+        ASSERT_LT(threadIndex, THREAD_COUNT);
+        ASSERT_EQ(lineIndex, nextLine[threadIndex]++);
+    }
+    for (uint32_t threadIndex = 0; threadIndex < THREAD_COUNT; threadIndex++)
+    {
+        ASSERT_EQ(nextLine[threadIndex], LINE_COUNT);
+    }
+}
+
+// A thread that logs faster than the output drains never blocks; the excess is dropped and
+// reported
+TEST(LoggerTestSuite, FullRingDrops)
+{
+    LoggerOutputFile output("drops");
+    uint64_t droppedBefore = Logger::GetDroppedCount();
+
+    std::thread flooder([]()
+    {
+        for (uint32_t lineIndex = 0; lineIndex < 100 * Logger::RING_CAPACITY; lineIndex++)
+        {
+            LOG_INFO("flood {}", lineIndex);
+        }
+    });
+    flooder.join();
+    ASSERT_TRUE(Logger::Flush());
+
+    uint64_t droppedCount = Logger::GetDroppedCount() - droppedBefore;
+    ASSERT_GT(droppedCount, 0);
+
+    // The report comes with the background thread's next pass over the ring
+    LOG_INFO("after flood");
+    ASSERT_TRUE(Logger::Flush());
+
+    std::vector<std::string> lines = output.ReadMessages();
+    uint64_t floodLines = 0;
+    bool reported = false;
+    for (const std::string& line : lines)
+    {
+        floodLines += (line.rfind("flood ", 0) == 0) ? 1 : 0;
+        reported = reported || line.rfind("Dropped ", 0) == 0;
+    }
+    EXPECT_EQ(floodLines + droppedCount, 100 * Logger::RING_CAPACITY);
+    EXPECT_TRUE(reported);
+}
+
+TEST(LoggerTestSuite, RateLimited)
+{
+    LoggerOutputFile output("limited");
+    for (int i = 0; i < 1000; i++)
+    {
+        LOG_LIMITED(LogLevel::Warning, 5, "rejected request {}", i);
+    }
+    ASSERT_TRUE(Logger::Flush());
+    ASSERT_EQ(output.ReadLines().size(), 5);
+
+    LogRateLimiter limiter(1);
+    uint32_t suppressedCount;
+    ASSERT_TRUE(limiter.Allow(suppressedCount));
+    ASSERT_EQ(suppressedCount, 0);
+    ASSERT_FALSE(limiter.Allow(suppressedCount));
+    ASSERT_FALSE(limiter.Allow(suppressedCount));
+
+    // The next window lets one through and reports the ones held back
+    std::this_thread::sleep_for(std::chrono::milliseconds(1100));
+    ASSERT_TRUE(limiter.Allow(suppressedCount));
+    ASSERT_EQ(suppressedCount, 2);
+}
@@ -0,0 +1,129 @@
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "perf-counters/PerfCounterGroup.h"
+#include "perf-counters/PerfCounterStats.h"
+
+static uint32_t CounterBit(PerfCounter counter)
+{
+    return 1u << static_cast<uint32_t>(counter);
+}
+
+TEST(PerfCounterGroupTestSuite, CounterNames)
+{
+    std::set<std::string> names;
+    for (uint32_t counter = 0; counter < PERF_COUNTER_COUNT; counter++)
+    {
+        names.insert(PerfCounterGroup::CounterName(static_cast<PerfCounter>(counter)));
+    }
+    ASSERT_EQ(names.size(), PERF_COUNTER_COUNT);
+    ASSERT_EQ(names.count("unknown"), 0);
+}
+
+TEST(PerfCounterGroupTestSuite, Difference)
+{
+    PerfCounterValues start;
+    start.counts[static_cast<uint32_t>(PerfCounter::Cycles)] = 100;
+    start.counts[static_cast<uint32_t>(PerfCounter::Instructions)] = 500;
+    start.availableMask = CounterBit(PerfCounter::Cycles) | CounterBit(PerfCounter::Instructions);
+
+    PerfCounterValues end = start;
+    end.counts[static_cast<uint32_t>(PerfCounter::Cycles)] = 350;
+
+    // Scaled counts may step back, which must not wrap around
+    end.counts[static_cast<uint32_t>(PerfCounter::Instructions)] = 499;
+
+    PerfCounterValues difference = PerfCounterGroup::Difference(end, start);
+    ASSERT_EQ(difference.Get(PerfCounter::Cycles), 250);
+    ASSERT_EQ(difference.Get(PerfCounter::Instructions), 0);
+    ASSERT_TRUE(difference.Has(PerfCounter::Cycles));
+    ASSERT_FALSE(difference.Has(PerfCounter::LlcMisses));
+}
+
+// Works whether or not the machine lets the test count anything: without access the group is
+// simply unavailable and says why
+TEST(PerfCounterGroupTestSuite, CountsOwnThreadOrDegrades)
+{
+    PerfCounterGroup group;
+
+    PerfCounterValues start;
+    if (!group.IsAvailable())
+    {
+        ASSERT_FALSE(group.Read(start));
+        ASSERT_EQ(group.GetAvailableMask(), 0);
+        ASSERT_FALSE(group.GetError().empty());
+        GTEST_SKIP() << "No counters available: " << group.GetError();
+    }
+
+    ASSERT_TRUE(group.Read(start));
+    ASSERT_EQ(start.availableMask, group.GetAvailableMask());
+
+    std::vector<uint64_t> buffer(1 << 20);
+    for (int pass = 0; pass < 4; pass++)
+    {
+        for (size_t i = 0; i < buffer.size(); i++)
+        {
+            buffer[i] += i * pass;
+        }
+    }
+
+    PerfCounterValues end;
+    ASSERT_TRUE(group.Read(end));
+    PerfCounterValues difference = PerfCounterGroup::Difference(end, start);
+
+    for (uint32_t counter = 0; counter < PERF_COUNTER_COUNT; counter++)
+    {
+        if (!group.IsCounterAvailable(static_cast<PerfCounter>(counter)))
+        {
+            ASSERT_EQ(difference.counts[counter], 0);
+        }
+    }
+
+    if (group.IsCounterAvailable(PerfCounter::Instructions))
+    {
+        ASSERT_GT(difference.Get(PerfCounter::Instructions), buffer.size());
+    }
+    if (group.IsCounterAvailable(PerfCounter::TaskClock))
+    {
+        ASSERT_GT(difference.Get(PerfCounter::TaskClock), 0);
+    }
+}
+
+TEST(PerfCounterGroupTestSuite, StatsPerShape)
+{
+    PerfCounterValues values;
+    values.counts[static_cast<uint32_t>(PerfCounter::Cycles)] = 2000;
+    values.counts[static_cast<uint32_t>(PerfCounter::Instructions)] = 1000;
+    values.counts[static_cast<uint32_t>(PerfCounter::TaskClock)] = 700;
+    values.availableMask = CounterBit(PerfCounter::Cycles) | CounterBit(PerfCounter::Instructions) | CounterBit(PerfCounter::TaskClock);
+
+    PerfCounterStats laneA;
+    laneA.Record(64, 128, 1024, values);
+    laneA.Record(64, 128, 1024, values);
+
+    PerfCounterStats laneB;
+    laneB.Record(128, 64, 1024, values);
+
+    PerfCounterStats merged;
+    ASSERT_TRUE(merged.Empty());
+    merged.Merge(laneA);
+    merged.Merge(laneB);
+    ASSERT_EQ(merged.GetShapes().size(), 2);
+
+    const PerfCounterStats::ShapeTotals& wide = merged.GetShapes().at(PerfCounterStats::Shape(64, 128));
+    ASSERT_EQ(wide.requests, 2);
+    ASSERT_EQ(wide.bytes, 2048);
+    ASSERT_EQ(wide.values.Get(PerfCounter::Cycles), 4000);
+
+    std::string summary = PerfCounterStats::GetShapeSummary(PerfCounterStats::Shape(64, 128), wide);
+    EXPECT_NE(summary.find("shape: 64x128"), std::string::npos);
+    EXPECT_NE(summary.find("IPC: 0.5"), std::string::npos);
+    EXPECT_NE(summary.find("onCpuTime: 700"), std::string::npos);
+
+    // Counters that were not counted are left out rather than shown as 0
+    EXPECT_EQ(summary.find("llcMisses"), std::string::npos);
+    EXPECT_EQ(summary.find("backendStalls"), std::string::npos);
+}
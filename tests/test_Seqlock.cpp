@@ -0,0 +1,148 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <cstdint>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+
+#include "shared-mem/Seqlock.h"
+#include "shared-mem/SharedMemory.h"
+
+// Every field derived from the first, so a torn copy is detected
+struct Counters
+{
+    uint64_t value;
+    uint64_t doubled;
+    uint64_t inverted;
+    uint64_t padding[5];
+};
+
+static Counters MakeCounters(uint64_t value)
+{
+    Counters counters {};
+    counters.value = value;
+    counters.doubled = 2 * value;
+    counters.inverted = ~value;
+    for (uint64_t& word : counters.padding)
+    {
+        word = value;
+    }
+    return counters;
+}
+
+static bool IsConsistent(const Counters& counters)
+{
+    if (counters.doubled != 2 * counters.value || counters.inverted != ~counters.value)
+    {
+        return false;
+    }
+    for (uint64_t word : counters.padding)
+    {
+        if (word != counters.value)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+TEST(SeqlockTestSuite, StoreAndLoad)
+{
+    Seqlock<Counters> seqlock;
+    ASSERT_EQ(seqlock.GetVersion(), 0);
+    ASSERT_EQ(seqlock.Load().value, 0);
+
+    seqlock.Store(MakeCounters(7));
+    ASSERT_EQ(seqlock.GetVersion(), 1);
+    ASSERT_EQ(seqlock.GetStored().value, 7);
+
+    Counters counters;
+    ASSERT_TRUE(seqlock.TryLoad(counters));
+    ASSERT_EQ(counters.value, 7);
+    ASSERT_TRUE(IsConsistent(counters));
+}
+
+TEST(SeqlockTestSuite, ReaderNeverSeesTornValue)
+{
+    constexpr uint64_t WRITE_COUNT = 200000;
+
+    Seqlock<Counters> seqlock;
+    seqlock.Store(MakeCounters(0));
+    std::atomic<bool> done { false };
+
+    std::thread writer([&]()
+    {
+        for (uint64_t value = 1; value <= WRITE_COUNT; value++)
+        {
+            seqlock.Store(MakeCounters(value));
+        }
+        done.store(true, std::memory_order_release);
+    });
+
+    uint64_t lastValue = 0;
+    while (!done.load(std::memory_order_acquire))
+    {
+        Counters counters = seqlock.Load();
+        ASSERT_TRUE(IsConsistent(counters));
+        ASSERT_GE(counters.value, lastValue);
+        lastValue = counters.value;
+    }
+    writer.join();
+
+    ASSERT_EQ(seqlock.Load().value, WRITE_COUNT);
+}
+
+TEST(SeqlockTestSuite, ReadOnlyObserverProcess)
+{
+    constexpr uint64_t WRITE_COUNT = 100000;
+    const std::string name = "seqlock_test_uid{" + std::to_string(getpid()) + "}";
+
+    SharedMemory ownerMemory(sizeof(Seqlock<Counters>), name, SharedMemory::Ownership::Owner, SharedMemory::BufferInitMode::Zero);
+    Seqlock<Counters>& seqlock = *new (ownerMemory.GetRawPointer()) Seqlock<Counters>();
+    seqlock.Store(MakeCounters(0));
+
+    pid_t pid = fork();
+    ASSERT_NE(pid, -1);
+
+    if (pid == 0)
+    {
+        int exitCode = 0;
+        {
+            SharedMemory observerMemory(sizeof(Seqlock<Counters>), name, SharedMemory::Ownership::Observer, SharedMemory::BufferInitMode::NoInit);
+            const Seqlock<Counters>& observed = *static_cast<const Seqlock<Counters>*>(observerMemory.GetRawPointer());
+
+            uint64_t lastValue = 0;
+            while (lastValue < WRITE_COUNT)
+            {
+                Counters counters = observed.Load();
+                if (!IsConsistent(counters) || counters.value < lastValue)
+                {
+                    exitCode = 1;
+                    break;
+                }
+                lastValue = counters.value;
+            }
+        }
+        _exit(exitCode);
+    }
+
+    for (uint64_t value = 1; value <= WRITE_COUNT; value++)
+    {
+        seqlock.Store(MakeCounters(value));
+    }
+
+    int status;
+    waitpid(pid, &status, 0);
+    ASSERT_TRUE(WIFEXITED(status));
+    ASSERT_EQ(WEXITSTATUS(status), 0);
+}
+
+TEST(SeqlockTestSuite, ObserverNeedsExistingObject)
+{
+    const std::string name = "seqlock_missing_uid{" + std::to_string(getpid()) + "}";
+    EXPECT_THROW(SharedMemory(64, name, SharedMemory::Ownership::Observer, SharedMemory::BufferInitMode::NoInit), std::runtime_error);
+
+    // Larger than the object
+    SharedMemory ownerMemory(64, name, SharedMemory::Ownership::Owner, SharedMemory::BufferInitMode::Zero);
+    EXPECT_THROW(SharedMemory(4096 * 4, name, SharedMemory::Ownership::Observer, SharedMemory::BufferInitMode::NoInit), std::runtime_error);
+}
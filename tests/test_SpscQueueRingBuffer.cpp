@@ -1,4 +1,5 @@
 #include <gtest/gtest.h>
+#include <algorithm>
 #include <memory>
 #include <thread>
 #include <sys/wait.h>
@@ -16,7 +17,7 @@ TEST(SpscQueueRingBufferTestSuite, SingleProcess)
     constexpr size_t CAPACITY = 1024*1024;
     size_t realCapacity;
 
-    SpscQueueRingBuffer queue(getpid(), SpscQueueRingBuffer::Role::Producer, CAPACITY, "");
+    SpscQueueRingBuffer<uint32_t> queue(getpid(), SpscQueueRingBuffer<uint32_t>::Role::Producer, CAPACITY, "");
     realCapacity = queue.GetRealCapacity();
 
     for (int i = 0; i < realCapacity; i++)
@@ -43,7 +44,7 @@ TEST(SpscQueueRingBufferTestSuite, TwoProcesses)
     size_t realCapacity;
 
     uint32_t producerPid = getpid();
-    SpscQueueRingBuffer queue(producerPid, SpscQueueRingBuffer::Role::Producer, CAPACITY, "");
+    SpscQueueRingBuffer<uint32_t> queue(producerPid, SpscQueueRingBuffer<uint32_t>::Role::Producer, CAPACITY, "");
     realCapacity = queue.GetRealCapacity();
 
     pid_t pid = fork();
@@ -53,7 +54,7 @@ TEST(SpscQueueRingBufferTestSuite, TwoProcesses)
     }
     else if (pid == 0)
     {
-        SpscQueueRingBuffer queue(producerPid, SpscQueueRingBuffer::Role::Consumer, CAPACITY, "");
+        SpscQueueRingBuffer<uint32_t> queue(producerPid, SpscQueueRingBuffer<uint32_t>::Role::Consumer, CAPACITY, "");
 
         int received = 0;
         uint32_t item;
@@ -88,7 +89,7 @@ TEST(SpscQueueRingBufferTestSuite, TestQueueFull)
     constexpr size_t CAPACITY = 1024*1024;
     size_t realCapacity;
 
-    SpscQueueRingBuffer queue(getpid(), SpscQueueRingBuffer::Role::Producer, CAPACITY, "");
+    SpscQueueRingBuffer<uint32_t> queue(getpid(), SpscQueueRingBuffer<uint32_t>::Role::Producer, CAPACITY, "");
     realCapacity = queue.GetRealCapacity();
 
     for (int i = 0; i < realCapacity; i++)
@@ -102,7 +103,7 @@ TEST(SpscQueueRingBufferTestSuite, TestQueueFull)
 TEST(SpscQueueRingBufferTestSuite, TestQueueEmpty)
 {
     constexpr size_t CAPACITY = 1024*1024;
-    SpscQueueRingBuffer queue(getpid(), SpscQueueRingBuffer::Role::Producer, CAPACITY, "");
+    SpscQueueRingBuffer<uint32_t> queue(getpid(), SpscQueueRingBuffer<uint32_t>::Role::Producer, CAPACITY, "");
 
     uint32_t item;
     ASSERT_FALSE(queue.Dequeue(item));
@@ -114,7 +115,7 @@ TEST(SpscQueueRingBufferTestSuite, TestMultipleItems)
     constexpr size_t CAPACITY = 1024*1024;
     constexpr size_t TOTAL_ITEMS = 1234;
 
-    SpscQueueRingBuffer producerQueue(producerPid, SpscQueueRingBuffer::Role::Producer, CAPACITY, "");
+    SpscQueueRingBuffer<uint32_t> producerQueue(producerPid, SpscQueueRingBuffer<uint32_t>::Role::Producer, CAPACITY, "");
 
     pid_t pid = fork();
     if (pid == -1)
@@ -123,7 +124,7 @@ TEST(SpscQueueRingBufferTestSuite, TestMultipleItems)
     }
     else if (pid == 0)
     {
-        SpscQueueRingBuffer consumerQueue(producerPid, SpscQueueRingBuffer::Role::Consumer, CAPACITY, "");
+        SpscQueueRingBuffer<uint32_t> consumerQueue(producerPid, SpscQueueRingBuffer<uint32_t>::Role::Consumer, CAPACITY, "");
 
         int received = 0;
         uint32_t item;
@@ -154,3 +155,238 @@ TEST(SpscQueueRingBufferTestSuite, TestMultipleItems)
     }
 }
 
+
+TEST(SpscQueueRingBufferTestSuite, BulkWrapsAround)
+{
+    constexpr size_t CAPACITY = 16;
+    SpscQueueRingBuffer<uint64_t> queue(getpid(), SpscQueueRingBuffer<uint64_t>::Role::Producer, CAPACITY, "");
+
+    uint64_t items[CAPACITY];
+    uint64_t received[CAPACITY];
+    uint64_t nextItem = 0;
+    uint64_t nextExpected = 0;
+
+    // Batches of 5 and 7 move head and tail across the end of the buffer several times
+    for (int round = 0; round < 20; round++)
+    {
+        for (size_t i = 0; i < 5; i++)
+        {
+            items[i] = nextItem + i;
+        }
+        ASSERT_EQ(queue.EnqueueBulk(items, 5), 5);
+        nextItem += 5;
+
+        size_t count = queue.DequeueBulk(received, 7);
+        ASSERT_EQ(count, std::min<uint64_t>(7, nextItem - nextExpected));
+        for (size_t i = 0; i < count; i++)
+        {
+            ASSERT_EQ(received[i], nextExpected++);
+        }
+    }
+
+    // Only the free slots are taken
+    for (size_t i = 0; i < CAPACITY; i++)
+    {
+        items[i] = nextItem + i;
+    }
+    size_t inQueue = nextItem - nextExpected;
+    ASSERT_EQ(queue.EnqueueBulk(items, CAPACITY), queue.GetRealCapacity() - inQueue);
+    ASSERT_EQ(queue.EnqueueBulk(items, 1), 0);
+    ASSERT_FALSE(queue.Enqueue(0));
+
+    ASSERT_EQ(queue.DequeueBulk(received, CAPACITY), queue.GetRealCapacity());
+    ASSERT_EQ(queue.DequeueBulk(received, CAPACITY), 0);
+}
+
+TEST(SpscQueueRingBufferTestSuite, BulkTwoProcesses)
+{
+    uint32_t producerPid = getpid();
+    constexpr size_t CAPACITY = 64;
+    constexpr uint32_t TOTAL_ITEMS = 100000;
+    constexpr size_t BATCH = 13;
+
+    SpscQueueRingBuffer<uint32_t> producerQueue(producerPid, SpscQueueRingBuffer<uint32_t>::Role::Producer, CAPACITY, "");
+
+    pid_t pid = fork();
+    if (pid == -1)
+    {
+        FAIL() << "Failed to fork process";
+    }
+    else if (pid == 0)
+    {
+        SpscQueueRingBuffer<uint32_t> consumerQueue(producerPid, SpscQueueRingBuffer<uint32_t>::Role::Consumer, CAPACITY, "");
+
+        uint32_t received = 0;
+        uint32_t items[BATCH];
+        while (received < TOTAL_ITEMS)
+        {
+            size_t count = consumerQueue.DequeueBulk(items, BATCH);
+            for (size_t i = 0; i < count; i++)
+            {
+                if (items[i] != received++)
+                {
+                    exit(1);
+                }
+            }
+        }
+        exit(0);
+    }
+    else
+    {
+        uint32_t sent = 0;
+        uint32_t items[BATCH];
+        while (sent < TOTAL_ITEMS)
+        {
+            size_t batch = std::min<size_t>(BATCH, TOTAL_ITEMS - sent);
+            for (size_t i = 0; i < batch; i++)
+            {
+                items[i] = sent + i;
+            }
+            sent += producerQueue.EnqueueBulk(items, batch);
+        }
+
+        int status;
+        waitpid(pid, &status, 0);
+        ASSERT_TRUE(WIFEXITED(status));
+        ASSERT_EQ(WEXITSTATUS(status), 0);
+    }
+}
+
+TEST(SpscQueueRingBufferTestSuite, BlockingDequeueTimesOut)
+{
+    SpscQueueRingBuffer<uint32_t> queue(getpid(), SpscQueueRingBuffer<uint32_t>::Role::Producer, 16, "");
+
+    uint32_t item;
+    ASSERT_FALSE(queue.Dequeue(item, std::chrono::milliseconds(10)));
+
+    ASSERT_TRUE(queue.Enqueue(7));
+    ASSERT_TRUE(queue.Dequeue(item, std::chrono::milliseconds(10)));
+    ASSERT_EQ(item, 7);
+}
+
+TEST(SpscQueueRingBufferTestSuite, BlockingEnqueueTimesOut)
+{
+    SpscQueueRingBuffer<uint32_t> queue(getpid(), SpscQueueRingBuffer<uint32_t>::Role::Producer, 16, "");
+
+    for (size_t i = 0; i < queue.GetRealCapacity(); i++)
+    {
+        ASSERT_TRUE(queue.Enqueue(i, std::chrono::milliseconds(10)));
+    }
+    ASSERT_FALSE(queue.Enqueue(0, std::chrono::milliseconds(10)));
+}
+
+TEST(SpscQueueRingBufferTestSuite, BlockingTwoProcesses)
+{
+    uint32_t producerPid = getpid();
+    constexpr size_t CAPACITY = 8;
+    constexpr uint32_t TOTAL_ITEMS = 20000;
+
+    SpscQueueRingBuffer<uint32_t> producerQueue(producerPid, SpscQueueRingBuffer<uint32_t>::Role::Producer, CAPACITY, "");
+
+    pid_t pid = fork();
+    if (pid == -1)
+    {
+        FAIL() << "Failed to fork process";
+    }
+    else if (pid == 0)
+    {
+        SpscQueueRingBuffer<uint32_t> consumerQueue(producerPid, SpscQueueRingBuffer<uint32_t>::Role::Consumer, CAPACITY, "");
+
+        // Both sides keep blocking on a small queue, so a lost wakeup shows up as a timeout
+        for (uint32_t expected = 0; expected < TOTAL_ITEMS; expected++)
+        {
+            uint32_t item;
+            if (!consumerQueue.Dequeue(item, std::chrono::seconds(10)) || item != expected)
+            {
+                exit(1);
+            }
+        }
+        exit(0);
+    }
+    else
+    {
+        for (uint32_t i = 0; i < TOTAL_ITEMS; i++)
+        {
+            ASSERT_TRUE(producerQueue.Enqueue(i, std::chrono::seconds(10)));
+        }
+
+        int status;
+        waitpid(pid, &status, 0);
+        ASSERT_TRUE(WIFEXITED(status));
+        ASSERT_EQ(WEXITSTATUS(status), 0);
+    }
+}
+
+TEST(SpscQueueRingBufferTestSuite, BlockingBulkTimesOut)
+{
+    SpscQueueRingBuffer<uint32_t> queue(getpid(), SpscQueueRingBuffer<uint32_t>::Role::Producer, 16, "");
+    uint32_t items[32] = {};
+
+    ASSERT_EQ(queue.DequeueBulk(items, 32, std::chrono::milliseconds(10)), 0);
+
+    // Takes what fits and leaves the rest
+    ASSERT_EQ(queue.EnqueueBulk(items, 32, std::chrono::milliseconds(10)), queue.GetRealCapacity());
+    ASSERT_EQ(queue.EnqueueBulk(items, 32, std::chrono::milliseconds(10)), 0);
+
+    ASSERT_EQ(queue.DequeueBulk(items, 32, std::chrono::milliseconds(10)), queue.GetRealCapacity());
+}
+
+TEST(SpscQueueRingBufferTestSuite, BlockingBulkTwoProcesses)
+{
+    uint32_t producerPid = getpid();
+    constexpr size_t CAPACITY = 16;
+    constexpr uint32_t TOTAL_ITEMS = 100000;
+    constexpr size_t BATCH = 13;
+
+    SpscQueueRingBuffer<uint32_t> producerQueue(producerPid, SpscQueueRingBuffer<uint32_t>::Role::Producer, CAPACITY, "");
+
+    pid_t pid = fork();
+    if (pid == -1)
+    {
+        FAIL() << "Failed to fork process";
+    }
+    else if (pid == 0)
+    {
+        SpscQueueRingBuffer<uint32_t> consumerQueue(producerPid, SpscQueueRingBuffer<uint32_t>::Role::Consumer, CAPACITY, "");
+
+        uint32_t received = 0;
+        uint32_t items[BATCH];
+        while (received < TOTAL_ITEMS)
+        {
+            size_t count = consumerQueue.DequeueBulk(items, BATCH, std::chrono::seconds(10));
+            if (count == 0)
+            {
+                exit(1);
+            }
+            for (size_t i = 0; i < count; i++)
+            {
+                if (items[i] != received++)
+                {
+                    exit(1);
+                }
+            }
+        }
+        exit(0);
+    }
+    else
+    {
+        uint32_t sent = 0;
+        uint32_t items[BATCH];
+        while (sent < TOTAL_ITEMS)
+        {
+            size_t batch = std::min<size_t>(BATCH, TOTAL_ITEMS - sent);
+            for (size_t i = 0; i < batch; i++)
+            {
+                items[i] = sent + i;
+            }
+            size_t count = producerQueue.EnqueueBulk(items, batch, std::chrono::seconds(10));
+            ASSERT_NE(count, 0u);
+            sent += count;
+        }
+
+        int status;
+        waitpid(pid, &status, 0);
+        ASSERT_TRUE(WIFEXITED(status));
+        ASSERT_EQ(WEXITSTATUS(status), 0);
+    }
+}
@@ -16,7 +16,7 @@ TEST(SpscQueueSeqLockTestSuite, SingleProcess)
     constexpr size_t CAPACITY = 1024*1024;
     size_t realCapacity;
 
-    SpscQueueSeqLock queue(getpid(), SpscQueueSeqLock::Role::Producer, CAPACITY, "");
+    SpscQueueSeqLock<uint32_t> queue(getpid(), SpscQueueSeqLock<uint32_t>::Role::Producer, CAPACITY, "");
     realCapacity = queue.GetRealCapacity();
 
     for (int i = 0; i < realCapacity; i++)
@@ -43,7 +43,7 @@ TEST(SpscQueueSeqLockTestSuite, TwoProcesses)
     size_t realCapacity;
 
     uint32_t producerPid = getpid();
-    SpscQueueSeqLock queue(producerPid, SpscQueueSeqLock::Role::Producer, CAPACITY, "");
+    SpscQueueSeqLock<uint32_t> queue(producerPid, SpscQueueSeqLock<uint32_t>::Role::Producer, CAPACITY, "");
     realCapacity = queue.GetRealCapacity();
 
     pid_t pid = fork();
@@ -53,7 +53,7 @@ TEST(SpscQueueSeqLockTestSuite, TwoProcesses)
     }
     else if (pid == 0)
     {
-        SpscQueueSeqLock queue(producerPid, SpscQueueSeqLock::Role::Consumer, CAPACITY, "");
+        SpscQueueSeqLock<uint32_t> queue(producerPid, SpscQueueSeqLock<uint32_t>::Role::Consumer, CAPACITY, "");
 
         int received = 0;
         uint32_t item;
@@ -88,7 +88,7 @@ TEST(SpscQueueSeqLockTestSuite, TestQueueFull)
     constexpr size_t CAPACITY = 1024*1024;
     size_t realCapacity;
 
-    SpscQueueSeqLock queue(getpid(), SpscQueueSeqLock::Role::Producer, CAPACITY, "");
+    SpscQueueSeqLock<uint32_t> queue(getpid(), SpscQueueSeqLock<uint32_t>::Role::Producer, CAPACITY, "");
     realCapacity = queue.GetRealCapacity();
 
     for (int i = 0; i < realCapacity; i++)
@@ -102,7 +102,7 @@ TEST(SpscQueueSeqLockTestSuite, TestQueueFull)
 TEST(SpscQueueSeqLockTestSuite, TestQueueEmpty)
 {
     constexpr size_t CAPACITY = 1024*1024;
-    SpscQueueSeqLock queue(getpid(), SpscQueueSeqLock::Role::Producer, CAPACITY, "");
+    SpscQueueSeqLock<uint32_t> queue(getpid(), SpscQueueSeqLock<uint32_t>::Role::Producer, CAPACITY, "");
 
     uint32_t item;
     ASSERT_FALSE(queue.Dequeue(item));
@@ -114,7 +114,7 @@ TEST(SpscQueueSeqLockTestSuite, TestMultipleItems)
     constexpr size_t CAPACITY = 1024*1024;
     constexpr size_t TOTAL_ITEMS = 1234;
 
-    SpscQueueSeqLock producerQueue(producerPid, SpscQueueSeqLock::Role::Producer, CAPACITY, "");
+    SpscQueueSeqLock<uint32_t> producerQueue(producerPid, SpscQueueSeqLock<uint32_t>::Role::Producer, CAPACITY, "");
 
     pid_t pid = fork();
     if (pid == -1)
@@ -123,7 +123,7 @@ TEST(SpscQueueSeqLockTestSuite, TestMultipleItems)
     }
     else if (pid == 0)
     {
-        SpscQueueSeqLock consumerQueue(producerPid, SpscQueueSeqLock::Role::Consumer, CAPACITY, "");
+        SpscQueueSeqLock<uint32_t> consumerQueue(producerPid, SpscQueueSeqLock<uint32_t>::Role::Consumer, CAPACITY, "");
 
         int received = 0;
         uint32_t item;
@@ -154,3 +154,68 @@ TEST(SpscQueueSeqLockTestSuite, TestMultipleItems)
     }
 }
 
+
+TEST(SpscQueueSeqLockTestSuite, BlockingDequeueTimesOut)
+{
+    SpscQueueSeqLock<uint32_t> queue(getpid(), SpscQueueSeqLock<uint32_t>::Role::Producer, 16, "");
+
+    uint32_t item;
+    ASSERT_FALSE(queue.Dequeue(item, std::chrono::milliseconds(10)));
+
+    ASSERT_TRUE(queue.Enqueue(7));
+    ASSERT_TRUE(queue.Dequeue(item, std::chrono::milliseconds(10)));
+    ASSERT_EQ(item, 7);
+}
+
+TEST(SpscQueueSeqLockTestSuite, BlockingEnqueueTimesOut)
+{
+    SpscQueueSeqLock<uint32_t> queue(getpid(), SpscQueueSeqLock<uint32_t>::Role::Producer, 16, "");
+
+    for (size_t i = 0; i < queue.GetRealCapacity(); i++)
+    {
+        ASSERT_TRUE(queue.Enqueue(i, std::chrono::milliseconds(10)));
+    }
+    ASSERT_FALSE(queue.Enqueue(0, std::chrono::milliseconds(10)));
+}
+
+TEST(SpscQueueSeqLockTestSuite, BlockingTwoProcesses)
+{
+    uint32_t producerPid = getpid();
+    constexpr size_t CAPACITY = 8;
+    constexpr uint32_t TOTAL_ITEMS = 20000;
+
+    SpscQueueSeqLock<uint32_t> producerQueue(producerPid, SpscQueueSeqLock<uint32_t>::Role::Producer, CAPACITY, "");
+
+    pid_t pid = fork();
+    if (pid == -1)
+    {
+        FAIL() << "Failed to fork process";
+    }
+    else if (pid == 0)
+    {
+        SpscQueueSeqLock<uint32_t> consumerQueue(producerPid, SpscQueueSeqLock<uint32_t>::Role::Consumer, CAPACITY, "");
+
+        // Both sides keep blocking on a small queue, so a lost wakeup shows up as a timeout
+        for (uint32_t expected = 0; expected < TOTAL_ITEMS; expected++)
+        {
+            uint32_t item;
+            if (!consumerQueue.Dequeue(item, std::chrono::seconds(10)) || item != expected)
+            {
+                exit(1);
+            }
+        }
+        exit(0);
+    }
+    else
+    {
+        for (uint32_t i = 0; i < TOTAL_ITEMS; i++)
+        {
+            ASSERT_TRUE(producerQueue.Enqueue(i, std::chrono::seconds(10)));
+        }
+
+        int status;
+        waitpid(pid, &status, 0);
+        ASSERT_TRUE(WIFEXITED(status));
+        ASSERT_EQ(WEXITSTATUS(status), 0);
+    }
+}
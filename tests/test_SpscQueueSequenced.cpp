@@ -0,0 +1,167 @@
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "spsc-queue/SpscQueueSequenced.h"
+
+// Cache line sized item, like the request descriptors the queue carries
+struct alignas(64) Descriptor
+{
+    uint64_t sequence;
+    uint64_t checksum;
+    uint8_t payload[48];
+};
+
+static Descriptor MakeDescriptor(uint64_t sequence)
+{
+    Descriptor descriptor {};
+    descriptor.sequence = sequence;
+    descriptor.checksum = ~sequence;
+    for (size_t i = 0; i < sizeof(descriptor.payload); i++)
+    {
+        descriptor.payload[i] = static_cast<uint8_t>(sequence + i);
+    }
+    return descriptor;
+}
+
+static bool IsValidDescriptor(const Descriptor& descriptor, uint64_t sequence)
+{
+    if (descriptor.sequence != sequence || descriptor.checksum != ~sequence)
+    {
+        return false;
+    }
+    for (size_t i = 0; i < sizeof(descriptor.payload); i++)
+    {
+        if (descriptor.payload[i] != static_cast<uint8_t>(sequence + i))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+TEST(SpscQueueSequencedTestSuite, SingleProcess)
+{
+    constexpr size_t CAPACITY = 1024;
+
+    SpscQueueSequenced<uint32_t> queue(getpid(), SpscQueueSequenced<uint32_t>::Role::Producer, CAPACITY, "");
+
+    // Every slot is usable
+    ASSERT_EQ(queue.GetRealCapacity(), CAPACITY);
+
+    for (int lap = 0; lap < 3; lap++)
+    {
+        for (uint32_t i = 0; i < CAPACITY; i++)
+        {
+            ASSERT_TRUE(queue.Enqueue(i));
+        }
+
+        ASSERT_FALSE(queue.Enqueue(0));
+
+        for (uint32_t i = 0; i < CAPACITY; i++)
+        {
+            uint32_t item;
+            ASSERT_TRUE(queue.Dequeue(item));
+            ASSERT_EQ(item, i);
+        }
+
+        uint32_t item;
+        ASSERT_FALSE(queue.Dequeue(item));
+    }
+}
+
+TEST(SpscQueueSequencedTestSuite, TestQueueEmpty)
+{
+    SpscQueueSequenced<uint32_t> queue(getpid(), SpscQueueSequenced<uint32_t>::Role::Producer, 16, "");
+
+    uint32_t item;
+    ASSERT_FALSE(queue.Dequeue(item));
+}
+
+TEST(SpscQueueSequencedTestSuite, ReadyCount)
+{
+    constexpr size_t CAPACITY = 8;
+
+    SpscQueueSequenced<uint32_t> queue(getpid(), SpscQueueSequenced<uint32_t>::Role::Producer, CAPACITY, "");
+    ASSERT_EQ(queue.GetReadyCount(), 0);
+
+    for (uint32_t i = 0; i < CAPACITY; i++)
+    {
+        ASSERT_TRUE(queue.Enqueue(i));
+        ASSERT_EQ(queue.GetReadyCount(), i + 1);
+    }
+
+    // Counted from the consumer position across the wrap
+    uint32_t item;
+    for (uint32_t i = 0; i < 5; i++)
+    {
+        ASSERT_TRUE(queue.Dequeue(item));
+    }
+    ASSERT_EQ(queue.GetReadyCount(), CAPACITY - 5);
+
+    ASSERT_TRUE(queue.Enqueue(100));
+    ASSERT_TRUE(queue.Enqueue(101));
+    ASSERT_EQ(queue.GetReadyCount(), CAPACITY - 3);
+
+    while (queue.Dequeue(item))
+    {
+    }
+    ASSERT_EQ(queue.GetReadyCount(), 0);
+}
+
+TEST(SpscQueueSequencedTestSuite, TestInvalidCapacity)
+{
+    EXPECT_THROW(SpscQueueSequenced<uint32_t>(getpid(), SpscQueueSequenced<uint32_t>::Role::Producer, 1, ""), std::invalid_argument);
+    EXPECT_THROW(SpscQueueSequenced<uint32_t>(getpid(), SpscQueueSequenced<uint32_t>::Role::Producer, 12, ""), std::invalid_argument);
+}
+
+TEST(SpscQueueSequencedTestSuite, TwoProcessesDescriptors)
+{
+    uint32_t producerPid = getpid();
+    constexpr size_t CAPACITY = 256;
+    constexpr uint64_t TOTAL_ITEMS = 100000;
+
+    SpscQueueSequenced<Descriptor> producerQueue(producerPid, SpscQueueSequenced<Descriptor>::Role::Producer, CAPACITY, "");
+
+    pid_t pid = fork();
+    if (pid == -1)
+    {
+        FAIL() << "Failed to fork process";
+    }
+    else if (pid == 0)
+    {
+        SpscQueueSequenced<Descriptor> consumerQueue(producerPid, SpscQueueSequenced<Descriptor>::Role::Consumer, CAPACITY, "");
+
+        // A torn or reordered descriptor fails the check
+        uint64_t received = 0;
+        Descriptor descriptor;
+        while (received < TOTAL_ITEMS)
+        {
+            if (consumerQueue.Dequeue(descriptor))
+            {
+                if (!IsValidDescriptor(descriptor, received))
+                {
+                    exit(1);
+                }
+                received++;
+            }
+        }
+        exit(0);
+    }
+    else
+    {
+        for (uint64_t i = 0; i < TOTAL_ITEMS; i++)
+        {
+            Descriptor descriptor = MakeDescriptor(i);
+            while (!producerQueue.Enqueue(descriptor))
+            {
+            }
+        }
+
+        int status;
+        waitpid(pid, &status, 0);
+        ASSERT_TRUE(WIFEXITED(status));
+        ASSERT_EQ(WEXITSTATUS(status), 0);
+    }
+}
@@ -0,0 +1,210 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <cstdint>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <unistd.h>
+
+#include "trace/TraceReader.h"
+#include "trace/Tracer.h"
+
+static std::string TracePath(const std::string& name)
+{
+    return "/tmp/test_tracer_" + std::to_string(getpid()) + "_" + name + ".trace";
+}
+
+static const TraceDump::Thread* FindThread(const TraceDump& dump, const std::string& name)
+{
+    for (const TraceDump::Thread& thread : dump.threads)
+    {
+        if (thread.name == name && !thread.events.empty())
+        {
+            return &thread;
+        }
+    }
+    return nullptr;
+}
+
+static size_t CountOccurrences(const std::string& text, const std::string& pattern)
+{
+    size_t count = 0;
+    for (size_t position = text.find(pattern); position != std::string::npos; position = text.find(pattern, position + 1))
+    {
+        count++;
+    }
+    return count;
+}
+
+TEST(TracerTestSuite, DisabledRecordsNothing)
+{
+    Tracer::SetEnabled(false);
+    uint64_t recordedBefore = Tracer::GetRecordedCount();
+    for (int i = 0; i < 100; i++)
+    {
+        Tracer::Instant(0, i);
+    }
+    ASSERT_EQ(Tracer::GetRecordedCount(), recordedBefore);
+}
+
+TEST(TracerTestSuite, DumpAndRead)
+{
+    Tracer::Clear();
+    Tracer::SetEventInfos({ { "request", "client", "tag" }, { "tiles", "firstTile", "" } });
+    Tracer::SetEnabled(true);
+
+    std::thread recorder([]()
+    {
+        Tracer::SetThreadName("recorder");
+        Tracer::Begin(0, 7, 42);
+        Tracer::Instant(1, 16);
+        Tracer::End(0);
+    });
+    recorder.join();
+    Tracer::SetEnabled(false);
+
+    std::string path = TracePath("dump");
+    ASSERT_EQ(Tracer::Dump(path), 3);
+
+    TraceDump dump = TraceReader::Read(path);
+    unlink(path.c_str());
+
+    ASSERT_EQ(dump.pid, static_cast<uint32_t>(getpid()));
+    ASSERT_GT(dump.nsPerTick, 0.0);
+    ASSERT_EQ(dump.eventInfos.size(), 2);
+    ASSERT_EQ(dump.eventInfos[1].name, "tiles");
+    ASSERT_EQ(dump.eventInfos[1].arg1Name, "");
+
+    const TraceDump::Thread* pThread = FindThread(dump, "recorder");
+    ASSERT_NE(pThread, nullptr);
+    ASSERT_EQ(pThread->events.size(), 3);
+    ASSERT_EQ(pThread->events[0].phase, TracePhase::Begin);
+    ASSERT_EQ(pThread->events[0].arg0, 7);
+    ASSERT_EQ(pThread->events[0].arg1, 42);
+    ASSERT_EQ(pThread->events[1].phase, TracePhase::Instant);
+    ASSERT_EQ(pThread->events[1].eventId, 1);
+    ASSERT_EQ(pThread->events[2].phase, TracePhase::End);
+    ASSERT_LE(pThread->events[0].ticks, pThread->events[1].ticks);
+    ASSERT_LE(pThread->events[1].ticks, pThread->events[2].ticks);
+}
+
+TEST(TracerTestSuite, RingKeepsNewestEvents)
+{
+    Tracer::Clear();
+    Tracer::SetEnabled(true);
+
+    uint64_t eventCount = Tracer::RING_CAPACITY + 1000;
+    std::thread recorder([eventCount]()
+    {
+        Tracer::SetThreadName("wrapping");
+        for (uint64_t i = 0; i < eventCount; i++)
+        {
+            Tracer::Instant(0, i);
+        }
+    });
+    recorder.join();
+    Tracer::SetEnabled(false);
+
+    std::string path = TracePath("ring");
+    Tracer::Dump(path);
+    TraceDump dump = TraceReader::Read(path);
+    unlink(path.c_str());
+
+    const TraceDump::Thread* pThread = FindThread(dump, "wrapping");
+    ASSERT_NE(pThread, nullptr);
+
+    // The slot the writer would use next counts as possibly being written
+    ASSERT_EQ(pThread->events.size(), Tracer::RING_CAPACITY - 1);
+    ASSERT_EQ(pThread->events.front().arg0, eventCount - Tracer::RING_CAPACITY + 1);
+    ASSERT_EQ(pThread->events.back().arg0, eventCount - 1);
+}
+
+// Dumping while a thread records must only return events that were completely written
+TEST(TracerTestSuite, DumpWhileRecording)
+{
+    Tracer::Clear();
+    Tracer::SetEnabled(true);
+
+    std::atomic<bool> stop { false };
+    std::thread recorder([&stop]()
+    {
+        Tracer::SetThreadName("busy");
+        for (uint64_t i = 0; !stop.load(std::memory_order_relaxed); i++)
+        {
+            Tracer::Instant(0, i, ~i);
+        }
+    });
+
+    std::string path = TracePath("busy");
+    for (int dumpIndex = 0; dumpIndex < 20; dumpIndex++)
+    {
+        Tracer::Dump(path);
+        TraceDump dump = TraceReader::Read(path);
+
+        const TraceDump::Thread* pThread = FindThread(dump, "busy");
+        if (pThread == nullptr)
+        {
+            continue;
+        }
+
+        for (size_t eventIndex = 0; eventIndex < pThread->events.size(); eventIndex++)
+        {
+            const TraceEvent& event = pThread->events[eventIndex];
+            ASSERT_EQ(event.arg1, ~event.arg0);
+            if (eventIndex > 0)
+            {
+                ASSERT_EQ(event.arg0, pThread->events[eventIndex - 1].arg0 + 1);
+            }
+        }
+    }
+
+    stop.store(true);
+    recorder.join();
+    Tracer::SetEnabled(false);
+    unlink(path.c_str());
+}
+
+TEST(TracerTestSuite, ChromeTrace)
+{
+    TraceDump dump;
+    dump.pid = 1234;
+    dump.processName = "server";
+    dump.nsPerTick = 0.5;
+    dump.eventInfos = { { "job", "client", "tag" }, { "wake", "", "lane" } };
+
+    TraceDump::Thread thread;
+    thread.tid = 1235;
+    thread.name = "worker 0";
+
+    // The begin of the first span was overwritten in the ring
+    thread.events.push_back(TraceEvent { 1000, 0, 0, 0, TracePhase::End, {} });
+    thread.events.push_back(TraceEvent { 3000, 5, 9, 0, TracePhase::Begin, {} });
+    thread.events.push_back(TraceEvent { 4000, 0, 2, 1, TracePhase::Instant, {} });
+    thread.events.push_back(TraceEvent { 5000, 0, 0, 0, TracePhase::End, {} });
+    dump.threads.push_back(thread);
+
+    std::ostringstream out;
+    TraceReader::WriteChromeTrace({ dump }, out);
+    std::string json = out.str();
+
+    EXPECT_NE(json.find("\"traceEvents\""), std::string::npos);
+    EXPECT_NE(json.find("{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1234,\"args\":{\"name\":\"server\"}}"), std::string::npos);
+    EXPECT_NE(json.find("\"args\":{\"name\":\"worker 0\"}"), std::string::npos);
+    EXPECT_NE(json.find("{\"name\":\"job\",\"ph\":\"B\",\"ts\":1.000,\"pid\":1234,\"tid\":1235,\"args\":{\"client\":5,\"tag\":9}}"), std::string::npos);
+    EXPECT_NE(json.find("{\"name\":\"wake\",\"ph\":\"i\",\"ts\":1.500,\"pid\":1234,\"tid\":1235,\"s\":\"t\",\"args\":{\"lane\":2}}"), std::string::npos);
+    EXPECT_EQ(CountOccurrences(json, "\"ph\":\"E\""), 1);
+}
+
+TEST(TracerTestSuite, ReadRejectsOtherFiles)
+{
+    std::string path = TracePath("other");
+    {
+        std::ofstream file(path);
+        file << "not a trace dump, but long enough to hold a header of one";
+    }
+    EXPECT_THROW(TraceReader::Read(path), std::runtime_error);
+    unlink(path.c_str());
+
+    EXPECT_THROW(TraceReader::Read(path), std::runtime_error);
+}
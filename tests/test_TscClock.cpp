@@ -0,0 +1,76 @@
+#include <chrono>
+#include <cstdint>
+#include <gtest/gtest.h>
+#include <thread>
+
+#include "stats/TscClock.h"
+
+static uint64_t SteadyNowNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+TEST(TscClockTestSuite, Monotonic)
+{
+    TscClock::Calibrate();
+
+    uint64_t previous = TscClock::Now();
+    for (int i = 0; i < 100000; i++)
+    {
+        uint64_t now = TscClock::Now();
+        ASSERT_GE(now, previous);
+        previous = now;
+    }
+}
+
+// Converted tick differences match steady_clock to well within a percent
+TEST(TscClockTestSuite, AgreesWithSteadyClock)
+{
+    TscClock::Calibrate();
+
+    uint64_t startTicks = TscClock::Now();
+    uint64_t startNs = SteadyNowNs();
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    uint64_t endTicks = TscClock::Now();
+    uint64_t endNs = SteadyNowNs();
+
+    double measuredNs = static_cast<double>(TscClock::TicksToNs(endTicks - startTicks));
+    double referenceNs = static_cast<double>(endNs - startNs);
+    EXPECT_NEAR(measuredNs, referenceNs, referenceNs * 0.01);
+}
+
+TEST(TscClockTestSuite, UsesTscOnlyIfInvariant)
+{
+    bool usesTsc = TscClock::Calibrate();
+    EXPECT_EQ(usesTsc, TscClock::UsesTsc());
+    if (usesTsc)
+    {
+        EXPECT_TRUE(TscClock::IsInvariant());
+        EXPECT_TRUE(TscClock::IsConsistentAcrossCores(1000));
+        EXPECT_GT(TscClock::GetTicksPerNs(), 0.1);
+    }
+    else
+    {
+        EXPECT_EQ(TscClock::GetTicksPerNs(), 1.0);
+    }
+}
+
+TEST(TscClockTestSuite, AdoptsModeOfOtherProcess)
+{
+    TscClock::Calibrate();
+
+    ASSERT_TRUE(TscClock::Adopt(false));
+    EXPECT_FALSE(TscClock::UsesTsc());
+    EXPECT_EQ(TscClock::GetTicksPerNs(), 1.0);
+
+    uint64_t ticks = TscClock::Now();
+    uint64_t ns = SteadyNowNs();
+    EXPECT_LE(ticks, ns);
+    EXPECT_LT(ns - ticks, 1000000u);
+
+    // Possible wherever the TSC is invariant, even if this process found it out of step
+    EXPECT_EQ(TscClock::Adopt(true), TscClock::IsInvariant());
+    EXPECT_EQ(TscClock::UsesTsc(), TscClock::IsInvariant());
+
+    TscClock::Calibrate();
+}
@@ -0,0 +1,130 @@
+#include <atomic>
+#include <chrono>
+#include <gtest/gtest.h>
+#include <memory>
+#include <string>
+#include <sys/eventfd.h>
+#include <thread>
+#include <unistd.h>
+
+#include "unix-socks/UnixSockIpcServer.h"
+#include "unix-socks/UnixSockIpcClient.h"
+
+struct __attribute__((packed)) TestMessage
+{
+    uint32_t value;
+};
+
+static std::string CreateSocketAddress()
+{
+    return "/tmp/unix_sock_ipc_test_" + std::to_string(getpid()) + ".sock";
+}
+
+template <typename Predicate>
+static bool WaitUntil(Predicate predicate)
+{
+    for (int attempt = 0; attempt < 1000 && !predicate(); attempt++)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return predicate();
+}
+
+TEST(UnixSockIpcTestSuite, MessageWithoutDescriptor)
+{
+    std::atomic<uint32_t> receivedValue { 0 };
+    std::atomic<int> receivedFd { 0 };
+
+    UnixSockIpcServer<TestMessage> server(CreateSocketAddress(), [&](UnixSockIpcContext context, const TestMessage& message)
+    {
+        receivedFd = context.receivedFd;
+        receivedValue = message.value;
+    });
+    UnixSockIpcClient<TestMessage> client(CreateSocketAddress(), [](const TestMessage&) {});
+
+    client.Send(TestMessage { 42 });
+    ASSERT_TRUE(WaitUntil([&]() { return receivedValue == 42; }));
+    EXPECT_EQ(receivedFd, -1);
+}
+
+// The server gets its own descriptor for the client's eventfd and can signal the client on it
+TEST(UnixSockIpcTestSuite, PassEventFd)
+{
+    std::atomic<uint32_t> receivedValue { 0 };
+
+    UnixSockIpcServer<TestMessage> server(CreateSocketAddress(), [&](UnixSockIpcContext context, const TestMessage& message)
+    {
+        ASSERT_GE(context.receivedFd, 0);
+        uint64_t increment = message.value;
+        EXPECT_EQ(write(context.receivedFd, &increment, sizeof(increment)), static_cast<ssize_t>(sizeof(increment)));
+        close(context.receivedFd);
+        receivedValue = message.value;
+    });
+    UnixSockIpcClient<TestMessage> client(CreateSocketAddress(), [](const TestMessage&) {});
+
+    int eventFd = eventfd(0, EFD_CLOEXEC);
+    ASSERT_GE(eventFd, 0);
+
+    client.Send(TestMessage { 7 }, eventFd);
+    ASSERT_TRUE(WaitUntil([&]() { return receivedValue == 7; }));
+
+    uint64_t counter = 0;
+    EXPECT_EQ(read(eventFd, &counter, sizeof(counter)), static_cast<ssize_t>(sizeof(counter)));
+    EXPECT_EQ(counter, 7u);
+    close(eventFd);
+}
+
+// A client that hangs up part way through a message must not get the partial message, or the
+// descriptor sent with it, handed to the handler
+TEST(UnixSockIpcTestSuite, PartialMessageIsDropped)
+{
+    struct __attribute__((packed)) LargeMessage
+    {
+        uint32_t values[4];
+    };
+
+    std::atomic<uint32_t> handledCount { 0 };
+    UnixSockIpcServer<LargeMessage> server(CreateSocketAddress(), [&](UnixSockIpcContext context, const LargeMessage&)
+    {
+        if (context.receivedFd >= 0)
+        {
+            close(context.receivedFd);
+        }
+        handledCount++;
+    });
+
+    int clientSocket = socket(AF_UNIX, SOCK_STREAM, 0);
+    ASSERT_GE(clientSocket, 0);
+    sockaddr_un address {};
+    address.sun_family = AF_UNIX;
+    strncpy(address.sun_path, CreateSocketAddress().c_str(), sizeof(address.sun_path) - 1);
+    ASSERT_EQ(connect(clientSocket, reinterpret_cast<const sockaddr*>(&address), sizeof(address)), 0);
+    ASSERT_TRUE(WaitUntil([&]() { return server.GetConnectionCount() == 1; }));
+
+    int eventFd = eventfd(0, EFD_CLOEXEC);
+    ASSERT_GE(eventFd, 0);
+
+    // Half a message with the eventfd attached, then the hang-up
+    uint32_t half[2] = { 1, 2 };
+    alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int))] = {};
+    iovec iov { half, sizeof(half) };
+    msghdr header {};
+    header.msg_iov = &iov;
+    header.msg_iovlen = 1;
+    header.msg_control = control;
+    header.msg_controllen = sizeof(control);
+    cmsghdr* pControl = CMSG_FIRSTHDR(&header);
+    pControl->cmsg_level = SOL_SOCKET;
+    pControl->cmsg_type = SCM_RIGHTS;
+    pControl->cmsg_len = CMSG_LEN(sizeof(int));
+    memcpy(CMSG_DATA(pControl), &eventFd, sizeof(int));
+    ASSERT_EQ(sendmsg(clientSocket, &header, 0), static_cast<ssize_t>(sizeof(half)));
+
+    // Lets the server start reading the message before the hang-up
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    close(clientSocket);
+
+    ASSERT_TRUE(WaitUntil([&]() { return server.GetConnectionCount() == 0; }));
+    EXPECT_EQ(handledCount, 0u);
+    close(eventFd);
+}
@@ -178,4 +178,166 @@ INSTANTIATE_TEST_SUITE_P
         ::testing::Values(32, 64, 128), // tileSize
         ::testing::Values(1, 2, 4, 8, 16, 32)  // numThreads
     )
-);
\ No newline at end of file
+);
+
+// Sizes that are no multiple of the tile size, so the last tiles are cut off at the edges
+TEST(TileMultiThreadedTest, TileMultiThreadedUnevenSizes)
+{
+    uint32_t rowCount = 100;
+    uint32_t columnCount = 37;
+
+    std::vector<uint64_t> originalMat(rowCount * columnCount);
+    std::vector<uint64_t> transposeRes(columnCount * rowCount, 0);
+    std::vector<uint64_t> refTranspose(columnCount * rowCount);
+
+    for (uint64_t i = 0; i < rowCount * columnCount; ++i)
+    {
+        originalMat[i] = i;
+    }
+
+    TransposeNaive(originalMat.data(), refTranspose.data(), rowCount, columnCount);
+    TransposeTiledMultiThreaded(originalMat.data(), transposeRes.data(), rowCount, columnCount, 32, 3);
+
+    EXPECT_TRUE(MatricesAreEqual(transposeRes.data(), refTranspose.data(), columnCount, rowCount));
+}
+
+class TileRangeTest : public ::testing::TestWithParam<std::tuple<uint32_t, uint32_t, uint32_t, uint32_t>> {};
+
+TEST_P(TileRangeTest, PartitionedTileRanges)
+{
+    uint32_t m = std::get<0>(GetParam());
+    uint32_t n = std::get<1>(GetParam());
+    uint32_t tileSize = std::get<2>(GetParam());
+    uint32_t numParts = std::get<3>(GetParam());
+
+    uint32_t rowCount = 1 << m;
+    uint32_t columnCount = 1 << n;
+
+    std::vector<uint64_t> originalMat(rowCount * columnCount);
+    std::vector<uint64_t> transposeRes(columnCount * rowCount, 0);
+    std::vector<uint64_t> refTranspose(columnCount * rowCount);
+
+    for (uint64_t i = 0; i < rowCount * columnCount; ++i)
+    {
+        originalMat[i] = i;
+    }
+
+    TransposeNaive(originalMat.data(), refTranspose.data(), rowCount, columnCount);
+
+    uint32_t tileCount = TiledTileCount(rowCount, columnCount, tileSize);
+    for (uint32_t part = 0; part < numParts; part++)
+    {
+        uint32_t firstTile = (uint64_t)tileCount * part / numParts;
+        uint32_t endTile = (uint64_t)tileCount * (part + 1) / numParts;
+        TransposeTiledTileRange(originalMat.data(), transposeRes.data(), rowCount, columnCount, tileSize, firstTile, endTile);
+    }
+
+    EXPECT_TRUE(MatricesAreEqual(transposeRes.data(), refTranspose.data(), columnCount, rowCount));
+}
+
+INSTANTIATE_TEST_SUITE_P
+(
+    TileRangeTests,
+    TileRangeTest,
+    ::testing::Combine(
+        ::testing::Values(2, 4, 10), // m
+        ::testing::Values(2, 6, 11), // n
+        ::testing::Values(16, 64), // tileSize
+        ::testing::Values(1, 3, 8)  // numParts
+    )
+);
+
+class RecursiveTest : public ::testing::TestWithParam<std::tuple<uint32_t, uint32_t>> {};
+
+TEST_P(RecursiveTest, Recursive)
+{
+    uint32_t rowCount = std::get<0>(GetParam());
+    uint32_t columnCount = std::get<1>(GetParam());
+
+    std::vector<uint64_t> originalMat(rowCount * columnCount);
+    std::vector<uint64_t> transposeRes(columnCount * rowCount, 0);
+    std::vector<uint64_t> refTranspose(columnCount * rowCount);
+
+    for (uint64_t i = 0; i < rowCount * columnCount; ++i)
+    {
+        originalMat[i] = i;
+    }
+
+    TransposeNaive(originalMat.data(), refTranspose.data(), rowCount, columnCount);
+    TransposeRecursive(originalMat.data(), transposeRes.data(), rowCount, columnCount);
+
+    EXPECT_TRUE(MatricesAreEqual(transposeRes.data(), refTranspose.data(), columnCount, rowCount));
+}
+
+INSTANTIATE_TEST_SUITE_P
+(
+    RecursiveTests,
+    RecursiveTest,
+    ::testing::Combine(
+        ::testing::Values(1, 5, 16, 37, 1024), // rowCount
+        ::testing::Values(1, 3, 16, 100, 256)  // columnCount
+    )
+);
+
+class InPlaceTest : public ::testing::TestWithParam<uint32_t> {};
+
+TEST_P(InPlaceTest, InPlace)
+{
+    uint32_t size = GetParam();
+
+    std::vector<uint64_t> naiveMat(size * size);
+    std::vector<uint64_t> refTranspose(size * size);
+
+    for (uint64_t i = 0; i < size * size; ++i)
+    {
+        naiveMat[i] = i;
+    }
+    std::vector<uint64_t> recursiveMat = naiveMat;
+
+    TransposeNaive(naiveMat.data(), refTranspose.data(), size, size);
+    TransposeNaiveInPlace(naiveMat.data(), size);
+    TransposeRecursiveInPlace(recursiveMat.data(), size);
+
+    EXPECT_TRUE(MatricesAreEqual(naiveMat.data(), refTranspose.data(), size, size));
+    EXPECT_TRUE(MatricesAreEqual(recursiveMat.data(), refTranspose.data(), size, size));
+}
+
+INSTANTIATE_TEST_SUITE_P
+(
+    InPlaceTests,
+    InPlaceTest,
+    ::testing::Values(1, 2, 16, 17, 33, 100, 1024) // size
+);
+
+class TiledInPlaceMultiThreadedTest : public ::testing::TestWithParam<std::tuple<uint32_t, uint32_t, uint32_t>> {};
+
+TEST_P(TiledInPlaceMultiThreadedTest, TiledInPlaceMultiThreaded)
+{
+    uint32_t size = std::get<0>(GetParam());
+    uint32_t tileSize = std::get<1>(GetParam());
+    uint32_t numThreads = std::get<2>(GetParam());
+
+    std::vector<uint64_t> matrix(size * size);
+    std::vector<uint64_t> refTranspose(size * size);
+
+    for (uint64_t i = 0; i < size * size; ++i)
+    {
+        matrix[i] = i;
+    }
+
+    TransposeNaive(matrix.data(), refTranspose.data(), size, size);
+    TransposeTiledInPlaceMultiThreaded(matrix.data(), size, tileSize, numThreads);
+
+    EXPECT_TRUE(MatricesAreEqual(matrix.data(), refTranspose.data(), size, size));
+}
+
+INSTANTIATE_TEST_SUITE_P
+(
+    TiledInPlaceMultiThreadedTests,
+    TiledInPlaceMultiThreadedTest,
+    ::testing::Combine(
+        ::testing::Values(1, 17, 100, 1024), // size
+        ::testing::Values(16, 64), // tileSize
+        ::testing::Values(1, 3, 8)  // numThreads
+    )
+);
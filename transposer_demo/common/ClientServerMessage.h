@@ -14,6 +14,10 @@ struct __attribute__((packed)) ClientServerMessage
         Subscribe,
         Unsubscribe,
         SubscribeResponse,
+        AddBuffers,
+        RemoveBuffers,
+        ReshapeBuffer,
+        BuffersResponse,
     };    
 
     MessageType type;
@@ -21,8 +25,12 @@ struct __attribute__((packed)) ClientServerMessage
     uint32_t param1;
     uint32_t param2;
     uint32_t param3;
+    uint32_t param4;
+    uint32_t param5;
 
-    static bool ProcessSubscribeMessage(const ClientServerMessage& message, uint32_t& clientId, uint32_t& m, uint32_t& n, uint32_t& k)
+    // The client creates the request queue, records and completion signal of each of its laneCount
+    // submission lanes before subscribing
+    static bool ProcessSubscribeMessage(const ClientServerMessage& message, uint32_t& clientId, uint32_t& m, uint32_t& n, uint32_t& k, uint32_t& weight, uint32_t& laneCount)
     {
         if (message.type != MessageType::Subscribe)
         {
@@ -33,17 +41,21 @@ struct __attribute__((packed)) ClientServerMessage
         m = message.param1;
         n = message.param2;
         k = message.param3;
+        weight = message.param4;
+        laneCount = message.param5;
 
         return true;
     }
 
-    static void GenerateSubscribeMessage(ClientServerMessage& message, const uint32_t& clientId, const uint32_t& m, const uint32_t& n, const uint32_t& k)
+    static void GenerateSubscribeMessage(ClientServerMessage& message, const uint32_t& clientId, const uint32_t& m, const uint32_t& n, const uint32_t& k, const uint32_t& weight, const uint32_t& laneCount)
     {
         message.type = MessageType::Subscribe;
         message.senderId = clientId;
         message.param1 = m;
         message.param2 = n;
         message.param3 = k;
+        message.param4 = weight;
+        message.param5 = laneCount;
     }
 
     static bool ProcessUnsubscribeMessage(const ClientServerMessage& message, uint32_t& clientId)
@@ -64,7 +76,9 @@ struct __attribute__((packed)) ClientServerMessage
         message.senderId = clientId;
     }
 
-    static bool ProcessSubscribeResponseMessage(const ClientServerMessage& message, uint32_t& serverId, uint32_t& serverSideClientId, uint32_t& serverCapacity, uint32_t& serverClientCount)
+    // serverSideClientId is the doorbell slot of the client's first lane; lane i rings the slot i after it.
+    // serverUsesTsc is the TscClock mode of the server, which the client's request timestamps must match.
+    static bool ProcessSubscribeResponseMessage(const ClientServerMessage& message, uint32_t& serverId, uint32_t& serverSideClientId, uint32_t& serverCapacity, uint32_t& serverClientCount, bool& serverUsesTsc)
     {
         if (message.type != MessageType::SubscribeResponse)
         {
@@ -75,17 +89,115 @@ struct __attribute__((packed)) ClientServerMessage
         serverSideClientId = message.param1;
         serverCapacity = message.param2;
         serverClientCount = message.param3;
+        serverUsesTsc = message.param4 != 0;
 
         return true;
     }
 
-    static void GenerateSubscribeResponseMessage(ClientServerMessage& message, const uint32_t& serverId, const uint32_t& serverSideClientId, const uint32_t& serverCapacity, const uint32_t& serverClientCount)
+    static void GenerateSubscribeResponseMessage(ClientServerMessage& message, const uint32_t& serverId, const uint32_t& serverSideClientId, const uint32_t& serverCapacity, const uint32_t& serverClientCount, const bool& serverUsesTsc)
     {
         message.type = MessageType::SubscribeResponse;
         message.senderId = serverId;
         message.param1 = serverSideClientId;
         message.param2 = serverCapacity;
         message.param3 = serverClientCount;
+        message.param4 = serverUsesTsc ? 1 : 0;
+    }
+
+    // Appends `count` input/output buffer pairs of capacity 2^m x 2^n after the existing ones.
+    // The client creates the buffers before sending the message.
+    static bool ProcessAddBuffersMessage(const ClientServerMessage& message, uint32_t& clientId, uint32_t& m, uint32_t& n, uint32_t& count)
+    {
+        if (message.type != MessageType::AddBuffers)
+        {
+            return false;
+        }
+
+        clientId = message.senderId;
+        m = message.param1;
+        n = message.param2;
+        count = message.param3;
+
+        return true;
+    }
+
+    static void GenerateAddBuffersMessage(ClientServerMessage& message, const uint32_t& clientId, const uint32_t& m, const uint32_t& n, const uint32_t& count)
+    {
+        message.type = MessageType::AddBuffers;
+        message.senderId = clientId;
+        message.param1 = m;
+        message.param2 = n;
+        message.param3 = count;
+    }
+
+    // Drops the last `count` buffer pairs. The client must keep them until the response arrives.
+    static bool ProcessRemoveBuffersMessage(const ClientServerMessage& message, uint32_t& clientId, uint32_t& count)
+    {
+        if (message.type != MessageType::RemoveBuffers)
+        {
+            return false;
+        }
+
+        clientId = message.senderId;
+        count = message.param1;
+
+        return true;
+    }
+
+    static void GenerateRemoveBuffersMessage(ClientServerMessage& message, const uint32_t& clientId, const uint32_t& count)
+    {
+        message.type = MessageType::RemoveBuffers;
+        message.senderId = clientId;
+        message.param1 = count;
+    }
+
+    // Sets the logical shape of a buffer pair, used by requests that do not give a shape.
+    // Must fit in the capacity the buffers were created with.
+    static bool ProcessReshapeBufferMessage(const ClientServerMessage& message, uint32_t& clientId, uint32_t& bufferIndex, uint32_t& rowCount, uint32_t& columnCount)
+    {
+        if (message.type != MessageType::ReshapeBuffer)
+        {
+            return false;
+        }
+
+        clientId = message.senderId;
+        bufferIndex = message.param1;
+        rowCount = message.param2;
+        columnCount = message.param3;
+
+        return true;
+    }
+
+    static void GenerateReshapeBufferMessage(ClientServerMessage& message, const uint32_t& clientId, const uint32_t& bufferIndex, const uint32_t& rowCount, const uint32_t& columnCount)
+    {
+        message.type = MessageType::ReshapeBuffer;
+        message.senderId = clientId;
+        message.param1 = bufferIndex;
+        message.param2 = rowCount;
+        message.param3 = columnCount;
+    }
+
+    // Sent for every AddBuffers, RemoveBuffers and ReshapeBuffer message
+    static bool ProcessBuffersResponseMessage(const ClientServerMessage& message, uint32_t& serverId, bool& success, uint32_t& bufferCount)
+    {
+        if (message.type != MessageType::BuffersResponse)
+        {
+            return false;
+        }
+
+        serverId = message.senderId;
+        success = message.param1 != 0;
+        bufferCount = message.param2;
+
+        return true;
+    }
+
+    static void GenerateBuffersResponseMessage(ClientServerMessage& message, const uint32_t& serverId, const bool& success, const uint32_t& bufferCount)
+    {
+        message.type = MessageType::BuffersResponse;
+        message.senderId = serverId;
+        message.param1 = success ? 1 : 0;
+        message.param2 = bufferCount;
     }
 
     static std::string TypeToString(ClientServerMessage::MessageType type)
@@ -97,7 +209,15 @@ struct __attribute__((packed)) ClientServerMessage
         case MessageType::Unsubscribe:
             return "Unsubscribe";
         case MessageType::SubscribeResponse:
-
+            return "SubscribeResponse";
+        case MessageType::AddBuffers:
+            return "AddBuffers";
+        case MessageType::RemoveBuffers:
+            return "RemoveBuffers";
+        case MessageType::ReshapeBuffer:
+            return "ReshapeBuffer";
+        case MessageType::BuffersResponse:
+            return "BuffersResponse";
         default:
             return "UNKNOWN";
         }
@@ -110,13 +230,25 @@ struct __attribute__((packed)) ClientServerMessage
         switch (message.type)
         {
         case MessageType::Subscribe:
-            oss << "Subscribe: { clientPid: " << message.senderId << ", m: " << message.param1 << ", n: " << message.param2 << ", k: " << message.param3 << " }";
+            oss << "Subscribe: { clientPid: " << message.senderId << ", m: " << message.param1 << ", n: " << message.param2 << ", k: " << message.param3 << ", weight: " << message.param4 << ", lanes: " << message.param5 << " }";
             break;
         case MessageType::Unsubscribe:
             oss << "Unsubscribe: { clientPid: " << message.senderId << " }";
             break;
         case MessageType::SubscribeResponse:
-            oss << "SubscribeResponse: { serverPid: " << message.senderId << ", serverSideClientId: " << message.param1 << ", serverCapacity: " << message.param2 << ", serverClientCount: " << message.param3 << " }";
+            oss << "SubscribeResponse: { serverPid: " << message.senderId << ", serverSideClientId: " << message.param1 << ", serverCapacity: " << message.param2 << ", serverClientCount: " << message.param3 << ", serverUsesTsc: " << message.param4 << " }";
+            break;
+        case MessageType::AddBuffers:
+            oss << "AddBuffers: { clientPid: " << message.senderId << ", m: " << message.param1 << ", n: " << message.param2 << ", count: " << message.param3 << " }";
+            break;
+        case MessageType::RemoveBuffers:
+            oss << "RemoveBuffers: { clientPid: " << message.senderId << ", count: " << message.param1 << " }";
+            break;
+        case MessageType::ReshapeBuffer:
+            oss << "ReshapeBuffer: { clientPid: " << message.senderId << ", buffer: " << message.param1 << ", rows: " << message.param2 << ", columns: " << message.param3 << " }";
+            break;
+        case MessageType::BuffersResponse:
+            oss << "BuffersResponse: { serverPid: " << message.senderId << ", success: " << message.param1 << ", bufferCount: " << message.param2 << " }";
             break;
         default:
             oss << "UNKNOWN";
@@ -9,11 +9,49 @@ namespace MatrixTransposer::Constants
     const std::string TR_MATRIX_BUF_NAME_SUFFIX = "_tr";
     const std::string TR_GOLDEN_MATRIX_BUF_NAME_SUFFIX = "_tr_gold";
     const std::string REQ_QUEUE_NAME_SUFFIX = "_req";
+    const std::string REQ_RECORD_NAME_SUFFIX = "_rec";
+    const std::string DOORBELL_NAME_SUFFIX = "";
+    const std::string METRICS_NAME_SUFFIX = "";
     constexpr uint32_t REQ_QUEUE_CAPACITY = 16;
-    constexpr uint32_t MAX_CLIENTS = 64;
+    constexpr uint32_t MAX_CLIENTS = 4096;
+    constexpr uint32_t DEFAULT_CLIENT_WEIGHT = 1;
+    constexpr uint32_t DEFAULT_CLIENT_LANES = 1;
+    constexpr uint32_t MAX_CLIENT_WEIGHT = 1024;
+
+    // Submission lanes a client may open at subscribe time, each with its own request queue
+    constexpr uint32_t MAX_CLIENT_LANES = 16;
+
+    // Input/output buffer pairs a client may have mapped at once
+    constexpr uint32_t MAX_CLIENT_BUFFERS = 1024;
     const std::string WORKER_THREAD_QUEUE_NAME_SUFFIX = "_wrk_q";
     const uint32_t WORKER_THREAD_QUEUE_CAPACITY = 16*1024*1024;
 
     constexpr uint32_t TRANSPOSE_TILE_SIZE = 64;
 
+    // Request bytes (input + output) one worker is expected to move efficiently on its own.
+    // Used to size the core partition given to each request.
+    constexpr uint64_t TRANSPOSE_BYTES_PER_WORKER = 256 * 1024;
+    constexpr uint32_t WORKER_SPIN_COUNT = 1 << 14;
+
+    // Large requests run in chunks of tiles; between chunks the dispatcher may preempt a request
+    // that has been running for longer than the time slice in favour of smaller waiting ones.
+    constexpr uint32_t TRANSPOSE_CHUNK_TILES = 8;
+    constexpr uint32_t DEFAULT_TIME_SLICE_US = 1000;
+
+    // Period at which the dispatcher publishes live counters to the server metrics page
+    constexpr uint32_t METRICS_PUBLISH_INTERVAL_MS = 250;
+
+    // Setting this environment variable starts server and client with tracing on. Its value, if
+    // not empty, replaces the prefix of the trace dump paths.
+    const std::string TRACE_ENVIRONMENT_VARIABLE = "TRANSPOSE_TRACE";
+    const std::string TRACE_DUMP_PATH_PREFIX = "/tmp/transpose";
+
+    // Log level of server and client: debug, info, warning, error or off
+    const std::string LOG_LEVEL_ENVIRONMENT_VARIABLE = "TRANSPOSE_LOG_LEVEL";
+
+    // Shared memory name suffix of a per-lane object. Lane 0 keeps the plain suffix.
+    inline std::string LaneNameSuffix(const std::string& nameSuffix, uint32_t lane)
+    {
+        return (lane == 0) ? nameSuffix : nameSuffix + "_lane" + std::to_string(lane);
+    }
 }
\ No newline at end of file
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <sstream>
+#include <string>
+
+#include "shared-mem/SharedMemory.h"
+#include "bitmap/HierarchicalBitmap.h"
+
+// Two-level bitmap in shared memory with one bit per client slot. A client rings its bit after
+// enqueueing a request, and the dispatcher collects the rung bits instead of polling the queues
+// of all subscribed clients.
+//
+// Ring() sets the slot bit before the summary bit, and Collect() clears the summary bit before
+// the slot word, so a bit rung while the dispatcher is collecting is either taken now or left
+// with its summary bit set for the next collection.
+class PendingWorkDoorbell
+{
+public:
+    enum class Endpoint
+    {
+        Server,
+        Client
+    };
+
+    static constexpr uint32_t MAX_SLOTS = 64 * 64;
+
+    PendingWorkDoorbell(uint32_t serverPid, Endpoint endpoint, const std::string& nameSuffix)
+    {
+        SharedMemory::Ownership ownership = (endpoint == Endpoint::Server) ? SharedMemory::Ownership::Owner : SharedMemory::Ownership::Borrower;
+        SharedMemory::BufferInitMode bufferInitMode = (endpoint == Endpoint::Server) ? SharedMemory::BufferInitMode::Zero : SharedMemory::BufferInitMode::NoInit;
+
+        mp_SharedMemory = std::make_unique<SharedMemory>(sizeof(Layout), CreateShmObjectName(serverPid, nameSuffix), ownership, bufferInitMode);
+
+        if (endpoint == Endpoint::Server)
+        {
+            mp_Layout = new (mp_SharedMemory->GetRawPointer()) Layout();
+        }
+        else
+        {
+            mp_Layout = static_cast<Layout*>(mp_SharedMemory->GetRawPointer());
+        }
+    }
+
+    void Ring(uint32_t slot)
+    {
+        uint32_t wordIndex = slot / 64;
+        mp_Layout->words[wordIndex].bits.fetch_or(1ULL << (slot % 64), std::memory_order_release);
+        mp_Layout->summary.fetch_or(1ULL << wordIndex, std::memory_order_release);
+    }
+
+    // Moves every rung bit into `pending` and clears it in the doorbell
+    template <uint32_t Capacity>
+    void Collect(HierarchicalBitmap<Capacity>& pending)
+    {
+        static_assert(Capacity <= MAX_SLOTS, "Bitmap has more slots than the doorbell");
+
+        if (mp_Layout->summary.load(std::memory_order_relaxed) == 0)
+        {
+            return;
+        }
+
+        uint64_t summary = mp_Layout->summary.exchange(0, std::memory_order_acquire);
+        for (; summary != 0; summary &= summary - 1)
+        {
+            uint32_t wordIndex = __builtin_ctzll(summary);
+            pending.OrWord(wordIndex, mp_Layout->words[wordIndex].bits.exchange(0, std::memory_order_acquire));
+        }
+    }
+
+private:
+    struct alignas(64) DoorbellWord
+    {
+        std::atomic<uint64_t> bits { 0 };
+    };
+
+    struct Layout
+    {
+        alignas(64) std::atomic<uint64_t> summary { 0 };
+        DoorbellWord words[MAX_SLOTS / 64];
+    };
+
+    static std::string CreateShmObjectName(uint32_t serverPid, const std::string& nameSuffix)
+    {
+        std::ostringstream oss;
+        oss << "doorbell_uid{" << serverPid << "}" << nameSuffix;
+        return oss.str();
+    }
+
+    Layout* mp_Layout;
+    std::unique_ptr<SharedMemory> mp_SharedMemory;
+};
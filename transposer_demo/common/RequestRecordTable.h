@@ -0,0 +1,109 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <sstream>
+#include <string>
+
+#include "shared-mem/SharedMemory.h"
+
+enum class RequestStatus : uint32_t
+{
+    Pending,
+    Completed,
+    DeadlineMet,
+    DeadlineMissed,
+    // Descriptor failed validation and was not executed
+    Rejected,
+};
+
+// When a request passed each stage on its way, in TscClock ticks. The client adopts the server's
+// clock mode at subscribe, so both processes read the same counter. Each side writes its timestamps before handing the request over
+// (enqueue, status store), so the other side can read them once it has the request.
+struct RequestTimestamps
+{
+    // Client, just before enqueueing
+    uint64_t submitTicks;
+    // Dispatcher, when it takes the request off the queue
+    uint64_t dequeueTicks;
+    // Dispatcher, when it hands the request to workers
+    uint64_t dispatchTicks;
+    // Worker that claims the first chunk, and the last worker to finish
+    uint64_t kernelStartTicks;
+    uint64_t kernelEndTicks;
+    // Server, right before it publishes the outcome and signals the client
+    uint64_t wakeTicks;
+    // Client, once it sees the outcome
+    uint64_t resumeTicks;
+};
+
+// Outcome of a request, written by the server before waking the client. A request uses the
+// record at its client tag modulo the record count, so the client can have as many requests in
+// flight as there are records.
+struct alignas(64) RequestRecord
+{
+    std::atomic<RequestStatus> status;
+    RequestTimestamps timestamps;
+};
+
+static_assert(sizeof(RequestRecord) == 64, "RequestRecord should fill exactly one cache line");
+
+// CLOCK_MONOTONIC is system-wide, so client and server timestamps are directly comparable
+inline uint64_t RequestClockNowNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+class RequestRecordTable
+{
+public:
+    enum class Endpoint
+    {
+        Server,
+        Client
+    };
+
+    RequestRecordTable(uint32_t ownerPid, Endpoint endpoint, uint32_t recordCount, const std::string& nameSuffix) :
+        m_RecordCount(recordCount)
+    {
+        SharedMemory::Ownership ownership = (endpoint == Endpoint::Client) ? SharedMemory::Ownership::Owner : SharedMemory::Ownership::Borrower;
+        SharedMemory::BufferInitMode bufferInitMode = (endpoint == Endpoint::Client) ? SharedMemory::BufferInitMode::Zero : SharedMemory::BufferInitMode::NoInit;
+        size_t bufferSizeInBytes = static_cast<size_t>(m_RecordCount) * sizeof(RequestRecord);
+
+        mp_SharedMemory = std::make_unique<SharedMemory>(bufferSizeInBytes, CreateShmObjectName(ownerPid, nameSuffix), ownership, bufferInitMode);
+        mp_Records = static_cast<RequestRecord*>(mp_SharedMemory->GetRawPointer());
+
+        if (endpoint == Endpoint::Client)
+        {
+            for (uint32_t i = 0; i < m_RecordCount; i++)
+            {
+                new (&mp_Records[i]) RequestRecord();
+                mp_Records[i].status.store(RequestStatus::Pending, std::memory_order_relaxed);
+            }
+        }
+    }
+
+    RequestRecord& operator[](uint32_t index)
+    {
+        return mp_Records[index];
+    }
+
+    uint32_t GetRecordCount() const
+    {
+        return m_RecordCount;
+    }
+
+private:
+    static std::string CreateShmObjectName(uint32_t ownerPid, const std::string& nameSuffix)
+    {
+        std::ostringstream oss;
+        oss << "req_rec_uid{" << ownerPid << "}" << nameSuffix;
+        return oss.str();
+    }
+
+    uint32_t m_RecordCount;
+    RequestRecord* mp_Records;
+    std::unique_ptr<SharedMemory> mp_SharedMemory;
+};
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstdint>
+#include <sstream>
+#include <string>
+
+#include "ClientStats.h"
+#include "RequestRecordTable.h"
+#include "TscClock.h"
+
+// Stages between two consecutive RequestTimestamps of a request
+enum class RequestStage : uint32_t
+{
+    // Submit to dequeue: waiting in the queue until the dispatcher notices the doorbell
+    Queue,
+    // Dequeue to dispatch: waiting for idle workers and for requests scheduled before it
+    Schedule,
+    // Dispatch to kernel start: worker wake-up
+    Pickup,
+    // Kernel start to end, including any time the request spent preempted
+    Kernel,
+    // Kernel end to wake: completion bookkeeping on the server
+    Complete,
+    // Wake to resume: until the client sees the outcome
+    Wakeup,
+    Count
+};
+
+static_assert(static_cast<uint32_t>(RequestStage::Count) <= ClientStats::MAX_STAGES, "ClientStats cannot time every request stage");
+
+inline const char* RequestStageToString(RequestStage stage)
+{
+    switch (stage)
+    {
+    case RequestStage::Queue: return "queue";
+    case RequestStage::Schedule: return "schedule";
+    case RequestStage::Pickup: return "pickup";
+    case RequestStage::Kernel: return "kernel";
+    case RequestStage::Complete: return "complete";
+    case RequestStage::Wakeup: return "wakeup";
+    default: return "unknown";
+    }
+}
+
+// Records the stages before endStage. The server knows the timestamps up to the wake, the client
+// all of them. A stage with a zero boundary is skipped: the client leaves its timestamps at zero
+// when it cannot read the server's clock.
+inline void RecordRequestStages(ClientStats& stats, const RequestTimestamps& timestamps, RequestStage endStage)
+{
+    const uint64_t stageBoundaries[] = { timestamps.submitTicks, timestamps.dequeueTicks, timestamps.dispatchTicks, timestamps.kernelStartTicks, timestamps.kernelEndTicks, timestamps.wakeTicks, timestamps.resumeTicks };
+
+    for (uint32_t stage = 0; stage < static_cast<uint32_t>(endStage); stage++)
+    {
+        uint64_t startTicks = stageBoundaries[stage];
+        uint64_t endTicks = stageBoundaries[stage + 1];
+        if (startTicks == 0 || endTicks == 0)
+        {
+            continue;
+        }
+        stats.RecordStageTime(stage, (endTicks > startTicks) ? TscClock::TicksToNs(endTicks - startTicks) : 0);
+    }
+}
+
+// p50/p99/max of every stage before endStage, in the form printed by both the server and the client
+inline std::string GetRequestStagesSummary(const ClientStats& stats, RequestStage endStage)
+{
+    std::ostringstream oss;
+    oss << "stages p50/p99/max (ns)";
+    for (uint32_t stage = 0; stage < static_cast<uint32_t>(endStage); stage++)
+    {
+        const LatencyHistogram& times = stats.GetStageTimes(stage);
+        oss << ", " << RequestStageToString(static_cast<RequestStage>(stage)) << ": "
+            << times.GetPercentileNs(50.0) << "/" << times.GetPercentileNs(99.0) << "/" << times.GetMaxNs();
+    }
+    return oss.str();
+}
@@ -0,0 +1,162 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+#include "shared-mem/SharedMemory.h"
+#include "shared-mem/Seqlock.h"
+
+// Live counters the server publishes in shared memory for monitors such as transpose_top. The
+// server is the only writer and publishes from its dispatcher thread every few hundred
+// milliseconds. Monitors map the page read-only, so they can neither block nor corrupt the
+// server. Every entry is a Seqlock of its own: a monitor copies each entry consistently without
+// the server ever waiting, but entries copied one after another may come from different
+// publications.
+class ServerMetricsPage
+{
+public:
+    enum class Endpoint
+    {
+        Server,
+        Observer
+    };
+
+    static constexpr uint32_t MAX_LANES = 64 * 64;
+    static constexpr uint32_t MAX_WORKERS = 256;
+
+    // Changed whenever the layout changes, so a monitor built against another layout refuses to attach
+    static constexpr uint64_t LAYOUT_VERSION = 1;
+
+    struct ServerMetrics
+    {
+        uint64_t layoutVersion;
+        uint32_t serverPid;
+        uint32_t workerCount;
+
+        // One past the highest registry slot that may hold a lane
+        uint32_t slotLimit;
+        uint32_t laneCount;
+
+        // steady_clock nanoseconds
+        uint64_t startTimeNs;
+        uint64_t publishTimeNs;
+        uint64_t totalBytes;
+    };
+
+    // One submission lane of a client, at the lane's registry slot. clientId is 0 for a free slot.
+    struct LaneMetrics
+    {
+        uint32_t clientId;
+        uint32_t laneIndex;
+        uint32_t weight;
+
+        // Requests waiting in the lane's queue, not counting one staged by the dispatcher
+        uint32_t queueDepth;
+        uint64_t requests;
+        uint64_t bytes;
+        uint64_t p50Ns;
+        uint64_t p99Ns;
+        uint64_t p999Ns;
+        uint64_t maxNs;
+        uint64_t deadlinesMet;
+        uint64_t deadlinesMissed;
+    };
+
+    struct WorkerMetrics
+    {
+        uint64_t jobParts;
+        uint64_t busyNs;
+    };
+
+    ServerMetricsPage(uint32_t serverPid, Endpoint endpoint, const std::string& nameSuffix)
+    {
+        SharedMemory::Ownership ownership = (endpoint == Endpoint::Server) ? SharedMemory::Ownership::Owner : SharedMemory::Ownership::Observer;
+        SharedMemory::BufferInitMode bufferInitMode = (endpoint == Endpoint::Server) ? SharedMemory::BufferInitMode::Zero : SharedMemory::BufferInitMode::NoInit;
+
+        mp_SharedMemory = std::make_unique<SharedMemory>(sizeof(Layout), CreateShmObjectName(serverPid, nameSuffix), ownership, bufferInitMode);
+
+        if (endpoint == Endpoint::Server)
+        {
+            mp_Layout = new (mp_SharedMemory->GetRawPointer()) Layout();
+        }
+        else
+        {
+            mp_Layout = static_cast<Layout*>(mp_SharedMemory->GetRawPointer());
+
+            // The server stores the header before it starts serving
+            if (mp_Layout->server.Load().layoutVersion != LAYOUT_VERSION)
+            {
+                throw std::runtime_error("Server metrics page has a different layout version");
+            }
+        }
+    }
+
+    // Server side
+    void PublishServer(const ServerMetrics& metrics)
+    {
+        mp_Layout->server.Store(metrics);
+    }
+
+    void PublishLane(uint32_t slot, const LaneMetrics& metrics)
+    {
+        mp_Layout->lanes[slot].Store(metrics);
+    }
+
+    void PublishWorker(uint32_t workerIndex, const WorkerMetrics& metrics)
+    {
+        mp_Layout->workers[workerIndex].Store(metrics);
+    }
+
+    // Server side: what was last published for the slot
+    const LaneMetrics& GetPublishedLane(uint32_t slot) const
+    {
+        return mp_Layout->lanes[slot].GetStored();
+    }
+
+    // Observer side
+    ServerMetrics ReadServer() const
+    {
+        return mp_Layout->server.Load();
+    }
+
+    LaneMetrics ReadLane(uint32_t slot) const
+    {
+        return mp_Layout->lanes[slot].Load();
+    }
+
+    WorkerMetrics ReadWorker(uint32_t workerIndex) const
+    {
+        return mp_Layout->workers[workerIndex].Load();
+    }
+
+    static std::string CreateShmObjectName(uint32_t serverPid, const std::string& nameSuffix)
+    {
+        std::ostringstream oss;
+        oss << SHM_OBJECT_NAME_PREFIX << serverPid << "}" << nameSuffix;
+        return oss.str();
+    }
+
+    // Lets a monitor find running servers among the shared memory objects
+    static constexpr const char* SHM_OBJECT_NAME_PREFIX = "server_metrics_uid{";
+
+private:
+    // Entries on cache lines of their own, so publishing one lane does not disturb a monitor
+    // copying its neighbour
+    template <typename T>
+    struct alignas(64) Entry : Seqlock<T>
+    {
+    };
+
+    struct Layout
+    {
+        Entry<ServerMetrics> server;
+        Entry<WorkerMetrics> workers[MAX_WORKERS];
+        Entry<LaneMetrics> lanes[MAX_LANES];
+    };
+
+    Layout* mp_Layout;
+    std::unique_ptr<SharedMemory> mp_SharedMemory;
+};
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+#include "Constants.h"
+#include "log/Logger.h"
+#include "trace/Tracer.h"
+
+// Events server and client record with Tracer. Ids index the descriptions in TraceEventInfos().
+enum class TraceEventId : uint16_t
+{
+    // Server dispatcher
+    Dequeue,        // Request taken off a lane queue
+    Reject,         // Request failed validation
+    Dispatch,       // Request started or resumed on workers
+    Preempt,        // Running request asked to leave its workers
+    Flush,          // Completions written to a client's eventfd
+
+    // Server workers
+    JobPart,        // A worker's share of a request
+    TileChunk,      // Tiles a worker claimed and transposed
+    Wake,           // Completion signalled to the client
+
+    // Client
+    Submit,         // Request enqueued and doorbell rung
+    Wait,           // Waiting for a request to complete
+    Finish,         // Completion seen
+
+    Count,
+};
+
+inline std::vector<TraceEventInfo> TraceEventInfos()
+{
+    return {
+        { "dequeue", "client", "tag" },
+        { "reject", "client", "tag" },
+        { "dispatch", "client", "width" },
+        { "preempt", "client", "tag" },
+        { "flush", "client", "completions" },
+        { "job part", "client", "tag" },
+        { "tiles", "firstTile", "endTile" },
+        { "wake", "client", "lane" },
+        { "submit", "lane", "tag" },
+        { "wait", "lane", "tag" },
+        { "finish", "lane", "tag" },
+    };
+}
+
+inline void TraceInstant(TraceEventId eventId, uint64_t arg0 = 0, uint64_t arg1 = 0)
+{
+    Tracer::Instant(static_cast<uint16_t>(eventId), arg0, arg1);
+}
+
+inline void TraceBegin(TraceEventId eventId, uint64_t arg0 = 0, uint64_t arg1 = 0)
+{
+    Tracer::Begin(static_cast<uint16_t>(eventId), arg0, arg1);
+}
+
+inline void TraceEnd(TraceEventId eventId)
+{
+    Tracer::End(static_cast<uint16_t>(eventId));
+}
+
+// Prefix of the trace dump paths, from TRACE_ENVIRONMENT_VARIABLE if it has a value
+inline std::string TraceDumpPathPrefix()
+{
+    const char* pValue = std::getenv(MatrixTransposer::Constants::TRACE_ENVIRONMENT_VARIABLE.c_str());
+    return (pValue != nullptr && *pValue != '\0') ? pValue : MatrixTransposer::Constants::TRACE_DUMP_PATH_PREFIX;
+}
+
+// Sets up tracing for the process, off unless TRACE_ENVIRONMENT_VARIABLE is set. SIGUSR1 switches
+// it on and off and SIGUSR2 dumps the rings. Call from main before starting any thread.
+inline void StartTracing()
+{
+    Tracer::SetEventInfos(TraceEventInfos());
+    Tracer::SetThreadName("main");
+    Tracer::StartSignalControl(TraceDumpPathPrefix());
+    Tracer::SetEnabled(std::getenv(MatrixTransposer::Constants::TRACE_ENVIRONMENT_VARIABLE.c_str()) != nullptr);
+}
+
+// Dumps the rings to <prefix>.<pid>.trace at exit if anything was recorded
+inline void FinishTracing()
+{
+    if (Tracer::GetRecordedCount() == 0)
+    {
+        return;
+    }
+
+    std::string path = TraceDumpPathPrefix() + "." + std::to_string(getpid()) + ".trace";
+    try
+    {
+        uint64_t eventCount = Tracer::Dump(path);
+        LOG_INFO("Wrote {} trace events to {}", eventCount, path);
+    }
+    catch(const std::exception& e)
+    {
+        LOG_ERROR("{}", e.what());
+    }
+}
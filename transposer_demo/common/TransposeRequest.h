@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstdint>
+
+enum class TransposeOp : uint16_t
+{
+    // Zero is left unused so that a zeroed descriptor is rejected
+    Invalid = 0,
+
+    // Output buffer dst = transpose(input buffer src)
+    Transpose = 1,
+};
+
+// Reserved for future use, must be zero
+constexpr uint16_t TRANSPOSE_REQUEST_FLAGS_MASK = 0;
+
+// Request descriptor passed through the request queue, one cache line each. The server checks
+// every field against the client's buffers before executing it and rejects the request otherwise.
+struct alignas(64) TransposeRequest
+{
+    TransposeOp op;
+    uint16_t flags;
+
+    // Index of an input buffer and of an output buffer. They need not be equal, so a client can
+    // rotate through its output buffers independently of its inputs.
+    uint32_t srcBuffer;
+    uint32_t dstBuffer;
+
+    // Shape of the source matrix stored at the start of the source buffer. The transposed
+    // matrix is written to the start of the destination buffer. Must fit in both buffers.
+    // Both zero means the logical shape the source buffer was last given (see ReshapeBuffer).
+    uint32_t rowCount;
+    uint32_t columnCount;
+
+    // Chosen by the client; the outcome is written to request record (clientTag % record count)
+    uint32_t clientTag;
+
+    // Absolute deadline on the RequestClockNowNs() time base, 0 when the request has none
+    uint64_t deadlineNs;
+};
+
+static_assert(sizeof(TransposeRequest) == 64, "TransposeRequest should fill exactly one cache line");
@@ -0,0 +1,49 @@
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "trace/TraceReader.h"
+
+// Merges the trace dumps of server and clients into one Chrome trace JSON file, for
+// chrome://tracing or https://ui.perfetto.dev
+int main(int argc, char* argv[])
+{
+    if (argc < 3)
+    {
+        std::cerr << "Usage: " << argv[0] << " <output .json> <trace dump> [trace dump ...]" << std::endl;
+        return 1;
+    }
+
+    std::vector<TraceDump> dumps;
+    uint64_t eventCount = 0;
+    try
+    {
+        for (int argIndex = 2; argIndex < argc; argIndex++)
+        {
+            dumps.push_back(TraceReader::Read(argv[argIndex]));
+            for (const TraceDump::Thread& thread : dumps.back().threads)
+            {
+                eventCount += thread.events.size();
+            }
+        }
+    }
+    catch(const std::exception& e)
+    {
+        std::cerr << e.what() << '\n';
+        return 1;
+    }
+
+    std::ofstream out(argv[1]);
+    TraceReader::WriteChromeTrace(dumps, out);
+    out.flush();
+    if (!out)
+    {
+        std::cerr << "Failed to write " << argv[1] << std::endl;
+        return 1;
+    }
+
+    std::clog << "Wrote " << eventCount << " events of " << dumps.size() << " processes to " << argv[1] << std::endl;
+    return 0;
+}
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <atomic>
 #include <cstdint>
 #include <memory>
 #include <vector>
@@ -8,22 +9,56 @@
 #include "unix-socks/UnixSockIpcClient.h"
 #include "futex/FutexSignaller.h"
 #include "matrix-buf/SharedMatrixBuffer.h"
-#include "spsc-queue/SpscQueueSeqLock.h"
+#include "spsc-queue/SpscQueueSequenced.h"
 #include "ClientServerMessage.h"
 #include "BufferDimensions.h"
+#include "PendingWorkDoorbell.h"
+#include "RequestRecordTable.h"
+#include "TransposeRequest.h"
 #include "ClientStats.h"
 
+// Client end of one submission lane, fed by one producer thread
+struct SubmissionLane
+{
+    std::unique_ptr<SpscQueueSequenced<TransposeRequest>> pRequestQueue;
+    std::unique_ptr<RequestRecordTable> pRequestRecords;
+    std::unique_ptr<FutexSignaller> pTransposeReadyFutex;
+    ClientStats stats;
+};
+
 struct ClientWorkspace
 {
     uint32_t requestRepetitions;
     uint32_t clientPid;
+    uint32_t serverPid;
+    // Slot given by the server to the first lane. Lane i rings slot serverSlot + i in the
+    // doorbell after every enqueued request.
+    uint32_t serverSlot;
+    uint32_t weight;
+    uint32_t deadlineBudgetUs;
+    uint32_t laneCount;
+    // How the lanes wait for their completion futex
+    FutexSignaller::WaitPolicy waitPolicy;
+    // Single-threaded epoll loop over all lanes, woken through completionEventFd instead of futexes
+    bool useEventLoop;
+    int completionEventFd;
+    // Adds, reshapes and removes a buffer at run time after the regular requests
+    bool exerciseBufferChanges;
     BufferDimensions buffers;
     ClientStats stats;
-    bool subscribeResponseReceived;
+    std::atomic<bool> subscribeResponseReceived;
+    // TscClock mode of the server, set with subscribeResponseReceived
+    bool serverUsesTsc;
+    // False if this process cannot read the server's clock, so its request timestamps would
+    // not compare with the server's; the client then leaves its stage timestamps at zero
+    bool timestampStages;
+    std::atomic<bool> buffersResponseReceived;
+    bool buffersChangeSucceeded;
+    uint32_t serverBufferCount;
     std::unique_ptr<UnixSockIpcClient<ClientServerMessage>> pIpcClient;
     std::vector<std::unique_ptr<SharedMatrixBuffer>> matrixBuffers;
     std::vector<std::unique_ptr<SharedMatrixBuffer>> matrixBuffersTr;
     std::vector<std::unique_ptr<SharedMatrixBuffer>> matrixBuffersTrReference;
-    std::unique_ptr<SpscQueueSeqLock> pRequestQueue;
-    std::unique_ptr<FutexSignaller> pTransposeReadyFutex;
+    std::vector<SubmissionLane> lanes;
+    std::unique_ptr<PendingWorkDoorbell> pDoorbell;
 };
\ No newline at end of file
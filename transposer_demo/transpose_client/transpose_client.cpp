@@ -7,6 +7,9 @@
 #include <vector>
 #include <thread>
 #include <random>
+#include <sys/epoll.h>
+#include <poll.h>
+#include <sys/eventfd.h>
 
 #include "futex/FutexSignaller.h"
 #include "matrix-buf/SharedMatrixBuffer.h"
@@ -16,6 +19,8 @@
 #include "ClientWorkspace.h"
 #include "mat-transpose/mat-transpose.h"
 #include "ClientStats.h"
+#include "RequestStages.h"
+#include "TraceEvents.h"
 
 
 using std::vector;
@@ -25,20 +30,34 @@ using MatrixTransposer::Constants::SERVER_SOCKET_ADDRESS;
 using MatrixTransposer::Constants::MATRIX_BUF_NAME_SUFFIX;
 using MatrixTransposer::Constants::TR_MATRIX_BUF_NAME_SUFFIX;
 using MatrixTransposer::Constants::REQ_QUEUE_NAME_SUFFIX;
+using MatrixTransposer::Constants::REQ_RECORD_NAME_SUFFIX;
+using MatrixTransposer::Constants::DOORBELL_NAME_SUFFIX;
 using MatrixTransposer::Constants::REQ_QUEUE_CAPACITY;
 using MatrixTransposer::Constants::TR_GOLDEN_MATRIX_BUF_NAME_SUFFIX;
+using MatrixTransposer::Constants::DEFAULT_CLIENT_WEIGHT;
+using MatrixTransposer::Constants::DEFAULT_CLIENT_LANES;
+using MatrixTransposer::Constants::MAX_CLIENT_LANES;
+using MatrixTransposer::Constants::LaneNameSuffix;
+using MatrixTransposer::Constants::LOG_LEVEL_ENVIRONMENT_VARIABLE;
 
 ClientWorkspace gWorkspace;
 
 
-static bool ProcessArguments(int argc, char* argv[], uint32_t &m, uint32_t &n, uint32_t &k, uint32_t &requestRepetitions)
+static bool ProcessArguments(int argc, char* argv[], uint32_t &m, uint32_t &n, uint32_t &k, uint32_t &requestRepetitions, uint32_t &weight, uint32_t &deadlineBudgetUs, bool &exerciseBufferChanges, uint32_t &laneCount, FutexSignaller::WaitPolicy &waitPolicy, bool &useEventLoop)
  {
-    if (argc != 5 && argc != 1)
+    if (argc != 10 && argc != 9 && argc != 8 && argc != 7 && argc != 6 && argc != 5 && argc != 1)
     {
-        std::cerr << "Usage: " << argv[0] << " <m> <n> <k> <repetitions>" << std::endl;
+        std::cerr << "Usage: " << argv[0] << " <m> <n> <k> <repetitions> [weight] [deadline budget (us)] [buffer changes (0/1)] [lanes] [wait policy (futex/spin/yield/hybrid/epoll)]" << std::endl;
         return false;
     }
 
+    weight = DEFAULT_CLIENT_WEIGHT;
+    deadlineBudgetUs = 0;
+    exerciseBufferChanges = false;
+    laneCount = DEFAULT_CLIENT_LANES;
+    waitPolicy = FutexSignaller::WaitPolicy::Hybrid;
+    useEventLoop = false;
+
     if (argc == 1)
     {
         m = 4;
@@ -52,29 +71,363 @@ static bool ProcessArguments(int argc, char* argv[], uint32_t &m, uint32_t &n, u
     n = std::atoi(argv[2]);
     k = std::atoi(argv[3]);
     requestRepetitions = std::atoi(argv[4]);
+
+    if (argc >= 6)
+    {
+        weight = std::atoi(argv[5]);
+    }
+
+    if (argc >= 7)
+    {
+        deadlineBudgetUs = std::atoi(argv[6]);
+    }
+
+    if (argc >= 8)
+    {
+        exerciseBufferChanges = std::atoi(argv[7]) != 0;
+    }
+
+    if (argc >= 9)
+    {
+        laneCount = std::atoi(argv[8]);
+    }
+
+    if (argc == 10 && std::string(argv[9]) == "epoll")
+    {
+        useEventLoop = true;
+    }
+    else if (argc == 10 && !FutexSignaller::ParseWaitPolicy(argv[9], waitPolicy))
+    {
+        std::cerr << "Unknown wait policy: " << argv[9] << std::endl;
+        return false;
+    }
+
+    // Every lane needs at least one buffer of its own
+    if (laneCount == 0 || laneCount > k || laneCount > MAX_CLIENT_LANES)
+    {
+        std::cerr << "Lanes must be between 1 and min(k, " << MAX_CLIENT_LANES << ")" << std::endl;
+        return false;
+    }
     return true;
 }
 
 static void MessageHandler(const ClientServerMessage& message)
 {
     // std::cout << ClientServerMessage::ToString(message) << std::endl;
-    gWorkspace.subscribeResponseReceived = true;
+    uint32_t serverId, serverCapacity, serverClientCount;
+    if (ClientServerMessage::ProcessBuffersResponseMessage(message, serverId, gWorkspace.buffersChangeSucceeded, gWorkspace.serverBufferCount))
+    {
+        gWorkspace.buffersResponseReceived.store(true, std::memory_order_release);
+        return;
+    }
+
+    if (!ClientServerMessage::ProcessSubscribeResponseMessage(message, gWorkspace.serverPid, gWorkspace.serverSlot, serverCapacity, serverClientCount, gWorkspace.serverUsesTsc))
+    {
+        return;
+    }
+    gWorkspace.subscribeResponseReceived.store(true, std::memory_order_release);
+}
+
+// Sends an AddBuffers, RemoveBuffers or ReshapeBuffer message and waits for the server to apply it
+static bool ChangeServerBuffers(const ClientServerMessage& message)
+{
+    gWorkspace.buffersResponseReceived.store(false, std::memory_order_relaxed);
+    gWorkspace.pIpcClient->Send(message);
+
+    while (!gWorkspace.buffersResponseReceived.load(std::memory_order_acquire))
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    if (!gWorkspace.buffersChangeSucceeded)
+    {
+        std::cout << "Client " << gWorkspace.clientPid << ": server rejected " << ClientServerMessage::TypeToString(message.type) << std::endl;
+    }
+    return gWorkspace.buffersChangeSucceeded;
+}
+
+// Waits on the lane futex, or on the completion eventfd in event loop mode until the record is done
+static void WaitForCompletion(SubmissionLane& lane, const RequestRecord& record)
+{
+    if (gWorkspace.completionEventFd < 0)
+    {
+        lane.pTransposeReadyFutex->Wait();
+        return;
+    }
+
+    // The eventfd is non-blocking, so an empty counter is waited out with poll
+    uint64_t completions;
+    while (record.status.load(std::memory_order_acquire) == RequestStatus::Pending)
+    {
+        if (read(gWorkspace.completionEventFd, &completions, sizeof(completions)) >= 0 || errno == EINTR)
+        {
+            continue;
+        }
+        if (errno == EAGAIN)
+        {
+            pollfd pollFd { gWorkspace.completionEventFd, POLLIN, 0 };
+            poll(&pollFd, 1, -1);
+        }
+        else
+        {
+            std::cerr << "Failed to read completion eventfd (errno: " << errno << "): " << strerror(errno) << std::endl;
+            return;
+        }
+    }
+}
+
+// Adds one buffer pair, gives it the transposed logical shape, has it transposed by a request
+// without a shape and removes it again, all without resubscribing
+static bool ExerciseBufferChanges(uint32_t clientTag)
+{
+    uint32_t m = gWorkspace.buffers.m;
+    uint32_t n = gWorkspace.buffers.n;
+    uint32_t bufferIndex = gWorkspace.buffers.k;
+
+    SharedMatrixBuffer input(gWorkspace.clientPid, SharedMatrixBuffer::Endpoint::Client, m, n, bufferIndex, SharedMatrixBuffer::BufferInitMode::Random, MATRIX_BUF_NAME_SUFFIX);
+    SharedMatrixBuffer output(gWorkspace.clientPid, SharedMatrixBuffer::Endpoint::Client, m, n, bufferIndex, SharedMatrixBuffer::BufferInitMode::Zero, TR_MATRIX_BUF_NAME_SUFFIX);
+    SharedMatrixBuffer reference(gWorkspace.clientPid, SharedMatrixBuffer::Endpoint::Client, m, n, bufferIndex, SharedMatrixBuffer::BufferInitMode::Zero, TR_GOLDEN_MATRIX_BUF_NAME_SUFFIX);
+
+    ClientServerMessage message;
+    ClientServerMessage::GenerateAddBuffersMessage(message, gWorkspace.clientPid, m, n, 1);
+    if (!ChangeServerBuffers(message) || gWorkspace.serverBufferCount != bufferIndex + 1)
+    {
+        return false;
+    }
+
+    uint32_t rowCount = 1 << n;
+    uint32_t columnCount = 1 << m;
+    ClientServerMessage::GenerateReshapeBufferMessage(message, gWorkspace.clientPid, bufferIndex, rowCount, columnCount);
+    if (!ChangeServerBuffers(message))
+    {
+        return false;
+    }
+
+    TransposeRequest request {};
+    request.op = TransposeOp::Transpose;
+    request.srcBuffer = bufferIndex;
+    request.dstBuffer = bufferIndex;
+    request.clientTag = clientTag;
+
+    SubmissionLane& lane = gWorkspace.lanes[0];
+    RequestRecord& record = (*lane.pRequestRecords)[request.clientTag % gWorkspace.buffers.k];
+    record.status.store(RequestStatus::Pending, std::memory_order_relaxed);
+    lane.pRequestQueue->Enqueue(request);
+    gWorkspace.pDoorbell->Ring(gWorkspace.serverSlot);
+    WaitForCompletion(lane, record);
+
+    bool transposed = record.status.load(std::memory_order_acquire) == RequestStatus::Completed;
+    if (transposed)
+    {
+        TransposeNaive(input.GetRawPointer(), reference.GetRawPointer(), rowCount, columnCount);
+        transposed = MatricesAreEqual(output.GetRawPointer(), reference.GetRawPointer(), columnCount, rowCount);
+    }
+    if (!transposed)
+    {
+        std::cout << "Client " << gWorkspace.clientPid << ": ERROR in reshaped buffer " << bufferIndex << std::endl;
+    }
+
+    // The buffers are unmapped on return, which is only safe once the server has dropped them
+    ClientServerMessage::GenerateRemoveBuffersMessage(message, gWorkspace.clientPid, 1);
+    return ChangeServerBuffers(message) && gWorkspace.serverBufferCount == bufferIndex && transposed;
+}
+
+// Lane l owns buffers l, l + laneCount, l + 2 * laneCount, ..., so lanes never share a buffer
+static uint32_t OwnedBufferCount(uint32_t laneIndex)
+{
+    return (gWorkspace.buffers.k - laneIndex + gWorkspace.laneCount - 1) / gWorkspace.laneCount;
+}
+
+static uint32_t OwnedBuffer(uint32_t laneIndex, uint32_t ownedIndex)
+{
+    return laneIndex + ownedIndex * gWorkspace.laneCount;
+}
+
+// Request number clientTag of a lane. Each repetition writes every owned input to the next owned
+// output buffer along, to exercise output rotation.
+static TransposeRequest LaneRequest(uint32_t laneIndex, uint32_t clientTag)
+{
+    uint32_t ownedCount = OwnedBufferCount(laneIndex);
+    uint32_t repetition = clientTag / ownedCount;
+    uint32_t ownedIndex = clientTag % ownedCount;
+
+    TransposeRequest request {};
+    request.op = TransposeOp::Transpose;
+    request.srcBuffer = OwnedBuffer(laneIndex, ownedIndex);
+    request.dstBuffer = OwnedBuffer(laneIndex, (ownedIndex + repetition) % ownedCount);
+    request.rowCount = 1 << gWorkspace.buffers.m;
+    request.columnCount = 1 << gWorkspace.buffers.n;
+    request.clientTag = clientTag;
+    return request;
+}
+
+static RequestRecord& LaneRecord(SubmissionLane& lane, uint32_t clientTag)
+{
+    return (*lane.pRequestRecords)[clientTag % gWorkspace.buffers.k];
+}
+
+static void SubmitRequest(uint32_t laneIndex, TransposeRequest request)
+{
+    SubmissionLane& lane = gWorkspace.lanes[laneIndex];
+
+    RequestRecord& record = LaneRecord(lane, request.clientTag);
+
+    lane.stats.StartTimer();
+    uint64_t submitNs = RequestClockNowNs();
+    request.deadlineNs = (gWorkspace.deadlineBudgetUs == 0) ? 0 : submitNs + gWorkspace.deadlineBudgetUs * 1000ULL;
+    record.timestamps.submitTicks = gWorkspace.timestampStages ? TscClock::Now() : 0;
+    record.status.store(RequestStatus::Pending, std::memory_order_relaxed);
+    lane.pRequestQueue->Enqueue(request);
+    gWorkspace.pDoorbell->Ring(gWorkspace.serverSlot + laneIndex);
+    TraceInstant(TraceEventId::Submit, laneIndex, request.clientTag);
+}
+
+static void FinishRequest(uint32_t laneIndex, uint32_t clientTag)
+{
+    SubmissionLane& lane = gWorkspace.lanes[laneIndex];
+    lane.stats.StopTimer();
+    TraceInstant(TraceEventId::Finish, laneIndex, clientTag);
+
+    RequestRecord& record = LaneRecord(lane, clientTag);
+    RequestStatus status = record.status.load(std::memory_order_acquire);
+    if (status != RequestStatus::Rejected && gWorkspace.timestampStages)
+    {
+        record.timestamps.resumeTicks = TscClock::Now();
+        RecordRequestStages(lane.stats, record.timestamps, RequestStage::Count);
+    }
+
+    if (status == RequestStatus::DeadlineMet || status == RequestStatus::DeadlineMissed)
+    {
+        lane.stats.RecordDeadlineOutcome(status == RequestStatus::DeadlineMet);
+    }
+    else if (status == RequestStatus::Rejected)
+    {
+        std::cout << "Client " << gWorkspace.clientPid << ": request " << clientTag << " on lane " << laneIndex << " rejected" << std::endl;
+    }
+}
+
+// Producer thread of a lane, waiting for each request on the lane's futex
+static void SubmitRequests(uint32_t laneIndex)
+{
+    SubmissionLane& lane = gWorkspace.lanes[laneIndex];
+    uint32_t requestCount = gWorkspace.requestRepetitions * OwnedBufferCount(laneIndex);
+    Tracer::SetThreadName("lane " + std::to_string(laneIndex));
+
+    for (uint32_t clientTag = 0; clientTag < requestCount; clientTag++)
+    {
+        SubmitRequest(laneIndex, LaneRequest(laneIndex, clientTag));
+        TraceBegin(TraceEventId::Wait, laneIndex, clientTag);
+        lane.pTransposeReadyFutex->Wait();
+        TraceEnd(TraceEventId::Wait);
+        FinishRequest(laneIndex, clientTag);
+    }
+}
+
+// Drives all lanes from one thread the way an application's event loop would: the completion
+// eventfd is one more descriptor in the epoll set, and every time it fires the lanes whose
+// request has finished get their next one.
+static void RunEventLoop()
+{
+    int epollFd = epoll_create1(EPOLL_CLOEXEC);
+    epoll_event event {};
+    event.events = EPOLLIN;
+    event.data.fd = gWorkspace.completionEventFd;
+    if (epollFd < 0 || epoll_ctl(epollFd, EPOLL_CTL_ADD, gWorkspace.completionEventFd, &event) < 0)
+    {
+        std::cerr << "Failed to set up epoll (errno: " << errno << "): " << strerror(errno) << std::endl;
+        return;
+    }
+
+    std::vector<uint32_t> nextTags(gWorkspace.laneCount, 0);
+    uint32_t busyLanes = 0;
+    for (uint32_t laneIndex = 0; laneIndex < gWorkspace.laneCount; laneIndex++)
+    {
+        if (gWorkspace.requestRepetitions > 0)
+        {
+            SubmitRequest(laneIndex, LaneRequest(laneIndex, 0));
+            busyLanes++;
+        }
+    }
+
+    while (busyLanes > 0)
+    {
+        int eventCount = epoll_wait(epollFd, &event, 1, -1);
+        if (eventCount <= 0)
+        {
+            continue;
+        }
+
+        // One read takes every completion signalled so far
+        uint64_t completions;
+        if (read(gWorkspace.completionEventFd, &completions, sizeof(completions)) != sizeof(completions))
+        {
+            continue;
+        }
+
+        for (uint32_t laneIndex = 0; laneIndex < gWorkspace.laneCount; laneIndex++)
+        {
+            uint32_t& clientTag = nextTags[laneIndex];
+            uint32_t requestCount = gWorkspace.requestRepetitions * OwnedBufferCount(laneIndex);
+            if (clientTag == requestCount ||
+                LaneRecord(gWorkspace.lanes[laneIndex], clientTag).status.load(std::memory_order_acquire) == RequestStatus::Pending)
+            {
+                continue;
+            }
+
+            FinishRequest(laneIndex, clientTag);
+            if (++clientTag < requestCount)
+            {
+                SubmitRequest(laneIndex, LaneRequest(laneIndex, clientTag));
+            }
+            else
+            {
+                busyLanes--;
+            }
+        }
+    }
+
+    close(epollFd);
 }
 
 int main(int argc, char* argv[])
 {
-    if (!ProcessArguments(argc, argv, gWorkspace.buffers.m, gWorkspace.buffers.n, gWorkspace.buffers.k, gWorkspace.requestRepetitions))
+    if (!ProcessArguments(argc, argv, gWorkspace.buffers.m, gWorkspace.buffers.n, gWorkspace.buffers.k, gWorkspace.requestRepetitions, gWorkspace.weight, gWorkspace.deadlineBudgetUs, gWorkspace.exerciseBufferChanges, gWorkspace.laneCount, gWorkspace.waitPolicy, gWorkspace.useEventLoop))
     {
         return 1;
     }
 
+    TscClock::Calibrate();
+    StartTracing();
+    if (!Logger::SetLevelFromEnvironment(LOG_LEVEL_ENVIRONMENT_VARIABLE.c_str()))
+    {
+        std::cerr << LOG_LEVEL_ENVIRONMENT_VARIABLE << " must be debug, info, warning, error or off, logging at " << Logger::LevelToString(Logger::GetLevel()) << std::endl;
+    }
+
     try
     {
         gWorkspace.clientPid = getpid();
-        gWorkspace.subscribeResponseReceived = false;
+        gWorkspace.subscribeResponseReceived.store(false, std::memory_order_relaxed);
         gWorkspace.pIpcClient = std::make_unique<UnixSockIpcClient<ClientServerMessage>>(SERVER_SOCKET_ADDRESS, MessageHandler);
-        gWorkspace.pTransposeReadyFutex = std::make_unique<FutexSignaller>(gWorkspace.clientPid, FutexSignaller::Role::Waiter, "");
-        gWorkspace.pRequestQueue = std::make_unique<SpscQueueSeqLock>(gWorkspace.clientPid, SpscQueueSeqLock::Role::Producer, REQ_QUEUE_CAPACITY, REQ_QUEUE_NAME_SUFFIX);
+
+        gWorkspace.completionEventFd = -1;
+        if (gWorkspace.useEventLoop)
+        {
+            // Non-blocking like the server makes it, as both share the one open file
+            gWorkspace.completionEventFd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+            if (gWorkspace.completionEventFd < 0)
+            {
+                throw std::runtime_error("Failed to create completion eventfd (errno: " + std::to_string(errno) + "): " + std::string(strerror(errno)));
+            }
+        }
+
+        gWorkspace.lanes.resize(gWorkspace.laneCount);
+        for (uint32_t laneIndex = 0; laneIndex < gWorkspace.laneCount; laneIndex++)
+        {
+            SubmissionLane& lane = gWorkspace.lanes[laneIndex];
+            lane.pTransposeReadyFutex = std::make_unique<FutexSignaller>(gWorkspace.clientPid, FutexSignaller::Role::Waiter, LaneNameSuffix("", laneIndex), gWorkspace.waitPolicy);
+            lane.pRequestQueue = std::make_unique<SpscQueueSequenced<TransposeRequest>>(gWorkspace.clientPid, SpscQueueSequenced<TransposeRequest>::Role::Producer, REQ_QUEUE_CAPACITY, LaneNameSuffix(REQ_QUEUE_NAME_SUFFIX, laneIndex));
+            lane.pRequestRecords = std::make_unique<RequestRecordTable>(gWorkspace.clientPid, RequestRecordTable::Endpoint::Client, gWorkspace.buffers.k, LaneNameSuffix(REQ_RECORD_NAME_SUFFIX, laneIndex));
+        }
 
         gWorkspace.matrixBuffers.reserve(gWorkspace.buffers.k);
         gWorkspace.matrixBuffersTr.reserve(gWorkspace.buffers.k);
@@ -94,23 +447,67 @@ int main(int argc, char* argv[])
     }
     
     ClientServerMessage subscribeMessage;
-    ClientServerMessage::GenerateSubscribeMessage(subscribeMessage, gWorkspace.clientPid, gWorkspace.buffers.m, gWorkspace.buffers.n, gWorkspace.buffers.k);
-    gWorkspace.pIpcClient->Send(subscribeMessage);
+    ClientServerMessage::GenerateSubscribeMessage(subscribeMessage, gWorkspace.clientPid, gWorkspace.buffers.m, gWorkspace.buffers.n, gWorkspace.buffers.k, gWorkspace.weight, gWorkspace.laneCount);
+    if (gWorkspace.useEventLoop)
+    {
+        // The server signals completions on its copy of the eventfd from then on
+        gWorkspace.pIpcClient->Send(subscribeMessage, gWorkspace.completionEventFd);
+    }
+    else
+    {
+        gWorkspace.pIpcClient->Send(subscribeMessage);
+    }
 
-    while (!gWorkspace.subscribeResponseReceived)
+    while (!gWorkspace.subscribeResponseReceived.load(std::memory_order_acquire))
     {
         std::this_thread::sleep_for(std::chrono::milliseconds(10));
     }
 
-    for (uint32_t repetition = 0; repetition < gWorkspace.requestRepetitions; repetition++)
+    // Before the lanes take any timestamps
+    gWorkspace.timestampStages = TscClock::Adopt(gWorkspace.serverUsesTsc);
+    if (!gWorkspace.timestampStages)
     {
-        for (int bufferIndex = 0; bufferIndex < gWorkspace.buffers.k; bufferIndex++)
+        std::cout << "Client " << gWorkspace.clientPid << ": server times with the TSC, which is not usable here, request stages are not timed" << std::endl;
+    }
+
+    try
+    {
+        gWorkspace.pDoorbell = std::make_unique<PendingWorkDoorbell>(gWorkspace.serverPid, PendingWorkDoorbell::Endpoint::Client, DOORBELL_NAME_SUFFIX);
+    }
+    catch(const std::exception& e)
+    {
+        std::cerr << e.what() << '\n';
+        return 1;
+    }
+
+    if (gWorkspace.useEventLoop)
+    {
+        RunEventLoop();
+    }
+    else
+    {
+        // Lanes are independent SPSC queues, so their producers need no locking between them
+        std::vector<std::thread> producers;
+        for (uint32_t laneIndex = 0; laneIndex < gWorkspace.laneCount; laneIndex++)
         {
-            gWorkspace.stats.StartTimer();
-            gWorkspace.pRequestQueue->Enqueue(bufferIndex);
-            gWorkspace.pTransposeReadyFutex->Wait();
-            gWorkspace.stats.StopTimer();
+            producers.emplace_back(SubmitRequests, laneIndex);
         }
+        for (uint32_t laneIndex = 0; laneIndex < gWorkspace.laneCount; laneIndex++)
+        {
+            producers[laneIndex].join();
+        }
+    }
+
+    for (uint32_t laneIndex = 0; laneIndex < gWorkspace.laneCount; laneIndex++)
+    {
+        gWorkspace.stats.Merge(gWorkspace.lanes[laneIndex].stats);
+    }
+
+    bool errorFound = false;
+    // Lane 0 has used client tags up to its request count
+    if (gWorkspace.exerciseBufferChanges && !ExerciseBufferChanges(gWorkspace.requestRepetitions * OwnedBufferCount(0)))
+    {
+        errorFound = true;
     }
 
     ClientServerMessage unsubscribeMessage;
@@ -122,22 +519,32 @@ int main(int argc, char* argv[])
               << ", m: "<< gWorkspace.buffers.m 
               << ", n: " << gWorkspace.buffers.n 
               << ", k: " << gWorkspace.buffers.k
+              << ", lanes: " << gWorkspace.laneCount
+              << ", wait: " << (gWorkspace.useEventLoop ? "epoll" : FutexSignaller::WaitPolicyToString(gWorkspace.waitPolicy))
               << ", reps: " << gWorkspace.requestRepetitions
               << ", reqs: " << gWorkspace.requestRepetitions * gWorkspace.buffers.k
-              << ", avgTime: " << gWorkspace.stats.GetAverageElapsedTimeUs() << " (ns)" << std::endl;
+              << ", " << gWorkspace.stats.GetLatencySummary()
+              << ", deadlinesMet: " << gWorkspace.stats.GetMetDeadlines()
+              << ", deadlinesMissed: " << gWorkspace.stats.GetMissedDeadlines() << std::endl;
+    std::clog << "client: " << gWorkspace.clientPid << ", " << GetRequestStagesSummary(gWorkspace.stats, RequestStage::Count) << std::endl;
 
-    bool errorFound = false;
+    // Output buffer written last for every input, among the buffers of the input's lane
     for (int bufferIndex = 0; bufferIndex < gWorkspace.buffers.k; bufferIndex++)
     {
+        uint32_t laneIndex = bufferIndex % gWorkspace.laneCount;
+        uint32_t ownedCount = OwnedBufferCount(laneIndex);
+        uint32_t outputIndex = OwnedBuffer(laneIndex, (bufferIndex / gWorkspace.laneCount + gWorkspace.requestRepetitions - 1) % ownedCount);
         TransposeNaive(gWorkspace.matrixBuffers[bufferIndex]->GetRawPointer(), gWorkspace.matrixBuffersTrReference[bufferIndex]->GetRawPointer(), 1 << gWorkspace.buffers.m, 1 << gWorkspace.buffers.n);
 
-        if (!MatricesAreEqual(gWorkspace.matrixBuffersTr[bufferIndex]->GetRawPointer(), gWorkspace.matrixBuffersTrReference[bufferIndex]->GetRawPointer(), 1 << gWorkspace.buffers.m, 1 << gWorkspace.buffers.n))
+        if (!MatricesAreEqual(gWorkspace.matrixBuffersTr[outputIndex]->GetRawPointer(), gWorkspace.matrixBuffersTrReference[bufferIndex]->GetRawPointer(), 1 << gWorkspace.buffers.m, 1 << gWorkspace.buffers.n))
         {
             std::cout << "Client " << gWorkspace.clientPid << ": ERROR in buffer " << bufferIndex << std::endl;
             errorFound = true;
         }
     }
 
+    FinishTracing();
+
     if (errorFound)
     {
         exit(1);
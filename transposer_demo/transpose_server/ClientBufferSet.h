@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "matrix-buf/SharedMatrixBuffer.h"
+
+struct BufferShape
+{
+    // Logical shape used by requests that do not give one
+    uint32_t rowCount;
+    uint32_t columnCount;
+
+    // Elements the buffer was created with, which bounds any shape used with it
+    uint64_t capacity;
+};
+
+// Immutable set of a client's input/output buffer pairs. Adding, removing or reshaping buffers
+// builds a new set that shares the unchanged mappings with the old one and publishes it through
+// the client's ClientHotData, so the dispatcher never waits for the change.
+struct ClientBufferSet
+{
+    std::vector<std::shared_ptr<SharedMatrixBuffer>> inputs;
+    std::vector<std::shared_ptr<SharedMatrixBuffer>> outputs;
+    std::vector<uint64_t*> srcBasePointers;
+    std::vector<uint64_t*> dstBasePointers;
+    std::vector<BufferShape> shapes;
+
+    uint32_t GetCount() const
+    {
+        return static_cast<uint32_t>(inputs.size());
+    }
+
+    void Append(std::shared_ptr<SharedMatrixBuffer> pInput, std::shared_ptr<SharedMatrixBuffer> pOutput)
+    {
+        srcBasePointers.push_back(pInput->GetRawPointer());
+        dstBasePointers.push_back(pOutput->GetRawPointer());
+        shapes.push_back({ pInput->RowCount(), pInput->ColumnCount(), pInput->GetElementCount() });
+        inputs.push_back(std::move(pInput));
+        outputs.push_back(std::move(pOutput));
+    }
+
+    void Truncate(uint32_t count)
+    {
+        inputs.resize(count);
+        outputs.resize(count);
+        srcBasePointers.resize(count);
+        dstBasePointers.resize(count);
+        shapes.resize(count);
+    }
+};
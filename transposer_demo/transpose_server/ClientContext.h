@@ -1,30 +1,105 @@
 #pragma once
 
+#include <atomic>
 #include <cstdint>
 #include <memory>
+#include <unistd.h>
 #include <vector>
 #include <unordered_map>
 
-#include "spsc-queue/SpscQueueSeqLock.h"
+#include "spsc-queue/SpscQueueSequenced.h"
 #include "futex/FutexSignaller.h"
 #include "matrix-buf/SharedMatrixBuffer.h"
 #include "unix-socks/UnixSockIpcServer.h"
 #include "shared-mem/SharedMemory.h"
 #include "BufferDimensions.h"
+#include "ClientBufferSet.h"
+#include "RequestRecordTable.h"
+#include "TransposeRequest.h"
+#include "TransposeJob.h"
 #include "ClientStats.h"
+#include "PerfCounterStats.h"
 
 using ClientId = uint32_t;
 
+// One submission lane of a client: a request queue with its own completion signal and request
+// records, fed by one producer thread of the client. The dispatcher schedules every lane as a
+// unit of its own, in its own registry slot.
+struct ClientLane
+{
+    uint32_t slot;
+    std::unique_ptr<SpscQueueSequenced<TransposeRequest>> pRequestQueue;
+    std::unique_ptr<FutexSignaller> pTransposeReadyFutex;
+    std::unique_ptr<RequestRecordTable> pRequestRecords;
+    std::unique_ptr<TransposeJob> pJob;
+    ClientStats stats;
+
+    // Hardware counts of the lane's requests by shape, written by the worker completing a request
+    PerfCounterStats perfStats;
+
+    // Moving average of dispatch-to-completion time, written by the worker finishing a request
+    uint64_t serviceTimeEstimateNs { 0 };
+};
+
 struct ClientContext
 {
     bool subscribed { false };
     ClientId id;
     BufferDimensions matrixSize;
-    ClientStats stats;
+    uint32_t weight;
     UnixSockIpcContext ipcContext;
-    std::vector<std::unique_ptr<SharedMatrixBuffer>> matrixBuffers;
-    std::vector<std::unique_ptr<SharedMatrixBuffer>> matrixBuffersTr;
-    std::unique_ptr<SpscQueueSeqLock> pRequestQueue;
-    std::unique_ptr<FutexSignaller> pTransposeReadyFutex;
-};
 
+    // Current buffer set, also published in the ClientHotData of every lane. Replaced sets are
+    // retired through the ClientRegistry.
+    std::unique_ptr<ClientBufferSet> pBuffers;
+
+    // Fixed at subscription
+    std::vector<ClientLane> lanes;
+
+    // Fair queuing finish tag shared by the lanes, so that opening more lanes does not give the
+    // client a larger share. Only touched by the dispatcher.
+    uint64_t virtualFinishTag { 0 };
+
+    // Server-wide bytes transposed when the client subscribed and unsubscribed, used to report
+    // its share
+    uint64_t serverBytesAtSubscribe { 0 };
+    uint64_t serverBytesAtUnsubscribe { 0 };
+
+    // Eventfd the client passed at subscribe to be told about completions instead of through the
+    // futex of each lane, or -1. Completions are counted by the workers and added to the eventfd
+    // by the dispatcher with one write per client and pass.
+    int completionEventFd { -1 };
+    std::atomic<uint64_t> unsignalledCompletions { 0 };
+
+    ~ClientContext()
+    {
+        if (completionEventFd >= 0)
+        {
+            close(completionEventFd);
+        }
+    }
+
+    // Stats of all lanes together. The dispatcher and the workers write the lane stats without
+    // synchronisation, so this is only called by the dispatcher once no worker runs a request of
+    // the client any more.
+    ClientStats GetStats() const
+    {
+        ClientStats stats;
+        for (const ClientLane& lane : lanes)
+        {
+            stats.Merge(lane.stats);
+        }
+        return stats;
+    }
+
+    // Same as GetStats(): a worker completing a request can insert into a lane's map
+    PerfCounterStats GetPerfStats() const
+    {
+        PerfCounterStats perfStats;
+        for (const ClientLane& lane : lanes)
+        {
+            perfStats.Merge(lane.perfStats);
+        }
+        return perfStats;
+    }
+};
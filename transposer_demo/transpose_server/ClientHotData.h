@@ -0,0 +1,63 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+#include "ClientBufferSet.h"
+#include "spsc-queue/SpscQueueSequenced.h"
+#include "TransposeJob.h"
+#include "TransposeRequest.h"
+
+struct ClientContext;
+struct ClientLane;
+
+// What the dispatcher reads and writes when it visits a client lane, kept in one contiguous array
+// indexed by slot. The first cache line is set at subscription and resolves a request
+// to its buffers without going through the shared memory wrappers; the other two are scheduling
+// state only touched by the dispatcher. Everything else stays in the cold ClientContext.
+struct alignas(64) ClientHotData
+{
+    SpscQueueSequenced<TransposeRequest>* pRequestQueue;
+    TransposeJob* pJob;
+
+    // Latest buffer set of the client, replaced by the control thread when buffers change
+    std::atomic<const ClientBufferSet*> pBuffers;
+
+    TileRangeKernel kernel;
+    uint32_t weight;
+
+    // Request taken off the queue that is waiting for idle workers
+    alignas(64) bool requestStaged;
+
+    // Staged request is the suspended job of the client rather than a new request
+    bool stagedResume;
+
+    // Staged request has a deadline that the client's recent service time can still meet
+    bool stagedDeadlineAdmitted;
+
+    // Client is told about completions through its eventfd rather than the lane futex
+    bool completionsBatched;
+
+    // Tiles and bytes moved (every element read once and written once) of the staged or running request
+    uint32_t tileCount;
+    uint64_t requestBytes;
+
+    // Weighted fair queuing start tag in bytes divided by weight (start-time fair queuing)
+    uint64_t stagedStartTag;
+
+    ClientContext* pClient;
+    ClientLane* pLane;
+
+    // Buffers of the staged request, resolved against the buffer set it was validated with
+    uint64_t* pStagedSrc;
+    uint64_t* pStagedDst;
+
+    // That buffer set, which the staged request and the job it becomes keep using. The registry
+    // does not free a replaced set while a staged request or a job that is not idle refers to it.
+    const ClientBufferSet* pStagedBuffers;
+
+    // Copy of the staged request with its shape filled in
+    TransposeRequest stagedRequest;
+};
+
+static_assert(sizeof(ClientHotData) == 192, "ClientHotData should span exactly three cache lines");
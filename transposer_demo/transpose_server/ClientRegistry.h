@@ -0,0 +1,359 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "bitmap/HierarchicalBitmap.h"
+#include "ClientContext.h"
+#include "ClientHotData.h"
+#include "Constants.h"
+
+using MatrixTransposer::Constants::MAX_CLIENTS;
+
+// Immutable snapshot of the subscribed clients. A new table is published for every change.
+struct ClientTable
+{
+    uint64_t generation { 0 };
+    HierarchicalBitmap<MAX_CLIENTS> validClients;
+};
+
+// RCU-style client registry with a single writer (the control thread handling subscribe and
+// unsubscribe messages) and a single reader (the workload dispatcher).
+//
+// The writer copies the current table, changes the copy and publishes it with one atomic
+// exchange, so subscribing and unsubscribing never wait for the dispatcher. Replaced tables and
+// removed client contexts are handed to the dispatcher, which frees them once it has moved on to
+// a newer table and no worker is still running a request of the removed client.
+//
+// Every lane of a client takes a slot of its own, and the lanes of a client take consecutive
+// slots so that a client can find its doorbell bits from the first one. Per-lane data lives in a
+// fixed array indexed by slot rather than in the tables. The writer
+// fills a slot's entry before publishing a table that contains the slot, and a removed client's
+// slot stays reserved until the dispatcher has freed the client, so an entry never changes while
+// the dispatcher may still be using it. A client's buffer set is replaced the same way: the old
+// set is freed once no staged request or unfinished job of any of the client's lanes refers to it.
+class ClientRegistry
+{
+public:
+    static constexpr int32_t NO_FREE_SLOT = -1;
+
+    ClientRegistry() :
+        m_Published(new ClientTable()),
+        m_RetiredHead(nullptr),
+        mp_HotData(std::make_unique<ClientHotData[]>(MAX_CLIENTS)),
+        mp_ReaderTable(nullptr)
+    {
+    }
+
+    // Must only be destroyed once the dispatcher and the worker pool have stopped
+    ~ClientRegistry()
+    {
+        ClientTable* pTable = m_Published.load(std::memory_order_acquire);
+        pTable->validClients.ForEachSet([&](uint32_t slot)
+        {
+            // Once per client, from its first lane
+            if (mp_HotData[slot].pLane == &mp_HotData[slot].pClient->lanes.front())
+            {
+                delete mp_HotData[slot].pClient;
+            }
+        });
+        delete pTable;
+
+        CollectRetired();
+        for (RetiredItem* pItem : m_Deferred)
+        {
+            Free(pItem);
+        }
+    }
+
+    // Writer side: latest table, which stays valid until the writer publishes again
+    const ClientTable& GetWriterTable() const
+    {
+        return *m_Published.load(std::memory_order_relaxed);
+    }
+
+    // Writer side: client whose first lane is in a slot of the latest table
+    const ClientContext& GetClient(uint32_t slot) const
+    {
+        return *mp_HotData[slot].pClient;
+    }
+
+    ClientContext& GetClient(uint32_t slot)
+    {
+        return *mp_HotData[slot].pClient;
+    }
+
+    // Adds the lanes of the client to the first run of consecutive slots that are neither in use
+    // nor waiting to be reclaimed. Returns the slot of the first lane, or NO_FREE_SLOT when the
+    // registry has no such run.
+    int32_t Add(std::unique_ptr<ClientContext> pClient, TileRangeKernel kernel)
+    {
+        uint32_t laneCount = static_cast<uint32_t>(pClient->lanes.size());
+        int32_t firstSlot = ReserveSlots(laneCount);
+        if (firstSlot == NO_FREE_SLOT)
+        {
+            return NO_FREE_SLOT;
+        }
+
+        ClientTable* pNewTable = new ClientTable(GetWriterTable());
+        ClientContext* pAddedClient = pClient.release();
+        for (uint32_t laneIndex = 0; laneIndex < laneCount; laneIndex++)
+        {
+            ClientLane& lane = pAddedClient->lanes[laneIndex];
+            lane.slot = firstSlot + laneIndex;
+
+            ClientHotData& hotData = mp_HotData[lane.slot];
+            hotData.pRequestQueue = lane.pRequestQueue.get();
+            hotData.pJob = lane.pJob.get();
+            hotData.pBuffers.store(pAddedClient->pBuffers.get(), std::memory_order_relaxed);
+            hotData.kernel = kernel;
+            hotData.weight = pAddedClient->weight;
+            hotData.requestStaged = false;
+            hotData.stagedResume = false;
+            hotData.stagedStartTag = 0;
+            hotData.pStagedBuffers = nullptr;
+            hotData.completionsBatched = (pAddedClient->completionEventFd >= 0);
+            hotData.pClient = pAddedClient;
+            hotData.pLane = &lane;
+
+            pNewTable->validClients.Set(lane.slot);
+        }
+
+        Publish(pNewTable, RetiredItem { 0, nullptr, nullptr, nullptr, static_cast<uint32_t>(firstSlot), nullptr });
+
+        return firstSlot;
+    }
+
+    void Remove(uint32_t firstSlot)
+    {
+        ClientContext* pClient = mp_HotData[firstSlot].pClient;
+
+        ClientTable* pNewTable = new ClientTable(GetWriterTable());
+        for (const ClientLane& lane : pClient->lanes)
+        {
+            pNewTable->validClients.Clear(lane.slot);
+        }
+
+        Publish(pNewTable, RetiredItem { 0, nullptr, pClient, nullptr, firstSlot, nullptr });
+    }
+
+    // Makes the new set the client's current buffer set. Requests staged from now on use it.
+    void ReplaceBuffers(uint32_t firstSlot, std::unique_ptr<ClientBufferSet> pNewBuffers)
+    {
+        ClientContext& client = *mp_HotData[firstSlot].pClient;
+        ClientBufferSet* pOldBuffers = client.pBuffers.release();
+        client.pBuffers = std::move(pNewBuffers);
+        for (const ClientLane& lane : client.lanes)
+        {
+            mp_HotData[lane.slot].pBuffers.store(client.pBuffers.get(), std::memory_order_release);
+        }
+
+        // Publishing a new table gives the old set a generation the dispatcher has to pass
+        Publish(new ClientTable(GetWriterTable()), RetiredItem { 0, nullptr, nullptr, pOldBuffers, firstSlot, nullptr });
+    }
+
+    // Reader side: returns the latest table. Tables returned by earlier calls must not be used
+    // after this call.
+    const ClientTable& Acquire()
+    {
+        mp_ReaderTable = m_Published.load(std::memory_order_acquire);
+        return *mp_ReaderTable;
+    }
+
+    // Reader side: entry of a slot in the table returned by the last Acquire()
+    ClientHotData& GetHotData(uint32_t slot)
+    {
+        return mp_HotData[slot];
+    }
+
+    // Reader side: frees everything retired before the table returned by the last Acquire().
+    // onClientFreed is called with each removed client right before it is freed, once no worker
+    // is running a request of any of its lanes.
+    template <typename OnClientFreed>
+    void ReclaimRetired(OnClientFreed onClientFreed)
+    {
+        CollectRetired();
+
+        // Buffer sets before clients, so that a removed client is only freed after its old sets
+        size_t kept = 0;
+        for (RetiredItem* pItem : m_Deferred)
+        {
+            if (pItem->pClient == nullptr && CanFree(*pItem))
+            {
+                Free(pItem);
+            }
+            else
+            {
+                m_Deferred[kept++] = pItem;
+            }
+        }
+        m_Deferred.resize(kept);
+
+        kept = 0;
+        for (RetiredItem* pItem : m_Deferred)
+        {
+            if (pItem->pClient != nullptr && CanFree(*pItem))
+            {
+                onClientFreed(*pItem->pClient);
+                for (const ClientLane& lane : pItem->pClient->lanes)
+                {
+                    m_ReservedSlots[lane.slot / 64].fetch_and(~(1ULL << (lane.slot % 64)), std::memory_order_release);
+                }
+                Free(pItem);
+            }
+            else
+            {
+                m_Deferred[kept++] = pItem;
+            }
+        }
+        m_Deferred.resize(kept);
+    }
+
+    bool HasRetired() const
+    {
+        return !m_Deferred.empty() || m_RetiredHead.load(std::memory_order_relaxed) != nullptr;
+    }
+
+private:
+    // A replaced table, plus the removed client or replaced buffer set of the change, if any.
+    // slot is the first slot of the client the change was about.
+    struct RetiredItem
+    {
+        // Generation of the table that replaced the retired one
+        uint64_t retireGeneration;
+        ClientTable* pTable;
+        ClientContext* pClient;
+        ClientBufferSet* pBuffers;
+        uint32_t slot;
+        RetiredItem* pNext;
+    };
+
+    bool CanFree(const RetiredItem& item) const
+    {
+        if (item.retireGeneration > mp_ReaderTable->generation)
+        {
+            return false;
+        }
+
+        if (item.pClient != nullptr)
+        {
+            // Old buffer sets of the client are still waiting
+            for (const RetiredItem* pItem : m_Deferred)
+            {
+                if (pItem->pBuffers != nullptr && pItem->slot == item.slot && pItem->retireGeneration < item.retireGeneration)
+                {
+                    return false;
+                }
+            }
+
+            // A suspended job of a removed client is never resumed
+            for (const ClientLane& lane : item.pClient->lanes)
+            {
+                if (lane.pJob->state.load(std::memory_order_acquire) == JobState::Running)
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        if (item.pBuffers != nullptr)
+        {
+            // Only lanes whose staged request or job was resolved against this very set hold it
+            // back, so a client that keeps its other lanes busy does not keep old sets mapped.
+            // The client may have been removed since, but it is only freed after this set.
+            bool clientRemoved = !mp_ReaderTable->validClients.Test(item.slot);
+            for (const ClientLane& lane : mp_HotData[item.slot].pClient->lanes)
+            {
+                const ClientHotData& hotData = mp_HotData[lane.slot];
+                if (hotData.pStagedBuffers != item.pBuffers)
+                {
+                    continue;
+                }
+
+                JobState jobState = hotData.pJob->state.load(std::memory_order_acquire);
+                bool inUse = clientRemoved ? (jobState == JobState::Running) : (hotData.requestStaged || jobState != JobState::Idle);
+                if (inUse)
+                {
+                    return false;
+                }
+            }
+        }
+
+        return true;
+    }
+
+    static void Free(RetiredItem* pItem)
+    {
+        delete pItem->pTable;
+        delete pItem->pClient;
+        delete pItem->pBuffers;
+        delete pItem;
+    }
+
+    // Only the writer reserves slots, so a run it finds free stays free while it reserves it
+    int32_t ReserveSlots(uint32_t count)
+    {
+        uint32_t runLength = 0;
+        for (uint32_t slot = 0; slot < MAX_CLIENTS; slot++)
+        {
+            // Pairs with the release in ReclaimRetired(): the dispatcher is done with the entry
+            uint64_t word = m_ReservedSlots[slot / 64].load(std::memory_order_acquire);
+            if (word == ~0ULL)
+            {
+                runLength = 0;
+                slot |= 63;
+                continue;
+            }
+
+            runLength = (word & (1ULL << (slot % 64))) ? 0 : runLength + 1;
+            if (runLength == count)
+            {
+                uint32_t firstSlot = slot + 1 - count;
+                for (uint32_t reservedSlot = firstSlot; reservedSlot <= slot; reservedSlot++)
+                {
+                    m_ReservedSlots[reservedSlot / 64].fetch_or(1ULL << (reservedSlot % 64), std::memory_order_relaxed);
+                }
+                return firstSlot;
+            }
+        }
+        return NO_FREE_SLOT;
+    }
+
+    void Publish(ClientTable* pNewTable, RetiredItem retired)
+    {
+        pNewTable->generation++;
+        ClientTable* pOldTable = m_Published.exchange(pNewTable, std::memory_order_acq_rel);
+
+        RetiredItem* pItem = new RetiredItem(retired);
+        pItem->retireGeneration = pNewTable->generation;
+        pItem->pTable = pOldTable;
+        pItem->pNext = m_RetiredHead.load(std::memory_order_relaxed);
+        while (!m_RetiredHead.compare_exchange_weak(pItem->pNext, pItem, std::memory_order_release, std::memory_order_relaxed));
+    }
+
+    void CollectRetired()
+    {
+        RetiredItem* pItem = m_RetiredHead.exchange(nullptr, std::memory_order_acquire);
+        while (pItem != nullptr)
+        {
+            m_Deferred.push_back(pItem);
+            pItem = pItem->pNext;
+        }
+    }
+
+    std::atomic<ClientTable*> m_Published;
+    std::atomic<RetiredItem*> m_RetiredHead;
+
+    // Slots in use or waiting to be reclaimed, set by the writer and cleared by the reader
+    std::array<std::atomic<uint64_t>, MAX_CLIENTS / 64> m_ReservedSlots {};
+
+    std::unique_ptr<ClientHotData[]> mp_HotData;
+
+    // Only touched by the reader
+    ClientTable* mp_ReaderTable;
+    std::vector<RetiredItem*> m_Deferred;
+};
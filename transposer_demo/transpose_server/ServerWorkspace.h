@@ -5,22 +5,40 @@
 #include <shared_mutex>
 #include <vector>
 #include <thread>
+#include <unordered_map>
 
 #include "ClientContext.h"
+#include "ClientRegistry.h"
 #include "unix-socks/UnixSockIpcServer.h"
 #include "ClientServerMessage.h"
-#include "spsc-queue/SpscQueueSeqLock.h"
+#include "PendingWorkDoorbell.h"
+#include "ServerMetricsPage.h"
+#include "spsc-queue/SpscQueueSequenced.h"
+#include "WorkerPool.h"
 
 
-using ClientBank = std::vector<ClientContext>;
-
 struct ServerWorkspace
 {
     bool running;
     uint32_t numWorkerThreads;
+    uint64_t timeSliceNs;
+
+    // Workers count hardware events of every request, see PerfCounterGroup
+    bool countPerfEvents { false };
     uint32_t serverPid;
-    ClientBank clientBank;
+    ClientRegistry clientRegistry;
+
+    // Slot of every subscribed client, only touched by the control thread
+    std::unordered_map<ClientId, uint32_t> clientSlots;
+    std::unique_ptr<PendingWorkDoorbell> pDoorbell;
+    std::unique_ptr<ServerMetricsPage> pMetricsPage;
     std::unique_ptr<UnixSockIpcServer<ClientServerMessage>> pIpcServer;
-    std::atomic<bool> clientBankUpdateAvailable { false };
-    uint64_t validClientsBitSet { 0 };
+    std::unique_ptr<WorkerPool> pWorkerPool;
+
+    // Start tag of the most recently dispatched request, only touched by the dispatcher
+    uint64_t virtualTime { 0 };
+    std::atomic<uint64_t> totalBytesTransposed { 0 };
+
+    // steady_clock nanoseconds
+    uint64_t startTimeNs { 0 };
 };
\ No newline at end of file
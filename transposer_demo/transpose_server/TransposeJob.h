@@ -0,0 +1,68 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+#include "PerfCounterGroup.h"
+
+struct ClientContext;
+struct ClientLane;
+
+// Transposes tiles [firstTile, endTile) of a tiled transpose, see TransposeTiledTileRange()
+using TileRangeKernel = void (*)(uint64_t* src, uint64_t* dst, uint32_t rowCount, uint32_t colCount, uint32_t tileSize, uint32_t firstTile, uint32_t endTile);
+
+enum class JobState : uint32_t
+{
+    Idle,
+    Running,
+    // Preempted between two chunks with tiles left, waiting to be resumed by the dispatcher
+    Suspended,
+};
+
+// One transpose request of a client lane. Each lane owns a single job object that is reused for
+// every request, since a lane never has more than one request being executed.
+struct TransposeJob
+{
+    ClientContext* pClient;
+    ClientLane* pLane;
+    // Kept here for the trace events of the workers, which do not see the client context
+    uint32_t clientId;
+    uint32_t clientTag;
+    // Request record the outcome is written to
+    uint32_t recordIndex;
+    uint64_t deadlineNs;
+    uint64_t dispatchTimeNs;
+    // TscClock ticks, set by the worker that claims the first chunk
+    uint64_t kernelStartTicks;
+    TileRangeKernel kernel;
+    uint64_t* pSrc;
+    uint64_t* pDst;
+    uint32_t rowCount;
+    uint32_t columnCount;
+    uint32_t tileCount;
+
+    // Workers claim tiles in chunks of this many, and only check for preemption between chunks
+    uint32_t chunkTiles;
+
+    // Workers given to the job and the time it was last started or resumed, set by the dispatcher
+    uint32_t width;
+    uint64_t lastStartNs;
+
+    // Fair queuing start tag the job is put back at when it is suspended
+    uint64_t resumeAfterTag;
+
+    // First tile not yet claimed by a worker
+    std::atomic<uint32_t> nextTile { 0 };
+
+    // Number of workers that have not left the job yet
+    std::atomic<uint32_t> remainingParts { 0 };
+
+    std::atomic<bool> preemptRequested { false };
+    std::atomic<JobState> state { JobState::Idle };
+
+    // Hardware counts of the request summed over every worker that ran a part of it, when the
+    // workers count hardware events. Reset by the dispatcher for each new request.
+    std::array<std::atomic<uint64_t>, PERF_COUNTER_COUNT> perfCounts {};
+    std::atomic<uint32_t> perfAvailableMask { 0 };
+};
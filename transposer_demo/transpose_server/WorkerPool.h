@@ -0,0 +1,281 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "Logger.h"
+#include "PerfCounterGroup.h"
+#include "TraceEvents.h"
+#include "TransposeJob.h"
+#include "TscClock.h"
+
+using JobCompletionHandler = void (*)(TransposeJob&);
+
+// Fixed set of long-lived worker threads. The dispatcher hands each request to a disjoint subset
+// of idle workers, so requests from different clients run concurrently on separate cores instead
+// of being serialized behind each other. Workers claim tiles of a job chunk by chunk and leave the
+// job early when the dispatcher requests preemption; the last worker to leave either completes
+// the job or marks it suspended so that it can be resumed later.
+//
+// With countPerfEvents, every worker opens a PerfCounterGroup on its own thread and adds the
+// counts of each job part it runs to the job. A worker that cannot open one runs without it.
+class WorkerPool
+{
+public:
+    WorkerPool(uint32_t numWorkers, uint32_t tileSize, uint32_t spinCount, JobCompletionHandler onJobComplete, bool countPerfEvents = false) :
+        m_NumWorkers(numWorkers),
+        m_TileSize(tileSize),
+        m_SpinCount(spinCount),
+        m_CountPerfEvents(countPerfEvents),
+        m_OnJobComplete(onJobComplete),
+        mp_Slots(std::make_unique<WorkerSlot[]>(numWorkers))
+    {
+        m_BatchSlots.reserve(m_NumWorkers);
+        m_Threads.reserve(m_NumWorkers);
+        for (uint32_t workerIndex = 0; workerIndex < m_NumWorkers; workerIndex++)
+        {
+            m_Threads.emplace_back(&WorkerPool::WorkerThread, this, workerIndex);
+        }
+    }
+
+    ~WorkerPool()
+    {
+        for (uint32_t workerIndex = 0; workerIndex < m_NumWorkers; workerIndex++)
+        {
+            WorkerSlot& slot = mp_Slots[workerIndex];
+
+            // Let any assigned task finish before asking the worker to stop
+            while (slot.state.load(std::memory_order_acquire) == SlotState::Assigned)
+            {
+                std::this_thread::yield();
+            }
+
+            slot.state.store(SlotState::Stop, std::memory_order_release);
+            slot.state.notify_one();
+        }
+
+        for (auto& thread : m_Threads)
+        {
+            thread.join();
+        }
+    }
+
+    uint32_t GetWorkerCount() const
+    {
+        return m_NumWorkers;
+    }
+
+    uint32_t CountIdleWorkers() const
+    {
+        uint32_t idleCount = 0;
+        for (uint32_t workerIndex = 0; workerIndex < m_NumWorkers; workerIndex++)
+        {
+            if (mp_Slots[workerIndex].state.load(std::memory_order_acquire) == SlotState::Idle)
+            {
+                idleCount++;
+            }
+        }
+        return idleCount;
+    }
+
+    // Job parts the worker has run and the TscClock ticks it spent on them, including the
+    // completion handler. Written only by the worker, so they may lag behind by one job part.
+    void GetWorkerCounters(uint32_t workerIndex, uint64_t& jobParts, uint64_t& busyTicks) const
+    {
+        const WorkerSlot& slot = mp_Slots[workerIndex];
+        jobParts = slot.jobParts.load(std::memory_order_relaxed);
+        busyTicks = slot.busyTicks.load(std::memory_order_relaxed);
+    }
+
+    // Starts or resumes the job on `width` idle workers.
+    // Must only be called from the dispatcher thread with at least `width` idle workers.
+    void Dispatch(TransposeJob& job, uint32_t width)
+    {
+        job.width = width;
+        job.remainingParts.store(width, std::memory_order_relaxed);
+        job.state.store(JobState::Running, std::memory_order_relaxed);
+
+        uint32_t part = 0;
+        for (uint32_t workerIndex = 0; workerIndex < m_NumWorkers && part < width; workerIndex++)
+        {
+            WorkerSlot& slot = mp_Slots[workerIndex];
+            if (slot.state.load(std::memory_order_acquire) != SlotState::Idle)
+            {
+                continue;
+            }
+
+            slot.pJob = &job;
+            slot.state.store(SlotState::Assigned, std::memory_order_release);
+            slot.state.notify_one();
+            part++;
+        }
+    }
+
+    // Starts each job on a single worker of its own, assigning the whole batch in one pass over
+    // the pool and waking the workers only once all of them have their job.
+    // Must only be called from the dispatcher thread with at least `jobCount` idle workers.
+    void DispatchBatch(TransposeJob* const* jobs, uint32_t jobCount)
+    {
+        m_BatchSlots.clear();
+
+        uint32_t jobIndex = 0;
+        for (uint32_t workerIndex = 0; workerIndex < m_NumWorkers && jobIndex < jobCount; workerIndex++)
+        {
+            WorkerSlot& slot = mp_Slots[workerIndex];
+            if (slot.state.load(std::memory_order_acquire) != SlotState::Idle)
+            {
+                continue;
+            }
+
+            TransposeJob& job = *jobs[jobIndex++];
+            job.width = 1;
+            job.remainingParts.store(1, std::memory_order_relaxed);
+            job.state.store(JobState::Running, std::memory_order_relaxed);
+
+            slot.pJob = &job;
+            slot.state.store(SlotState::Assigned, std::memory_order_release);
+            m_BatchSlots.push_back(workerIndex);
+        }
+
+        for (uint32_t workerIndex : m_BatchSlots)
+        {
+            mp_Slots[workerIndex].state.notify_one();
+        }
+    }
+
+private:
+    struct SlotState
+    {
+        static constexpr uint32_t Idle = 0;
+        static constexpr uint32_t Assigned = 1;
+        static constexpr uint32_t Stop = 2;
+    };
+
+    struct alignas(64) WorkerSlot
+    {
+        std::atomic<uint32_t> state { SlotState::Idle };
+        TransposeJob* pJob { nullptr };
+        std::atomic<uint64_t> jobParts { 0 };
+        std::atomic<uint64_t> busyTicks { 0 };
+    };
+
+    // Adds the counts of the job part that started at startCounts
+    static void AddPerfCounts(TransposeJob& job, const PerfCounterGroup& perfCounters, const PerfCounterValues& startCounts)
+    {
+        PerfCounterValues endCounts;
+        if (!perfCounters.Read(endCounts))
+        {
+            return;
+        }
+
+        PerfCounterValues partCounts = PerfCounterGroup::Difference(endCounts, startCounts);
+        for (uint32_t counter = 0; counter < PERF_COUNTER_COUNT; counter++)
+        {
+            job.perfCounts[counter].fetch_add(partCounts.counts[counter], std::memory_order_relaxed);
+        }
+        job.perfAvailableMask.fetch_or(partCounts.availableMask, std::memory_order_relaxed);
+    }
+
+    void WorkerThread(uint32_t workerIndex)
+    {
+        WorkerSlot& slot = mp_Slots[workerIndex];
+        Tracer::SetThreadName("worker " + std::to_string(workerIndex));
+        Logger::PrepareThread();
+
+        // Counts the events of this thread, so it is opened here
+        std::unique_ptr<PerfCounterGroup> pPerfCounters;
+        if (m_CountPerfEvents)
+        {
+            pPerfCounters = std::make_unique<PerfCounterGroup>();
+            if (!pPerfCounters->IsAvailable())
+            {
+                pPerfCounters.reset();
+            }
+        }
+
+        while (true)
+        {
+            uint32_t state = slot.state.load(std::memory_order_acquire);
+
+            // Spin for a short while to pick up back-to-back requests without a futex round trip
+            for (uint32_t spin = 0; state == SlotState::Idle && spin < m_SpinCount; spin++)
+            {
+                state = slot.state.load(std::memory_order_acquire);
+            }
+
+            if (state == SlotState::Idle)
+            {
+                slot.state.wait(SlotState::Idle, std::memory_order_acquire);
+                continue;
+            }
+
+            if (state == SlotState::Stop)
+            {
+                return;
+            }
+
+            uint64_t startTicks = TscClock::Now();
+            TransposeJob& job = *slot.pJob;
+            TraceBegin(TraceEventId::JobPart, job.clientId, job.clientTag);
+
+            PerfCounterValues startCounts;
+            bool countingPart = (pPerfCounters != nullptr) && pPerfCounters->Read(startCounts);
+            while (!job.preemptRequested.load(std::memory_order_relaxed))
+            {
+                uint32_t firstTile = job.nextTile.fetch_add(job.chunkTiles, std::memory_order_relaxed);
+                if (firstTile >= job.tileCount)
+                {
+                    break;
+                }
+
+                if (firstTile == 0)
+                {
+                    job.kernelStartTicks = TscClock::Now();
+                }
+
+                uint32_t endTile = std::min(firstTile + job.chunkTiles, job.tileCount);
+                TraceBegin(TraceEventId::TileChunk, firstTile, endTile);
+                job.kernel(job.pSrc, job.pDst, job.rowCount, job.columnCount, m_TileSize, firstTile, endTile);
+                TraceEnd(TraceEventId::TileChunk);
+            }
+
+            // Before leaving, so that the worker completing the job sees the counts of every part
+            if (countingPart)
+            {
+                AddPerfCounts(job, *pPerfCounters, startCounts);
+            }
+
+            // Every claimed chunk has been finished by the time its worker leaves the job
+            if (job.remainingParts.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            {
+                if (job.nextTile.load(std::memory_order_relaxed) >= job.tileCount)
+                {
+                    m_OnJobComplete(job);
+                }
+                else
+                {
+                    job.state.store(JobState::Suspended, std::memory_order_release);
+                }
+            }
+            TraceEnd(TraceEventId::JobPart);
+
+            // Single writer, so a plain add keeps the hot path free of locked instructions
+            slot.jobParts.store(slot.jobParts.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            slot.busyTicks.store(slot.busyTicks.load(std::memory_order_relaxed) + (TscClock::Now() - startTicks), std::memory_order_relaxed);
+            slot.state.store(SlotState::Idle, std::memory_order_release);
+        }
+    }
+
+    uint32_t m_NumWorkers;
+    uint32_t m_TileSize;
+    uint32_t m_SpinCount;
+    bool m_CountPerfEvents;
+    JobCompletionHandler m_OnJobComplete;
+    std::unique_ptr<WorkerSlot[]> mp_Slots;
+    std::vector<uint32_t> m_BatchSlots;
+    std::vector<std::thread> m_Threads;
+};
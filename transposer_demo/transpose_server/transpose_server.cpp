@@ -1,6 +1,10 @@
+#include <algorithm>
 #include <atomic>
+#include <cerrno>
 #include <cstdint>
 #include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
 #include <iostream>
 #include <memory>
 #include <sstream>
@@ -12,12 +16,18 @@
 #include "ClientContext.h"
 #include "ClientServerMessage.h"
 #include "Constants.h"
+#include "bitmap/HierarchicalBitmap.h"
 #include "futex/FutexSignaller.h"
+#include "log/Logger.h"
 #include "mat-transpose/mat-transpose.h"
 #include "matrix-buf/SharedMatrixBuffer.h"
 #include "presentation/Table.h"
+#include "RequestStages.h"
+#include "ServerMetricsPage.h"
 #include "ServerWorkspace.h"
+#include "TraceEvents.h"
 #include "unix-socks/UnixSockIpcServer.h"
+#include "WorkerPool.h"
 
 using std::unique_ptr;
 using std::unordered_map;
@@ -27,60 +37,59 @@ using MatrixTransposer::Constants::SERVER_SOCKET_ADDRESS;
 using MatrixTransposer::Constants::MATRIX_BUF_NAME_SUFFIX;
 using MatrixTransposer::Constants::TR_MATRIX_BUF_NAME_SUFFIX;
 using MatrixTransposer::Constants::REQ_QUEUE_NAME_SUFFIX;
+using MatrixTransposer::Constants::REQ_RECORD_NAME_SUFFIX;
+using MatrixTransposer::Constants::DOORBELL_NAME_SUFFIX;
+using MatrixTransposer::Constants::METRICS_NAME_SUFFIX;
+using MatrixTransposer::Constants::METRICS_PUBLISH_INTERVAL_MS;
+using MatrixTransposer::Constants::LOG_LEVEL_ENVIRONMENT_VARIABLE;
 using MatrixTransposer::Constants::REQ_QUEUE_CAPACITY;
 using MatrixTransposer::Constants::MAX_CLIENTS;
+using MatrixTransposer::Constants::MAX_CLIENT_BUFFERS;
+using MatrixTransposer::Constants::DEFAULT_CLIENT_LANES;
+using MatrixTransposer::Constants::MAX_CLIENT_LANES;
+using MatrixTransposer::Constants::LaneNameSuffix;
+using MatrixTransposer::Constants::DEFAULT_CLIENT_WEIGHT;
+using MatrixTransposer::Constants::MAX_CLIENT_WEIGHT;
 using MatrixTransposer::Constants::TRANSPOSE_TILE_SIZE;
+using MatrixTransposer::Constants::TRANSPOSE_BYTES_PER_WORKER;
+using MatrixTransposer::Constants::WORKER_SPIN_COUNT;
+using MatrixTransposer::Constants::TRANSPOSE_CHUNK_TILES;
+using MatrixTransposer::Constants::DEFAULT_TIME_SLICE_US;
 using MatrixTransposer::Constants::WORKER_THREAD_QUEUE_CAPACITY;
 using MatrixTransposer::Constants::WORKER_THREAD_QUEUE_NAME_SUFFIX;
 
 ServerWorkspace gWorkspace;
 
-void setBit(uint64_t &number, int position, bool value)
-{
-    if (value)
-        number |= (1ULL << position);
-    else
-        number &= ~(1ULL << position);
-}
-
-bool getBit(const uint64_t &number, int position)
-{
-    return (number & (1ULL << position)) != 0;
-}
-
 static bool ClientExists(uint32_t clientId, uint32_t& bankIndex)
 {
-    for (int i = 0; i < MAX_CLIENTS; i++)
+    auto it = gWorkspace.clientSlots.find(clientId);
+    if (it == gWorkspace.clientSlots.end())
     {
-        if (gWorkspace.clientBank[i].subscribed)
-        {
-            if (gWorkspace.clientBank[i].id == clientId)
-            {
-                bankIndex = i;
-                return true;
-            }
-        }
+        return false;
     }
 
-    return false;
+    bankIndex = it->second;
+    return true;
 }
 
-static bool AddClient(uint32_t clientId, uint32_t m, uint32_t n, uint32_t k, const UnixSockIpcContext& context)
+// Maps the next count buffer pairs of the client, which the client has already created
+static void MapBuffers(uint32_t clientId, uint32_t m, uint32_t n, uint32_t count, ClientBufferSet& buffers)
 {
-    int32_t indexToAdd;
-
-    for (int i = 0; i < MAX_CLIENTS; i++)
+    uint32_t firstIndex = buffers.GetCount();
+    for (uint32_t bufferIndex = firstIndex; bufferIndex < firstIndex + count; bufferIndex++)
     {
-        if (!getBit(gWorkspace.validClientsBitSet, i))
-        {
-            indexToAdd = i;
-            break;
-        }
+        buffers.Append(
+            std::make_shared<SharedMatrixBuffer>(clientId, SharedMatrixBuffer::Endpoint::Server, m, n, bufferIndex, SharedMatrixBuffer::BufferInitMode::NoInit, MATRIX_BUF_NAME_SUFFIX),
+            std::make_shared<SharedMatrixBuffer>(clientId, SharedMatrixBuffer::Endpoint::Server, m, n, bufferIndex, SharedMatrixBuffer::BufferInitMode::NoInit, TR_MATRIX_BUF_NAME_SUFFIX));
     }
+}
 
-    gWorkspace.clientBank[indexToAdd] = ClientContext();
-
-    ClientContext& newClientContext = gWorkspace.clientBank[indexToAdd];
+// Takes ownership of completionEventFd, which is -1 for a client woken through its lane futexes
+static bool AddClient(uint32_t clientId, uint32_t m, uint32_t n, uint32_t k, uint32_t weight, uint32_t laneCount, int completionEventFd, const UnixSockIpcContext& context, uint32_t& bankIndex)
+{
+    std::unique_ptr<ClientContext> pNewClientContext = std::make_unique<ClientContext>();
+    ClientContext& newClientContext = *pNewClientContext;
+    newClientContext.completionEventFd = completionEventFd;
 
     try
     {
@@ -90,95 +99,215 @@ static bool AddClient(uint32_t clientId, uint32_t m, uint32_t n, uint32_t k, con
         newClientContext.matrixSize.k = k;
         newClientContext.matrixSize.numRows = 1 << m;
         newClientContext.matrixSize.numColumns = 1 << n;
+        newClientContext.weight = (weight == 0) ? DEFAULT_CLIENT_WEIGHT : std::min(weight, MAX_CLIENT_WEIGHT);
+        newClientContext.serverBytesAtSubscribe = gWorkspace.totalBytesTransposed.load(std::memory_order_relaxed);
         newClientContext.ipcContext = context;
-        newClientContext.matrixBuffers.reserve(k);
-        newClientContext.matrixBuffersTr.reserve(k);
 
-        newClientContext.pTransposeReadyFutex = std::make_unique<FutexSignaller>(clientId, FutexSignaller::Role::Waker, "");
-        newClientContext.pRequestQueue = std::make_unique<SpscQueueSeqLock>(clientId, SpscQueueSeqLock::Role::Consumer, REQ_QUEUE_CAPACITY, REQ_QUEUE_NAME_SUFFIX);
-
-        for (uint32_t bufferIndex = 0; bufferIndex < k; bufferIndex++)
+        // Sized once, the jobs and the registry keep pointers to the lanes
+        newClientContext.lanes.resize(laneCount);
+        for (uint32_t laneIndex = 0; laneIndex < laneCount; laneIndex++)
         {
-            newClientContext.matrixBuffers.push_back(std::make_unique<SharedMatrixBuffer>(clientId, SharedMatrixBuffer::Endpoint::Server, m, n, bufferIndex, SharedMatrixBuffer::BufferInitMode::NoInit, MATRIX_BUF_NAME_SUFFIX));
-            newClientContext.matrixBuffersTr.push_back(std::make_unique<SharedMatrixBuffer>(clientId, SharedMatrixBuffer::Endpoint::Server, m, n, bufferIndex, SharedMatrixBuffer::BufferInitMode::NoInit, TR_MATRIX_BUF_NAME_SUFFIX));
+            ClientLane& lane = newClientContext.lanes[laneIndex];
+            lane.pJob = std::make_unique<TransposeJob>();
+            lane.pJob->pClient = &newClientContext;
+            lane.pJob->pLane = &lane;
+            lane.pJob->clientId = clientId;
+            lane.pTransposeReadyFutex = std::make_unique<FutexSignaller>(clientId, FutexSignaller::Role::Waker, LaneNameSuffix("", laneIndex));
+            lane.pRequestQueue = std::make_unique<SpscQueueSequenced<TransposeRequest>>(clientId, SpscQueueSequenced<TransposeRequest>::Role::Consumer, REQ_QUEUE_CAPACITY, LaneNameSuffix(REQ_QUEUE_NAME_SUFFIX, laneIndex));
+            lane.pRequestRecords = std::make_unique<RequestRecordTable>(clientId, RequestRecordTable::Endpoint::Server, k, LaneNameSuffix(REQ_RECORD_NAME_SUFFIX, laneIndex));
         }
 
+        newClientContext.pBuffers = std::make_unique<ClientBufferSet>();
+        MapBuffers(clientId, m, n, k, *newClientContext.pBuffers);
+
         newClientContext.subscribed = true;
     }
     catch(const std::exception& e)
     {
-        {
-        }
-        std::cout << "Failed to set up client context for client PID: " << clientId << std::endl;
-        std::cerr << e.what() << '\n';
+        LOG_ERROR("Failed to set up client context for client PID: {}", clientId);
+        LOG_ERROR("{}", e.what());
         return false;
     }
 
+    // Published without waiting for the dispatcher, which picks the new table up on its next pass
+    int32_t indexToAdd = gWorkspace.clientRegistry.Add(std::move(pNewClientContext), TransposeTiledTileRange);
+    if (indexToAdd == ClientRegistry::NO_FREE_SLOT)
+    {
+        LOG_WARNING("No room for the {} lanes of client PID: {}. Server is serving {} lanes", laneCount, clientId, MAX_CLIENTS);
+        return false;
+    }
 
+    gWorkspace.clientSlots.emplace(clientId, indexToAdd);
+    bankIndex = indexToAdd;
 
-    // Waiting for thread dispatcher to pick up the new client
-    while (gWorkspace.clientBankUpdateAvailable.load(std::memory_order_acquire));
+    return true;
+}
 
-    setBit(gWorkspace.validClientsBitSet, indexToAdd, 1);
-    gWorkspace.clientBankUpdateAvailable.store(true, std::memory_order_release);
+static void RemoveClient(uint32_t clientId, uint32_t bankIndex)
+{
+    gWorkspace.clientSlots.erase(clientId);
 
-    return true;
+    // The dispatcher frees the context once it stops using it and the workers are done with it
+    gWorkspace.clientRegistry.Remove(bankIndex);
 }
 
-static void RemoveClient(uint32_t clientId)
+// Builds the new buffer set of an AddBuffers, RemoveBuffers or ReshapeBuffer message from a copy
+// of the client's current one, which keeps sharing the mappings of the buffers that did not
+// change. Returns nullptr if the change is not valid or the message is about another client.
+static std::unique_ptr<ClientBufferSet> ChangeBuffers(const ClientServerMessage& message, const ClientContext& client)
 {
-    int indexToRemove = 0;
+    auto pNewBuffers = std::make_unique<ClientBufferSet>(*client.pBuffers);
+    uint32_t clientId;
+
+    switch (message.type)
+    {
+    case ClientServerMessage::MessageType::AddBuffers:
+    {
+        uint32_t m, n, count;
+        if (!ClientServerMessage::ProcessAddBuffersMessage(message, clientId, m, n, count) ||
+            clientId != client.id || count == 0 || pNewBuffers->GetCount() + count > MAX_CLIENT_BUFFERS)
+        {
+            return nullptr;
+        }
+
+        try
+        {
+            MapBuffers(clientId, m, n, count, *pNewBuffers);
+        }
+        catch(const std::exception& e)
+        {
+            LOG_ERROR("{}", e.what());
+            return nullptr;
+        }
+        break;
+    }
+    case ClientServerMessage::MessageType::RemoveBuffers:
+    {
+        // Removes the buffers with the highest indices, and always leaves at least one
+        uint32_t count;
+        if (!ClientServerMessage::ProcessRemoveBuffersMessage(message, clientId, count) ||
+            clientId != client.id || count == 0 || count >= pNewBuffers->GetCount())
+        {
+            return nullptr;
+        }
 
-    for (int i = 0; i < gWorkspace.clientBank.size(); i++)
+        pNewBuffers->Truncate(pNewBuffers->GetCount() - count);
+        break;
+    }
+    case ClientServerMessage::MessageType::ReshapeBuffer:
     {
-        if (gWorkspace.clientBank[i].id == clientId)
+        // Changes the logical shape of an input buffer within the capacity it was created with
+        uint32_t bufferIndex, rowCount, columnCount;
+        if (!ClientServerMessage::ProcessReshapeBufferMessage(message, clientId, bufferIndex, rowCount, columnCount) ||
+            clientId != client.id || bufferIndex >= pNewBuffers->GetCount() || rowCount == 0 || columnCount == 0)
         {
-            indexToRemove = i;
-            break;
+            return nullptr;
         }
+
+        BufferShape& shape = pNewBuffers->shapes[bufferIndex];
+        if (static_cast<uint64_t>(rowCount) * columnCount > shape.capacity)
+        {
+            return nullptr;
+        }
+
+        shape.rowCount = rowCount;
+        shape.columnCount = columnCount;
+        break;
+    }
+    default:
+        return nullptr;
     }
 
-    // Waiting for thread dispatcher to pick up the new client
-    while (gWorkspace.clientBankUpdateAvailable.load(std::memory_order_acquire));
-    setBit(gWorkspace.validClientsBitSet, indexToRemove, 0);
-    gWorkspace.clientBankUpdateAvailable.store(true, std::memory_order_release);
-    while (gWorkspace.clientBankUpdateAvailable.load(std::memory_order_acquire));
-    gWorkspace.clientBank[indexToRemove].subscribed = false;
+    return pNewBuffers;
+}
+
+static void CloseReceivedFd(const UnixSockIpcContext& context)
+{
+    if (context.receivedFd >= 0)
+    {
+        close(context.receivedFd);
+    }
+}
+
+// Accepts a completion descriptor only if it is an eventfd, and makes it non-blocking. Any other
+// descriptor (a pipe or socket the client never reads) would block the dispatcher's write and
+// stall every client.
+static bool PrepareCompletionEventFd(int fd)
+{
+    char target[64];
+    std::string linkPath = "/proc/self/fd/" + std::to_string(fd);
+    ssize_t length = readlink(linkPath.c_str(), target, sizeof(target) - 1);
+    if (length < 0)
+    {
+        return false;
+    }
+    target[length] = '\0';
+    if (std::strcmp(target, "anon_inode:[eventfd]") != 0)
+    {
+        return false;
+    }
+
+    int flags = fcntl(fd, F_GETFL);
+    return flags >= 0 && fcntl(fd, F_SETFL, flags | O_NONBLOCK) == 0;
 }
 
 static void MessageHandler(const UnixSockIpcContext& context, const ClientServerMessage& message)
 {
     uint32_t clientId;
 
+    // Only a subscribe message may carry a descriptor
+    if (message.type != ClientServerMessage::MessageType::Subscribe)
+    {
+        CloseReceivedFd(context);
+    }
+
     switch (message.type)
     {
     case ClientServerMessage::MessageType::Subscribe:
     {
-        uint32_t m, n, k;
-        if (!ClientServerMessage::ProcessSubscribeMessage(message, clientId, m, n, k))
+        // A subscribe message with an eventfd attached asks for completions on that eventfd
+        uint32_t m, n, k, weight, laneCount;
+        if (!ClientServerMessage::ProcessSubscribeMessage(message, clientId, m, n, k, weight, laneCount))
         {
-            std::cout << "Failed to process subscribe message from client PID: " << message.senderId << std::endl;
+            LOG_LIMITED(LogLevel::Warning, 10, "Failed to process subscribe message from client PID: {}", message.senderId);
+            CloseReceivedFd(context);
             return;
         }
 
+        laneCount = (laneCount == 0) ? DEFAULT_CLIENT_LANES : laneCount;
+        if (laneCount > MAX_CLIENT_LANES)
         {
-            uint32_t bankIndex;
-            if (ClientExists(clientId, bankIndex))
-            {
-                std::clog << "Client PID: " << clientId << " already exists" << std::endl;
-                return;
-            }
+            LOG_LIMITED(LogLevel::Warning, 10, "Client PID: {} asked for {} lanes, at most {} are allowed", clientId, laneCount, MAX_CLIENT_LANES);
+            CloseReceivedFd(context);
+            return;
+        }
 
-            std::clog << "New client: " << clientId << std::endl;
-            if (!AddClient(clientId, m, n, k, context))
-            {
-                std::clog << "Failed to add client PID: " << clientId << std::endl;
-                return;
-            }
+        uint32_t bankIndex;
+        if (ClientExists(clientId, bankIndex))
+        {
+            LOG_LIMITED(LogLevel::Warning, 10, "Client PID: {} already exists", clientId);
+            CloseReceivedFd(context);
+            return;
         }
 
+        if (context.receivedFd >= 0 && !PrepareCompletionEventFd(context.receivedFd))
+        {
+            LOG_LIMITED(LogLevel::Warning, 10, "Client PID: {} sent a completion descriptor that is not an eventfd", clientId);
+            CloseReceivedFd(context);
+            return;
+        }
+
+        LOG_INFO("New client: {}", clientId);
+        if (!AddClient(clientId, m, n, k, weight, laneCount, context.receivedFd, context, bankIndex))
+        {
+            LOG_WARNING("Failed to add client PID: {}", clientId);
+            return;
+        }
+
+        // The slot is the bit the client's first lane rings in the pending work doorbell
         ClientServerMessage responseMessage;
-        ClientServerMessage::GenerateSubscribeResponseMessage(responseMessage, gWorkspace.serverPid, clientId, MAX_CLIENTS, gWorkspace.clientBank.size());
+        uint32_t clientCount = gWorkspace.clientSlots.size();
+        ClientServerMessage::GenerateSubscribeResponseMessage(responseMessage, gWorkspace.serverPid, bankIndex, MAX_CLIENTS, clientCount, TscClock::UsesTsc());
         gWorkspace.pIpcServer->Send(context, responseMessage);
 
         break;
@@ -187,7 +316,7 @@ static void MessageHandler(const UnixSockIpcContext& context, const ClientServer
     {
         if (!ClientServerMessage::ProcessUnsubscribeMessage(message, clientId))
         {
-            std::cout << "Failed to process unsubscribe message from client PID: " << message.senderId << std::endl;
+            LOG_LIMITED(LogLevel::Warning, 10, "Failed to process unsubscribe message from client PID: {}", message.senderId);
             return;
         }
 
@@ -195,70 +324,668 @@ static void MessageHandler(const UnixSockIpcContext& context, const ClientServer
             uint32_t bankIndex;
             if (!ClientExists(clientId, bankIndex))
             {
-                std::cout << "Cannot remove client PID: " << clientId << ". Does not exist" << std::endl;
+                LOG_LIMITED(LogLevel::Warning, 10, "Cannot remove client PID: {}. Does not exist", clientId);
                 return;
             }
 
-            ClientContext& clientContext = gWorkspace.clientBank[bankIndex];
-            std::clog << "client: " << clientContext.id 
-                    << ", m: "<< clientContext.matrixSize.m
-                    << ", n: " << clientContext.matrixSize.n 
-                    << ", k: " << clientContext.matrixSize.k
-                    << ", totalReqs: " << clientContext.stats.GetTotalRequests()
-                    << ", avgTime: " << clientContext.stats.GetAverageElapsedTimeUs() << " (ns)" << std::endl;
+            // The summary is logged by the dispatcher once the client's lanes are done, see
+            // LogClientSummary()
+            ClientContext& clientContext = gWorkspace.clientRegistry.GetClient(bankIndex);
+            clientContext.serverBytesAtUnsubscribe = gWorkspace.totalBytesTransposed.load(std::memory_order_relaxed);
 
-            RemoveClient(clientId);
+            RemoveClient(clientId, bankIndex);
         }
 
         break;
     }
+    case ClientServerMessage::MessageType::AddBuffers:
+    case ClientServerMessage::MessageType::RemoveBuffers:
+    case ClientServerMessage::MessageType::ReshapeBuffer:
+    {
+        uint32_t bankIndex;
+        if (!ClientExists(message.senderId, bankIndex))
+        {
+            LOG_LIMITED(LogLevel::Warning, 10, "Cannot change buffers of client PID: {}. Does not exist", message.senderId);
+            return;
+        }
+
+        // The dispatcher keeps using the old set for requests already staged and picks the new
+        // one up with the next request it takes off the queue
+        ClientContext& clientContext = gWorkspace.clientRegistry.GetClient(bankIndex);
+        std::unique_ptr<ClientBufferSet> pNewBuffers = ChangeBuffers(message, clientContext);
+        bool success = (pNewBuffers != nullptr);
+        if (success)
+        {
+            gWorkspace.clientRegistry.ReplaceBuffers(bankIndex, std::move(pNewBuffers));
+        }
+        else
+        {
+            LOG_LIMITED(LogLevel::Warning, 10, "Rejected {} message from client PID: {}", ClientServerMessage::TypeToString(message.type), message.senderId);
+        }
+
+        uint32_t bufferCount = clientContext.pBuffers->GetCount();
+        clientContext.matrixSize.k = bufferCount;
+
+        ClientServerMessage responseMessage;
+        ClientServerMessage::GenerateBuffersResponseMessage(responseMessage, gWorkspace.serverPid, success, bufferCount);
+        gWorkspace.pIpcServer->Send(context, responseMessage);
+
+        break;
+    }
     default:
-        std::cout << "Received unknown message type from client PID: " << message.senderId << std::endl;
+        LOG_LIMITED(LogLevel::Warning, 10, "Received unknown message type from client PID: {}", message.senderId);
         break;
     }
 
 }
 
+// Wakes the lane's futex, or counts the completion for the dispatcher to signal on the client's
+// eventfd at the end of its pass
+static void SignalCompletion(ClientContext& client, ClientLane& lane)
+{
+    if (client.completionEventFd >= 0)
+    {
+        client.unsignalledCompletions.fetch_add(1, std::memory_order_release);
+    }
+    else
+    {
+        TraceBegin(TraceEventId::Wake, client.id, &lane - client.lanes.data());
+        lane.pTransposeReadyFutex->Wake();
+        TraceEnd(TraceEventId::Wake);
+    }
+}
+
+// Adds the completions counted since the last call to the client's eventfd with a single write
+static void FlushCompletions(ClientContext& client)
+{
+    uint64_t completions = client.unsignalledCompletions.exchange(0, std::memory_order_acquire);
+    if (completions == 0)
+    {
+        return;
+    }
+
+    TraceBegin(TraceEventId::Flush, client.id, completions);
+    if (write(client.completionEventFd, &completions, sizeof(completions)) != sizeof(completions))
+    {
+        // The counter is full because the client does not read it; tried again on the next flush
+        if (errno == EAGAIN)
+        {
+            client.unsignalledCompletions.fetch_add(completions, std::memory_order_relaxed);
+            TraceEnd(TraceEventId::Flush);
+            return;
+        }
+        LOG_LIMITED(LogLevel::Error, 10, "Failed to signal eventfd of client PID: {} (errno: {}): {}", client.id, errno, strerror(errno));
+    }
+    TraceEnd(TraceEventId::Flush);
+}
+
+static void OnTransposeComplete(TransposeJob& job)
+{
+    ClientLane& lane = *job.pLane;
+    uint64_t kernelEndTicks = TscClock::Now();
+    uint64_t nowNs = RequestClockNowNs();
+
+    uint64_t serviceTimeNs = nowNs - job.dispatchTimeNs;
+    uint64_t estimateNs = lane.serviceTimeEstimateNs;
+    lane.serviceTimeEstimateNs = (estimateNs == 0) ? serviceTimeNs : (7 * estimateNs + serviceTimeNs) / 8;
+
+    RequestStatus status = RequestStatus::Completed;
+    if (job.deadlineNs != 0)
+    {
+        bool deadlineMet = nowNs <= job.deadlineNs;
+        status = deadlineMet ? RequestStatus::DeadlineMet : RequestStatus::DeadlineMissed;
+        lane.stats.RecordDeadlineOutcome(deadlineMet);
+    }
+
+    RequestRecord& record = (*lane.pRequestRecords)[job.recordIndex];
+    record.timestamps.kernelStartTicks = job.kernelStartTicks;
+    record.timestamps.kernelEndTicks = kernelEndTicks;
+    record.timestamps.wakeTicks = TscClock::Now();
+    RecordRequestStages(lane.stats, record.timestamps, RequestStage::Wakeup);
+
+    if (gWorkspace.countPerfEvents)
+    {
+        PerfCounterValues counts;
+        for (uint32_t counter = 0; counter < PERF_COUNTER_COUNT; counter++)
+        {
+            counts.counts[counter] = job.perfCounts[counter].load(std::memory_order_relaxed);
+        }
+        counts.availableMask = job.perfAvailableMask.load(std::memory_order_relaxed);
+        lane.perfStats.Record(job.rowCount, job.columnCount, 2ULL * job.rowCount * job.columnCount * sizeof(uint64_t), counts);
+    }
+    record.status.store(status, std::memory_order_release);
+
+    // Counted before the job goes idle, so the dispatcher flushes it when it next sees the lane
+    SignalCompletion(*job.pClient, lane);
+    lane.stats.StopTimer();
+
+    job.state.store(JobState::Idle, std::memory_order_release);
+}
+
+// Bytes still to be moved by the request, which is less than requestBytes for a suspended job
+static uint64_t RemainingRequestBytes(const ClientHotData& client)
+{
+    const TransposeJob& job = *client.pJob;
+    if (!client.stagedResume && job.state.load(std::memory_order_relaxed) != JobState::Running)
+    {
+        return client.requestBytes;
+    }
+
+    uint32_t nextTile = std::min(job.nextTile.load(std::memory_order_relaxed), job.tileCount);
+    return client.requestBytes * (job.tileCount - nextTile) / job.tileCount;
+}
+
+// Number of workers a request gets: enough for its size, but never more than its weighted fair
+// share of the pool when other clients also have work, nor more chunks than are left to do.
+static uint32_t PartitionWidth(const ClientHotData& client, uint32_t activeWeight)
+{
+    uint64_t requestBytes = RemainingRequestBytes(client);
+    uint64_t fairShare = static_cast<uint64_t>(gWorkspace.numWorkerThreads) * client.weight / activeWeight;
+    uint64_t desiredWidth = (requestBytes + TRANSPOSE_BYTES_PER_WORKER - 1) / TRANSPOSE_BYTES_PER_WORKER;
+    uint64_t chunkCount = (static_cast<uint64_t>(client.tileCount) * requestBytes / client.requestBytes + TRANSPOSE_CHUNK_TILES - 1) / TRANSPOSE_CHUNK_TILES;
+
+    return static_cast<uint32_t>(std::max<uint64_t>(1, std::min<uint64_t>({desiredWidth, fairShare, chunkCount})));
+}
+
+// Start-time fair queuing: a request starts no earlier than the current virtual time and no
+// earlier than the finish tag of the previous request of the same client, on any of its lanes.
+// Requests are then served in start tag order, which charges every client by bytes moved divided
+// by its weight.
+static void AssignFairQueuingTags(ClientHotData& client)
+{
+    uint64_t weightedCost = std::max<uint64_t>(1, client.requestBytes / client.weight);
+    uint64_t& virtualFinishTag = client.pClient->virtualFinishTag;
+
+    client.stagedStartTag = std::max(gWorkspace.virtualTime, virtualFinishTag);
+    virtualFinishTag = client.stagedStartTag + weightedCost;
+}
+
+static uint32_t RecordIndex(const ClientLane& lane, const TransposeRequest& request)
+{
+    return request.clientTag % lane.pRequestRecords->GetRecordCount();
+}
+
+// Checks the request against the client's buffer set and resolves its buffers. A request
+// without a shape gets the current logical shape of its source buffer.
+static bool ResolveRequest(ClientHotData& client, const ClientBufferSet& buffers, TransposeRequest& request)
+{
+    if (request.op != TransposeOp::Transpose ||
+        (request.flags & ~TRANSPOSE_REQUEST_FLAGS_MASK) != 0 ||
+        request.srcBuffer >= buffers.GetCount() ||
+        request.dstBuffer >= buffers.GetCount())
+    {
+        return false;
+    }
+
+    const BufferShape& srcShape = buffers.shapes[request.srcBuffer];
+    if (request.rowCount == 0 && request.columnCount == 0)
+    {
+        request.rowCount = srcShape.rowCount;
+        request.columnCount = srcShape.columnCount;
+    }
+
+    uint64_t elementCount = static_cast<uint64_t>(request.rowCount) * request.columnCount;
+    if (elementCount == 0 ||
+        elementCount > srcShape.capacity ||
+        elementCount > buffers.shapes[request.dstBuffer].capacity)
+    {
+        return false;
+    }
+
+    client.pStagedSrc = buffers.srcBasePointers[request.srcBuffer];
+    client.pStagedDst = buffers.dstBasePointers[request.dstBuffer];
+    client.pStagedBuffers = &buffers;
+    return true;
+}
+
+// Completes a request that failed validation without running it
+static void RejectRequest(const ClientHotData& client, const TransposeRequest& request)
+{
+    ClientLane& lane = *client.pLane;
+    TraceInstant(TraceEventId::Reject, client.pClient->id, request.clientTag);
+    LOG_LIMITED(LogLevel::Warning, 10, "Rejected request {} of client PID: {}", request.clientTag, client.pClient->id);
+
+    (*lane.pRequestRecords)[RecordIndex(lane, request)].status.store(RequestStatus::Rejected, std::memory_order_release);
+    SignalCompletion(*client.pClient, lane);
+}
+
+// Takes the next valid request off the client's queue, rejecting invalid ones on the way
+static bool StageNextRequest(ClientHotData& client)
+{
+    TransposeRequest& request = client.stagedRequest;
+    while (client.pRequestQueue->Dequeue(request))
+    {
+        ClientLane& lane = *client.pLane;
+        (*lane.pRequestRecords)[RecordIndex(lane, request)].timestamps.dequeueTicks = TscClock::Now();
+        TraceInstant(TraceEventId::Dequeue, client.pClient->id, request.clientTag);
+
+        // Loaded per request: a request enqueued after a buffer change was acknowledged must see it
+        const ClientBufferSet& buffers = *client.pBuffers.load(std::memory_order_acquire);
+        if (!ResolveRequest(client, buffers, request))
+        {
+            RejectRequest(client, request);
+            continue;
+        }
+
+        client.tileCount = TiledTileCount(request.rowCount, request.columnCount, TRANSPOSE_TILE_SIZE);
+        client.requestBytes = 2ULL * request.rowCount * request.columnCount * sizeof(uint64_t);
+        return true;
+    }
+    return false;
+}
+
+// A request with a deadline is admitted to earliest-deadline-first scheduling only if the
+// client's recent service time says it can still make it. Requests that cannot are left to
+// fair queuing so they do not push feasible deadlines of other clients out.
+static void StageDeadline(ClientHotData& client)
+{
+    uint64_t deadlineNs = client.stagedRequest.deadlineNs;
+    client.stagedDeadlineAdmitted = (deadlineNs != 0) &&
+        (RequestClockNowNs() + client.pLane->serviceTimeEstimateNs <= deadlineNs);
+}
+
+// Admitted deadline requests first in deadline order, everything else in fair queuing order
+static bool ScheduledBefore(const ClientHotData& a, const ClientHotData& b)
+{
+    if (a.stagedDeadlineAdmitted != b.stagedDeadlineAdmitted)
+    {
+        return a.stagedDeadlineAdmitted;
+    }
+
+    if (a.stagedDeadlineAdmitted && a.stagedRequest.deadlineNs != b.stagedRequest.deadlineNs)
+    {
+        return a.stagedRequest.deadlineNs < b.stagedRequest.deadlineNs;
+    }
+
+    return a.stagedStartTag < b.stagedStartTag;
+}
+
+// Takes the staged request of the client and sets up its job for the worker pool
+static TransposeJob& PrepareJob(ClientHotData& client, uint64_t nowNs)
+{
+    TransposeJob& job = *client.pJob;
+    const TransposeRequest& request = client.stagedRequest;
+
+    client.requestStaged = false;
+    job.lastStartNs = nowNs;
+
+    if (client.stagedResume)
+    {
+        client.stagedResume = false;
+        job.preemptRequested.store(false, std::memory_order_relaxed);
+        return job;
+    }
+
+    ClientLane& lane = *client.pLane;
+
+    job.clientTag = request.clientTag;
+    job.recordIndex = RecordIndex(lane, request);
+    (*lane.pRequestRecords)[job.recordIndex].timestamps.dispatchTicks = TscClock::Now();
+    job.deadlineNs = request.deadlineNs;
+    job.kernel = client.kernel;
+    job.pSrc = client.pStagedSrc;
+    job.pDst = client.pStagedDst;
+    job.rowCount = request.rowCount;
+    job.columnCount = request.columnCount;
+    job.tileCount = client.tileCount;
+    job.chunkTiles = TRANSPOSE_CHUNK_TILES;
+    job.nextTile.store(0, std::memory_order_relaxed);
+    job.preemptRequested.store(false, std::memory_order_relaxed);
+
+    if (gWorkspace.countPerfEvents)
+    {
+        for (std::atomic<uint64_t>& count : job.perfCounts)
+        {
+            count.store(0, std::memory_order_relaxed);
+        }
+        job.perfAvailableMask.store(0, std::memory_order_relaxed);
+    }
+
+    lane.stats.StartTimer();
+    lane.stats.AddBytes(client.requestBytes);
+    gWorkspace.totalBytesTransposed.fetch_add(client.requestBytes, std::memory_order_relaxed);
+    gWorkspace.virtualTime = std::max(gWorkspace.virtualTime, client.stagedStartTag);
+    job.dispatchTimeNs = nowNs;
+
+    return job;
+}
+
+// Asks the widest request that has used up its time slice to leave its workers after the chunks
+// being processed, if it has more bytes left than the blocked request needs. It is put back
+// behind the requests that are currently waiting.
+static void PreemptForBlockedRequest(const ClientHotData& blockedClient, uint64_t resumeAfterTag, const HierarchicalBitmap<MAX_CLIENTS>& activeClients)
+{
+    uint64_t nowNs = RequestClockNowNs();
+    TransposeJob* pVictim = nullptr;
+
+    // Running jobs always belong to active clients
+    activeClients.ForEachSet([&](uint32_t slot)
+    {
+        const ClientHotData& client = gWorkspace.clientRegistry.GetHotData(slot);
+        if (&client == &blockedClient)
+        {
+            return;
+        }
+
+        TransposeJob& job = *client.pJob;
+        if (job.state.load(std::memory_order_acquire) != JobState::Running ||
+            job.preemptRequested.load(std::memory_order_relaxed) ||
+            job.lastStartNs + gWorkspace.timeSliceNs > nowNs ||
+            RemainingRequestBytes(client) <= blockedClient.requestBytes)
+        {
+            return;
+        }
+
+        if (pVictim == nullptr || job.width > pVictim->width)
+        {
+            pVictim = &job;
+        }
+    });
+
+    if (pVictim != nullptr)
+    {
+        TraceInstant(TraceEventId::Preempt, pVictim->clientId, pVictim->clientTag);
+        pVictim->resumeAfterTag = resumeAfterTag;
+        pVictim->preemptRequested.store(true, std::memory_order_relaxed);
+    }
+}
+
+static void PublishServerMetrics(uint32_t laneCount, uint32_t slotLimit)
+{
+    ServerMetricsPage::ServerMetrics metrics {};
+    metrics.layoutVersion = ServerMetricsPage::LAYOUT_VERSION;
+    metrics.serverPid = gWorkspace.serverPid;
+    metrics.workerCount = std::min(gWorkspace.numWorkerThreads, ServerMetricsPage::MAX_WORKERS);
+    metrics.slotLimit = slotLimit;
+    metrics.laneCount = laneCount;
+    metrics.startTimeNs = gWorkspace.startTimeNs;
+    metrics.publishTimeNs = RequestClockNowNs();
+    metrics.totalBytes = gWorkspace.totalBytesTransposed.load(std::memory_order_relaxed);
+    gWorkspace.pMetricsPage->PublishServer(metrics);
+}
+
+// Publishes the counters of a lane to the metrics page. The latency and deadline figures come
+// from statistics written by the worker completing the lane's request, so they are only read
+// when statsReadable says the job is not running; otherwise the lane keeps its previous figures.
+static void PublishLaneMetrics(uint32_t slot, const ClientHotData& client, bool statsReadable)
+{
+    ServerMetricsPage& page = *gWorkspace.pMetricsPage;
+    const ClientContext& clientContext = *client.pClient;
+    const ClientLane& lane = *client.pLane;
+
+    ServerMetricsPage::LaneMetrics metrics = page.GetPublishedLane(slot);
+    if (metrics.clientId != clientContext.id)
+    {
+        metrics = ServerMetricsPage::LaneMetrics {};
+        metrics.clientId = clientContext.id;
+        metrics.laneIndex = static_cast<uint32_t>(&lane - clientContext.lanes.data());
+        metrics.weight = clientContext.weight;
+    }
+
+    // Queue and bytes are only touched by the dispatcher itself
+    metrics.queueDepth = client.pRequestQueue->GetReadyCount();
+    metrics.bytes = lane.stats.GetTotalBytes();
+
+    // Percentiles are only worth recomputing for lanes that completed requests since
+    const ClientStats& stats = lane.stats;
+    if (statsReadable && stats.GetTotalRequests() != metrics.requests)
+    {
+        const LatencyHistogram& elapsedTimes = stats.GetElapsedTimes();
+        metrics.requests = stats.GetTotalRequests();
+        metrics.p50Ns = elapsedTimes.GetPercentileNs(50.0);
+        metrics.p99Ns = elapsedTimes.GetPercentileNs(99.0);
+        metrics.p999Ns = elapsedTimes.GetPercentileNs(99.9);
+        metrics.maxNs = elapsedTimes.GetMaxNs();
+        metrics.deadlinesMet = stats.GetMetDeadlines();
+        metrics.deadlinesMissed = stats.GetMissedDeadlines();
+    }
+
+    page.PublishLane(slot, metrics);
+}
+
+// Publishes the counters of every lane and worker to the metrics page. Runs on the dispatcher,
+// which owns the client table, so no lane is freed while it is read. Lanes that are running are
+// put in deferredSlots and published again when the dispatcher next finds them idle.
+static void PublishMetrics(const ClientTable& table, HierarchicalBitmap<MAX_CLIENTS>& publishedSlots, HierarchicalBitmap<MAX_CLIENTS>& deferredSlots)
+{
+    ServerMetricsPage& page = *gWorkspace.pMetricsPage;
+
+    // Lanes of clients that have unsubscribed since the last publication
+    publishedSlots.ForEachSet([&](uint32_t slot)
+    {
+        if (!table.validClients.Test(slot))
+        {
+            page.PublishLane(slot, ServerMetricsPage::LaneMetrics {});
+            publishedSlots.Clear(slot);
+            deferredSlots.Clear(slot);
+        }
+    });
+
+    uint32_t laneCount = 0;
+    uint32_t slotLimit = 0;
+    table.validClients.ForEachSet([&](uint32_t slot)
+    {
+        const ClientHotData& client = gWorkspace.clientRegistry.GetHotData(slot);
+        bool running = client.pJob->state.load(std::memory_order_acquire) == JobState::Running;
+        PublishLaneMetrics(slot, client, !running);
+        if (running)
+        {
+            deferredSlots.Set(slot);
+        }
+
+        publishedSlots.Set(slot);
+        laneCount++;
+        slotLimit = slot + 1;
+    });
+
+    uint32_t workerCount = std::min(gWorkspace.numWorkerThreads, ServerMetricsPage::MAX_WORKERS);
+    for (uint32_t workerIndex = 0; workerIndex < workerCount; workerIndex++)
+    {
+        uint64_t jobParts, busyTicks;
+        gWorkspace.pWorkerPool->GetWorkerCounters(workerIndex, jobParts, busyTicks);
+        page.PublishWorker(workerIndex, ServerMetricsPage::WorkerMetrics { jobParts, TscClock::TicksToNs(busyTicks) });
+    }
+
+    PublishServerMetrics(laneCount, slotLimit);
+}
+
+// Logs the summary of an unsubscribed client. Runs on the dispatcher when the registry frees the
+// client, since the lane stats and hardware counts are written by the dispatcher and the workers
+// without locks and only then is no worker left that could still be writing them.
+static void LogClientSummary(const ClientContext& clientContext)
+{
+    uint64_t serverBytes = clientContext.serverBytesAtUnsubscribe - clientContext.serverBytesAtSubscribe;
+    ClientStats stats = clientContext.GetStats();
+    LOG_INFO("client: {}, m: {}, n: {}, k: {}, weight: {}, lanes: {}, totalReqs: {}, {}, bytes: {}, share: {}%, deadlinesMet: {}, deadlinesMissed: {}",
+        clientContext.id,
+        clientContext.matrixSize.m,
+        clientContext.matrixSize.n,
+        clientContext.matrixSize.k,
+        clientContext.weight,
+        clientContext.lanes.size(),
+        stats.GetTotalRequests(),
+        stats.GetLatencySummary(),
+        stats.GetTotalBytes(),
+        100.0 * stats.GetBytesShare(serverBytes),
+        stats.GetMetDeadlines(),
+        stats.GetMissedDeadlines());
+    LOG_INFO("client: {}, {}", clientContext.id, GetRequestStagesSummary(stats, RequestStage::Wakeup));
+
+    PerfCounterStats perfStats = clientContext.GetPerfStats();
+    for (const auto& [shape, totals] : perfStats.GetShapes())
+    {
+        LOG_INFO("client: {}, {}", clientContext.id, PerfCounterStats::GetShapeSummary(shape, totals));
+    }
+}
+
 static void WorkloadDispatcher()
 {
-    uint64_t localValidClientsBitSet = 0;
+    Tracer::SetThreadName("dispatcher");
+
+    // Logging from here on, e.g. about a client's rejected requests, only writes into this ring
+    Logger::PrepareThread();
+
+    std::vector<ClientHotData*> stagedClients;
+    std::vector<TransposeJob*> singleWorkerJobs;
+    stagedClients.reserve(MAX_CLIENTS);
+    singleWorkerJobs.reserve(gWorkspace.numWorkerThreads);
+
+    // Clients that rang the doorbell and still have queued, staged, running or suspended work.
+    // Only these are visited, so a pass costs nothing for clients that are subscribed but idle.
+    HierarchicalBitmap<MAX_CLIENTS> activeClients;
+
+    // Slots with a lane on the metrics page, and those of them that were running when the page
+    // was last published
+    HierarchicalBitmap<MAX_CLIENTS> publishedSlots;
+    HierarchicalBitmap<MAX_CLIENTS> deferredSlots;
+    uint64_t metricsIntervalTicks = static_cast<uint64_t>(METRICS_PUBLISH_INTERVAL_MS * 1000000.0 * TscClock::GetTicksPerNs());
+    uint64_t nextMetricsTicks = TscClock::Now() + metricsIntervalTicks;
 
     while (gWorkspace.running)
     {
-        if (gWorkspace.clientBankUpdateAvailable.load(std::memory_order_acquire))
+        // Collected before acquiring the table: a client only rings after its subscribe response,
+        // which is sent after its slot is published, so every rung slot is in the table below
+        gWorkspace.pDoorbell->Collect(activeClients);
+
+        const ClientTable& table = gWorkspace.clientRegistry.Acquire();
+        if (gWorkspace.clientRegistry.HasRetired())
         {
-            localValidClientsBitSet = gWorkspace.validClientsBitSet;
-            gWorkspace.clientBankUpdateAvailable.store(false, std::memory_order_release);
+            gWorkspace.clientRegistry.ReclaimRetired(LogClientSummary);
         }
 
-        for (int i = 0; i < MAX_CLIENTS; i++)
+        // Drops slots of clients that have unsubscribed
+        activeClients.AndWith(table.validClients);
+
+        uint64_t nowTicks = TscClock::Now();
+        if (nowTicks >= nextMetricsTicks)
         {
-            if (!getBit(localValidClientsBitSet, i))
+            PublishMetrics(table, publishedSlots, deferredSlots);
+            nextMetricsTicks = nowTicks + metricsIntervalTicks;
+        }
+
+        // Stage at most one request per lane and sum the weights of the lanes competing for workers
+        uint32_t activeWeight = 0;
+        uint64_t maxStagedStartTag = 0;
+        stagedClients.clear();
+        activeClients.ForEachSet([&](uint32_t slot)
+        {
+            ClientHotData& client = gWorkspace.clientRegistry.GetHotData(slot);
+
+            TransposeJob& job = *client.pJob;
+            JobState jobState = job.state.load(std::memory_order_acquire);
+            if (jobState == JobState::Running)
+            {
+                activeWeight += client.weight;
+                return;
+            }
+
+            // Running jobs always belong to active clients, so a deferred lane is visited once idle
+            if (deferredSlots.Test(slot))
             {
-                continue;
+                PublishLaneMetrics(slot, client, true);
+                deferredSlots.Clear(slot);
             }
-            auto& clientContext = gWorkspace.clientBank[i];
 
-            uint32_t bufferIndex;
-            if (clientContext.pRequestQueue->Dequeue(bufferIndex))
+            if (jobState == JobState::Suspended)
+            {
+                job.state.store(JobState::Idle, std::memory_order_relaxed);
+                client.requestStaged = true;
+                client.stagedResume = true;
+                client.stagedStartTag = std::max(client.stagedStartTag, job.resumeAfterTag);
+            }
+
+            if (!client.requestStaged)
+            {
+                client.requestStaged = StageNextRequest(client);
+                if (client.requestStaged)
+                {
+                    AssignFairQueuingTags(client);
+                    StageDeadline(client);
+                }
+            }
+
+            if (client.requestStaged)
+            {
+                activeWeight += client.weight;
+                maxStagedStartTag = std::max(maxStagedStartTag, client.stagedStartTag);
+                stagedClients.push_back(&client);
+            }
+            else
+            {
+                // Queue drained, the client rings again with its next request
+                activeClients.Clear(slot);
+            }
+
+            // The job is not running, so its completion and any rejections above are counted.
+            // Lanes of the same client visited later in the pass usually find nothing left.
+            if (client.completionsBatched)
+            {
+                FlushCompletions(*client.pClient);
+            }
+        });
+
+        if (stagedClients.empty())
+        {
+            continue;
+        }
+
+        std::sort(stagedClients.begin(), stagedClients.end(), [](const ClientHotData* a, const ClientHotData* b)
+        {
+            return ScheduledBefore(*a, *b);
+        });
+
+        uint32_t availableWorkers = gWorkspace.pWorkerPool->CountIdleWorkers();
+        uint64_t nowNs = RequestClockNowNs();
+        singleWorkerJobs.clear();
+
+        for (ClientHotData* pClient : stagedClients)
+        {
+            auto& client = *pClient;
+
+            uint32_t width = PartitionWidth(client, activeWeight);
+            if (width > availableWorkers)
             {
-                uint64_t* pOriginalMat = clientContext.matrixBuffers[bufferIndex]->GetRawPointer();
-                uint64_t* pTransposeRes = clientContext.matrixBuffersTr[bufferIndex]->GetRawPointer();
-                uint32_t rowCount = clientContext.matrixSize.numRows;
-                uint32_t columnCount = clientContext.matrixSize.numColumns;
+                // Keep the remaining workers for this request so that it is not starved by smaller
+                // ones, and make room for it if a long running request has used up its time slice
+                PreemptForBlockedRequest(client, maxStagedStartTag + 1, activeClients);
+                break;
+            }
 
-                clientContext.stats.StartTimer();
-                TransposeTiledMultiThreaded(pOriginalMat, pTransposeRes, rowCount, columnCount, TRANSPOSE_TILE_SIZE, gWorkspace.numWorkerThreads);
+            TransposeJob& job = PrepareJob(client, nowNs);
+            availableWorkers -= width;
+            TraceInstant(TraceEventId::Dispatch, job.clientId, width);
 
-                clientContext.pTransposeReadyFutex->Wake();
-                clientContext.stats.StopTimer();
+            // Requests too small to use more than one worker are coalesced across clients and
+            // fanned out over the pool as one batch, one request per worker
+            if (width == 1)
+            {
+                singleWorkerJobs.push_back(&job);
+            }
+            else
+            {
+                gWorkspace.pWorkerPool->Dispatch(job, width);
             }
         }
+
+        if (!singleWorkerJobs.empty())
+        {
+            gWorkspace.pWorkerPool->DispatchBatch(singleWorkerJobs.data(), singleWorkerJobs.size());
+        }
     }
 }
 
 int main(int argc, char* argv[])
 {
+    // Before any thread takes timestamps, the logger's included. Clients switch to the mode
+    // chosen here when they subscribe, so request stage timestamps of both sides are on the same
+    // clock.
+    TscClock::Calibrate();
+
+    if (!Logger::SetLevelFromEnvironment(LOG_LEVEL_ENVIRONMENT_VARIABLE.c_str()))
+    {
+        LOG_WARNING("{} must be debug, info, warning, error or off, logging at {}", LOG_LEVEL_ENVIRONMENT_VARIABLE, Logger::LevelToString(Logger::GetLevel()));
+    }
+
     gWorkspace.numWorkerThreads = std::thread::hardware_concurrency();
 
     if (argc > 1)
@@ -268,40 +995,93 @@ int main(int argc, char* argv[])
 
     if (gWorkspace.numWorkerThreads & (gWorkspace.numWorkerThreads - 1))
     {
-        std::cerr << "Number of worker threads must be a power of 2" << std::endl;
+        LOG_ERROR("Number of worker threads must be a power of 2");
         return 1;
     }
 
-    gWorkspace.serverPid = getpid();
-    gWorkspace.clientBank.resize(MAX_CLIENTS);
-    gWorkspace.running = true;
+    gWorkspace.timeSliceNs = DEFAULT_TIME_SLICE_US * 1000ULL;
+    if (argc > 2)
+    {
+        gWorkspace.timeSliceNs = std::atoi(argv[2]) * 1000ULL;
+    }
 
-    for (int i = 0; i < MAX_CLIENTS; i++)
+    if (argc > 3)
     {
-        gWorkspace.clientBank[i].subscribed = false;
+        gWorkspace.countPerfEvents = std::atoi(argv[3]) != 0;
     }
 
+    gWorkspace.serverPid = getpid();
+    gWorkspace.startTimeNs = RequestClockNowNs();
+    gWorkspace.running = true;
+
+    StartTracing();
+
     try
     {
+        // Created before the socket so that it exists by the time a client is told to ring it
+        gWorkspace.pDoorbell = std::make_unique<PendingWorkDoorbell>(gWorkspace.serverPid, PendingWorkDoorbell::Endpoint::Server, DOORBELL_NAME_SUFFIX);
+        gWorkspace.pMetricsPage = std::make_unique<ServerMetricsPage>(gWorkspace.serverPid, ServerMetricsPage::Endpoint::Server, METRICS_NAME_SUFFIX);
+        PublishServerMetrics(0, 0);
         gWorkspace.pIpcServer = std::make_unique<UnixSockIpcServer<ClientServerMessage>>(SERVER_SOCKET_ADDRESS, MessageHandler);
     }
     catch(const std::exception& e)
     {
-        std::cerr << e.what() << '\n';
+        LOG_ERROR("{}", e.what());
         return 1;
     }
 
+    // Probed on this thread: if no counter can be opened here, the workers cannot open any either
+    if (gWorkspace.countPerfEvents)
+    {
+        PerfCounterGroup probe;
+        if (!probe.IsAvailable())
+        {
+            LOG_WARNING("Hardware counters are not available ({}), running without them", probe.GetError());
+            gWorkspace.countPerfEvents = false;
+        }
+        else
+        {
+            std::string counterNames;
+            for (uint32_t counter = 0; counter < PERF_COUNTER_COUNT; counter++)
+            {
+                if (probe.IsCounterAvailable(static_cast<PerfCounter>(counter)))
+                {
+                    counterNames += " ";
+                    counterNames += PerfCounterGroup::CounterName(static_cast<PerfCounter>(counter));
+                }
+            }
+            LOG_INFO("Counting per request:{}", counterNames);
+            if (!probe.GetError().empty())
+            {
+                LOG_INFO("Not counted: {}", probe.GetError());
+            }
+        }
+    }
+
+    gWorkspace.pWorkerPool = std::make_unique<WorkerPool>(gWorkspace.numWorkerThreads, TRANSPOSE_TILE_SIZE, WORKER_SPIN_COUNT, OnTransposeComplete, gWorkspace.countPerfEvents);
+
     std::thread workloadDispatcherThread(WorkloadDispatcher);
 
 
-    std::clog << "Server PID: " << gWorkspace.serverPid << std::endl;
-    std::clog << "Running " << gWorkspace.numWorkerThreads << "/" << std::thread::hardware_concurrency() << " worker threads" << std::endl;
-    std::clog << "Press Enter to stop the server" << std::endl;
+    LOG_INFO("Server PID: {}", gWorkspace.serverPid);
+    LOG_INFO("Running {}/{} worker threads", gWorkspace.numWorkerThreads, std::thread::hardware_concurrency());
+    if (TscClock::UsesTsc())
+    {
+        LOG_INFO("Timing with the TSC at {} GHz", TscClock::GetTicksPerNs());
+    }
+    else
+    {
+        LOG_INFO("TSC is not invariant or not in step across cores, timing with steady_clock");
+    }
+    LOG_INFO("Tracing is {}, kill -USR1 {} switches it, kill -USR2 {} dumps it", Tracer::IsEnabled() ? "on" : "off", gWorkspace.serverPid, gWorkspace.serverPid);
+    LOG_INFO("Press Enter to stop the server");
 
     std::cin.get();
     gWorkspace.running = false;
 
     workloadDispatcherThread.join();
+    gWorkspace.pWorkerPool.reset();
+    FinishTracing();
 
     return 0;
 }
@@ -0,0 +1,241 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Constants.h"
+#include "presentation/Table.h"
+#include "ServerMetricsPage.h"
+
+using MatrixTransposer::Constants::METRICS_NAME_SUFFIX;
+using MatrixTransposer::Constants::METRICS_PUBLISH_INTERVAL_MS;
+
+static const std::string SHM_DIRECTORY = "/dev/shm";
+
+// One copy of everything on the page, taken entry by entry
+struct MetricsSnapshot
+{
+    ServerMetricsPage::ServerMetrics server {};
+    std::vector<ServerMetricsPage::LaneMetrics> lanes;
+    std::vector<ServerMetricsPage::WorkerMetrics> workers;
+};
+
+static bool ProcessArguments(int argc, char* argv[], uint32_t& serverPid, uint32_t& refreshMs, uint32_t& refreshCount)
+{
+    if (argc > 4)
+    {
+        std::cerr << "Usage: " << argv[0] << " [server pid (0 to find it)] [refresh period (ms)] [refresh count (0 to run until the server stops)]" << std::endl;
+        return false;
+    }
+
+    serverPid = (argc >= 2) ? std::atoi(argv[1]) : 0;
+    refreshMs = (argc >= 3) ? std::atoi(argv[2]) : 2 * METRICS_PUBLISH_INTERVAL_MS;
+    refreshCount = (argc >= 4) ? std::atoi(argv[3]) : 0;
+    return true;
+}
+
+// PID of the server with the lowest PID among the metrics pages in shared memory, or 0
+static uint32_t FindServerPid()
+{
+    const std::string prefix = ServerMetricsPage::SHM_OBJECT_NAME_PREFIX;
+    uint32_t serverPid = 0;
+
+    std::error_code error;
+    for (const auto& entry : std::filesystem::directory_iterator(SHM_DIRECTORY, error))
+    {
+        std::string name = entry.path().filename().string();
+        if (name.rfind(prefix, 0) != 0)
+        {
+            continue;
+        }
+
+        uint32_t pid = std::strtoul(name.c_str() + prefix.size(), nullptr, 10);
+        if (pid != 0 && (serverPid == 0 || pid < serverPid))
+        {
+            serverPid = pid;
+        }
+    }
+    return serverPid;
+}
+
+static bool ServerIsRunning(uint32_t serverPid)
+{
+    std::error_code error;
+    return std::filesystem::exists(SHM_DIRECTORY + "/" + ServerMetricsPage::CreateShmObjectName(serverPid, METRICS_NAME_SUFFIX), error);
+}
+
+static void TakeSnapshot(const ServerMetricsPage& page, MetricsSnapshot& snapshot)
+{
+    snapshot.server = page.ReadServer();
+
+    uint32_t slotLimit = std::min(snapshot.server.slotLimit, ServerMetricsPage::MAX_LANES);
+    snapshot.lanes.resize(slotLimit);
+    for (uint32_t slot = 0; slot < slotLimit; slot++)
+    {
+        snapshot.lanes[slot] = page.ReadLane(slot);
+    }
+
+    uint32_t workerCount = std::min(snapshot.server.workerCount, ServerMetricsPage::MAX_WORKERS);
+    snapshot.workers.resize(workerCount);
+    for (uint32_t workerIndex = 0; workerIndex < workerCount; workerIndex++)
+    {
+        snapshot.workers[workerIndex] = page.ReadWorker(workerIndex);
+    }
+}
+
+static std::string FormatFixed(double value, int precision = 1)
+{
+    std::ostringstream oss;
+    oss << std::fixed << std::setprecision(precision) << value;
+    return oss.str();
+}
+
+static std::string FormatUs(uint64_t valueNs)
+{
+    return FormatFixed(valueNs / 1000.0);
+}
+
+// Change of a counter per second between two snapshots, 0 for a counter that started over
+static double RatePerSecond(uint64_t current, uint64_t previous, double elapsedSeconds)
+{
+    if (elapsedSeconds <= 0.0 || current < previous)
+    {
+        return 0.0;
+    }
+    return (current - previous) / elapsedSeconds;
+}
+
+static std::string Render(const MetricsSnapshot& current, const MetricsSnapshot& previous)
+{
+    const ServerMetricsPage::ServerMetrics& server = current.server;
+    double elapsedSeconds = (server.publishTimeNs - previous.server.publishTimeNs) / 1e9;
+    double uptimeSeconds = (server.publishTimeNs - server.startTimeNs) / 1e9;
+
+    std::ostringstream output;
+    output << "Server PID: " << server.serverPid
+           << ", uptime: " << FormatFixed(uptimeSeconds) << " s"
+           << ", lanes: " << server.laneCount
+           << ", workers: " << server.workerCount
+           << ", transposed: " << FormatFixed(server.totalBytes / 1e6) << " MB"
+           << ", throughput: " << FormatFixed(RatePerSecond(server.totalBytes, previous.server.totalBytes, elapsedSeconds) / 1e6) << " MB/s"
+           << "\n\n";
+
+    Table laneTable("Client lanes",
+        { "Client", "Lane", "Weight", "Queue", "Reqs", "Reqs/s", "MB/s", "p50 (us)", "p99 (us)", "p99.9 (us)", "max (us)", "DL met", "DL missed" },
+        ServerMetricsPage::MAX_LANES);
+
+    for (uint32_t slot = 0; slot < current.lanes.size(); slot++)
+    {
+        const ServerMetricsPage::LaneMetrics& lane = current.lanes[slot];
+        if (lane.clientId == 0)
+        {
+            continue;
+        }
+
+        // Rates only against the same lane, the slot may have been reused
+        ServerMetricsPage::LaneMetrics before {};
+        if (slot < previous.lanes.size() && previous.lanes[slot].clientId == lane.clientId && previous.lanes[slot].laneIndex == lane.laneIndex)
+        {
+            before = previous.lanes[slot];
+        }
+
+        laneTable.addRow({
+            std::to_string(lane.clientId),
+            std::to_string(lane.laneIndex),
+            std::to_string(lane.weight),
+            std::to_string(lane.queueDepth),
+            std::to_string(lane.requests),
+            FormatFixed(RatePerSecond(lane.requests, before.requests, elapsedSeconds)),
+            FormatFixed(RatePerSecond(lane.bytes, before.bytes, elapsedSeconds) / 1e6),
+            FormatUs(lane.p50Ns),
+            FormatUs(lane.p99Ns),
+            FormatUs(lane.p999Ns),
+            FormatUs(lane.maxNs),
+            std::to_string(lane.deadlinesMet),
+            std::to_string(lane.deadlinesMissed) });
+    }
+    output << laneTable.render() << "\n";
+
+    Table workerTable("Workers", { "Worker", "Job parts", "Parts/s", "Busy %" }, ServerMetricsPage::MAX_WORKERS);
+    for (uint32_t workerIndex = 0; workerIndex < current.workers.size(); workerIndex++)
+    {
+        const ServerMetricsPage::WorkerMetrics& worker = current.workers[workerIndex];
+        ServerMetricsPage::WorkerMetrics before = (workerIndex < previous.workers.size()) ? previous.workers[workerIndex] : ServerMetricsPage::WorkerMetrics {};
+
+        workerTable.addRow({
+            std::to_string(workerIndex),
+            std::to_string(worker.jobParts),
+            FormatFixed(RatePerSecond(worker.jobParts, before.jobParts, elapsedSeconds)),
+            FormatFixed(100.0 * RatePerSecond(worker.busyNs, before.busyNs, elapsedSeconds) / 1e9) });
+    }
+    output << workerTable.render();
+
+    return output.str();
+}
+
+int main(int argc, char* argv[])
+{
+    uint32_t serverPid, refreshMs, refreshCount;
+    if (!ProcessArguments(argc, argv, serverPid, refreshMs, refreshCount))
+    {
+        return 1;
+    }
+
+    if (serverPid == 0)
+    {
+        serverPid = FindServerPid();
+        if (serverPid == 0)
+        {
+            std::cerr << "No running server found in " << SHM_DIRECTORY << std::endl;
+            return 1;
+        }
+    }
+
+    std::unique_ptr<ServerMetricsPage> pPage;
+    try
+    {
+        pPage = std::make_unique<ServerMetricsPage>(serverPid, ServerMetricsPage::Endpoint::Observer, METRICS_NAME_SUFFIX);
+    }
+    catch(const std::exception& e)
+    {
+        std::cerr << e.what() << '\n';
+        return 1;
+    }
+
+    MetricsSnapshot previous;
+    MetricsSnapshot current;
+    TakeSnapshot(*pPage, previous);
+
+    for (uint32_t refresh = 0; refreshCount == 0 || refresh < refreshCount; refresh++)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(refreshMs));
+
+        // The server unlinks the page when it exits; the mapping stays readable
+        if (!ServerIsRunning(serverPid))
+        {
+            std::cout << "Server PID: " << serverPid << " has stopped" << std::endl;
+            break;
+        }
+
+        TakeSnapshot(*pPage, current);
+
+        // Clear the terminal and draw from the top left corner
+        std::cout << "\033[H\033[2J" << Render(current, previous) << std::flush;
+
+        // Rates over the time between two publications, not two refreshes
+        if (current.server.publishTimeNs != previous.server.publishTimeNs)
+        {
+            std::swap(previous, current);
+        }
+    }
+
+    return 0;
+}